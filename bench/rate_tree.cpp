@@ -0,0 +1,99 @@
+// Microbenchmark of the flip selection, it compares the linear scan over the transition rates with the rate tree.
+// The rates are updated with the fan-out of the given models, which are meant to be generated by
+// data/generate-synth.py, e.g. for a series of sizes:
+//   for n in 100 1000 10000; do python3 data/generate-synth.py synth$n --nodes $n; done
+//   bench_rate_tree synth100.bnd synth100.cfg synth1000.bnd synth1000.cfg synth10000.bnd synth10000.cfg
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "generator.h"
+#include "host/transition_selection.h"
+
+constexpr int steps = 1 << 20;
+
+// the rates of the dependents of a flipped node take values from 1 to 4, so no state is a fixed point
+float next_rate(int step, int node) { return 1.f + ((step + node) & 3); }
+
+template <typename step_t>
+double measure(step_t&& step)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < steps; i++)
+		step(i);
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / steps;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3 || argc % 2 == 0)
+	{
+		std::cout << "Usage: bench_rate_tree bnd_file cfg_file [bnd_file cfg_file]..." << std::endl;
+		return 1;
+	}
+
+	std::cout << std::setw(10) << "nodes" << std::setw(12) << "fan-out" << std::setw(20) << "linear [ns/step]"
+			  << std::setw(20) << "tree [ns/step]" << std::endl;
+
+	for (int arg = 1; arg < argc; arg += 2)
+	{
+		driver drv;
+		if (drv.parse(argv[arg], argv[arg + 1]))
+			return 1;
+
+		int state_size = drv.nodes.size();
+		auto dependents = build_node_dependents(drv);
+
+		size_t fan_out = 0;
+		for (auto&& d : dependents)
+			fan_out += d.size();
+
+		// both variants draw the same random numbers and receive the same rate updates
+		long long checksum = 0;
+
+		std::vector<float> rates(state_size, 1.f);
+		double total_rate = state_size;
+		host_random linear_rand(1, 0);
+
+		double linear = measure([&](int step) {
+			int flip_bit = select_flip_bit(state_size, rates.data(), total_rate, linear_rand);
+			for (int i : dependents[flip_bit])
+			{
+				float rate = next_rate(step, i);
+				total_rate += (double)rate - rates[i];
+				rates[i] = rate;
+			}
+			checksum += flip_bit;
+		});
+
+		int leaves = rate_tree_leaves(state_size);
+		std::vector<float> tree(2 * leaves);
+		std::fill(tree.begin() + leaves, tree.begin() + leaves + state_size, 1.f);
+		build_rate_tree(state_size, leaves, tree.data());
+		host_random tree_rand(1, 0);
+
+		double tree_time = measure([&](int step) {
+			int flip_bit = select_flip_bit_tree(leaves, tree.data(), tree_rand);
+			for (int i : dependents[flip_bit])
+			{
+				tree[leaves + i] = next_rate(step, i);
+				update_rate_tree(leaves, tree.data(), i);
+			}
+			checksum -= flip_bit;
+		});
+
+		std::cout << std::setw(10) << state_size << std::setw(12) << std::fixed << std::setprecision(1)
+				  << (double)fan_out / state_size << std::setw(20) << std::setprecision(1) << linear << std::setw(20)
+				  << tree_time << std::endl;
+
+		// the selections agree up to the rounding of the partial sums
+		if (checksum != 0)
+			std::cerr << "bench_rate_tree> the selections of the linear scan and the tree diverged" << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,499 @@
+// Benchmark suite of the whole host pipeline. Every model is parsed, its code generated and compiled, then it is
+// simulated and its results written, and the time of each phase is reported as JSON, e.g.
+//   bench_MaBoSSG -o current.json
+//   bench_MaBoSSG --synth 1000:8 --synth 10000 data/sizek.bnd data/sizek.cfg
+//   bench_MaBoSSG --baseline current.json
+// The bundled models are taken from data/ when no model is given. The synthetic models are ring networks of
+// data/generate-synth.py given as nodes[:signal_length], a node reads 2 * signal_length + 2 nodes. With --baseline
+// the run is compared with a stored JSON output and the exit code is 2 when a metric got worse by more than the
+// threshold. --fused-stats runs the stats fused into the simulation, compared with a buffered baseline it shows the
+// time saved by not streaming the steps through memory.
+// --scaling max_threads simulates every model on 1, 2, 4, ... up to max_threads threads instead, the results of a
+// threads count are named model@threads.
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <regex>
+#include <vector>
+
+#include <unistd.h>
+
+#include "generator.h"
+#include "host/host_compiler.h"
+#include "host/host_simulation_runner.h"
+#include "simulation_session.h"
+#include "statistics/host/host_stats.h"
+#include "statistics/stats_composite.h"
+#include "synth_model.h"
+#include "utils.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Counts the steps of the trajectories, i.e. the transitions of the simulation
+class transitions_counter : public stats, public step_accumulator
+{
+	int trajectory_len_limit_;
+	thread_pool& pool_;
+	std::vector<long long> counts_;
+	bool fused_ = false;
+
+public:
+	transitions_counter(int trajectory_len_limit, thread_pool& pool)
+		: trajectory_len_limit_(trajectory_len_limit), pool_(pool), counts_(pool.size())
+	{}
+
+	void process_batch(const trajectory_batch& batch) override
+	{
+		if (fused_)
+			return;
+
+		pool_.parallel_for(batch.n_trajectories, [&](int begin, int end, int worker) {
+			// the first step holds only the time where the trajectory continues from
+			for (size_t i = (size_t)begin * trajectory_len_limit_; i < (size_t)end * trajectory_len_limit_; i++)
+				counts_[worker] += i % trajectory_len_limit_ != 0 && batch.traj_times[i] != 0.f;
+		});
+	}
+
+	step_accumulator* fuse() override
+	{
+		fused_ = true;
+		return this;
+	}
+
+	void begin_batch(int) override {}
+	void add_step(int, int worker, const state_word_t*, float, float, float) override { counts_[worker]++; }
+	void end_trajectory(int, int, trajectory_status) override {}
+
+	long long transitions() const
+	{
+		long long sum = 0;
+		for (auto count : counts_)
+			sum += count;
+		return sum;
+	}
+
+	void visualize(int, const std::vector<std::string>&) override {}
+	void write_csv(int, const std::vector<std::string>&, const std::string&) override {}
+	void export_results(int, const std::vector<std::string>&, simulation_results&) override {}
+	void export_partial(partial_results&) override {}
+	float max_error(int) override { return 0.f; }
+	void save(binary_writer&) const override {}
+	void load(binary_reader&) override {}
+};
+
+struct bench_model
+{
+	std::string name, bnd_path, cfg_path;
+};
+
+// Metrics of one model, the times are the minimum over the repetitions
+struct bench_result
+{
+	std::string name;
+	std::map<std::string, double> metrics;
+};
+
+// The rates and the parallel speedups are better when higher, the times when lower
+bool higher_is_better(const std::string& metric)
+{
+	return metric.find("_per_s") != std::string::npos || metric == "speedup" || metric == "efficiency";
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Keeps the best value of a metric over the repetitions
+auto metric_keeper(bench_result& result)
+{
+	return [&result](const char* metric, double value) {
+		auto [it, inserted] = result.metrics.try_emplace(metric, value);
+		if (!inserted)
+			it->second = higher_is_better(metric) ? std::max(it->second, value) : std::min(it->second, value);
+	};
+}
+
+// Simulates the trajectories of the compiled model, keeps the simulation metrics and returns the finalized stats
+template <typename keep_t>
+stats_composite simulate_model(driver& drv, const host_functions& functions, int trajectories, bool fused_stats,
+							   thread_pool& pool, keep_t&& keep)
+{
+	bool discrete_time = drv.constants["discrete_time"] != 0;
+	float max_time = drv.constants["max_time"];
+	float time_tick = drv.constants["time_tick"];
+	auto noninternals_mask = create_noninternals_mask(drv);
+	int noninternals_count = std::count_if(drv.nodes.begin(), drv.nodes.end(),
+										   [&](const auto& node) { return !node.is_internal(drv); });
+
+	host_simulation_runner r(trajectories, drv.nodes.size(), drv.constants["seed_pseudorandom"],
+							 create_initial_probs(drv), max_time, time_tick, discrete_time, pool);
+	if (fused_stats)
+		r.fuse_stats();
+
+	stats_composite stats_runner;
+	add_host_stats(stats_runner, discrete_time, max_time, time_tick, noninternals_mask, noninternals_count,
+				   r.trajectory_len_limit, functions, pool);
+
+	auto counter = std::make_unique<transitions_counter>(r.trajectory_len_limit, pool);
+	auto& transitions = *counter;
+	stats_runner.add(std::move(counter));
+
+	auto start = std::chrono::steady_clock::now();
+	r.run_simulation(stats_runner, functions);
+	stats_runner.finalize();
+	double simulate_ms = elapsed_ms(start);
+	keep("simulate_ms", simulate_ms);
+	keep("trajectories_per_s", trajectories / simulate_ms * 1e3);
+	keep("transitions_per_s", transitions.transitions() / simulate_ms * 1e3);
+
+	// the steps written into the trajectory buffers by the simulation and read back by the stats
+	size_t state_words = DIV_UP(drv.nodes.size(), sizeof(state_word_t) * 8);
+	size_t step_bytes = state_words * sizeof(state_word_t) + 2 * sizeof(float);
+	keep("buffered_steps_mb", fused_stats ? 0. : transitions.transitions() * step_bytes / 1048576.);
+
+	return stats_runner;
+}
+
+// Parses the model, generates its code and compiles it into compiler, keeps the times of the phases
+template <typename keep_t>
+int compile_model(const bench_model& model, driver& drv, host_compiler& compiler, keep_t&& keep)
+{
+	auto start = std::chrono::steady_clock::now();
+	if (drv.parse(model.bnd_path, model.cfg_path))
+		return 1;
+	keep("parse_ms", elapsed_ms(start));
+
+	start = std::chrono::steady_clock::now();
+	auto code = generator(drv, code_target::host).generate_code();
+	keep("codegen_ms", elapsed_ms(start));
+
+	start = std::chrono::steady_clock::now();
+	if (compiler.compile_simulation(code))
+		return 1;
+	keep("compile_ms", elapsed_ms(start));
+
+	return 0;
+}
+
+int run_model(const bench_model& model, int trajectories, int repetitions, bool fused_stats, thread_pool& pool,
+			  const std::string& output_prefix, bench_result& result)
+{
+	result.name = model.name;
+	auto keep = metric_keeper(result);
+
+	for (int rep = 0; rep < repetitions; rep++)
+	{
+		driver drv;
+
+		// the module cache is disabled, so every repetition compiles the model
+		host_compiler compiler { module_cache("") };
+		if (compile_model(model, drv, compiler, keep))
+			return 1;
+
+		auto stats_runner = simulate_model(drv, compiler.functions, trajectories, fused_stats, pool, keep);
+
+		std::vector<std::string> node_names;
+		for (auto&& node : drv.nodes)
+			node_names.push_back(node.name);
+
+		auto start = std::chrono::steady_clock::now();
+		stats_runner.write_csv(trajectories, node_names, output_prefix);
+		keep("output_ms", elapsed_ms(start));
+	}
+
+	return 0;
+}
+
+// Simulates the model compiled once on 1, 2, 4, ... up to max_threads threads, appends a result named model@threads
+// per threads count with the speedup and the parallel efficiency over a single thread
+int run_scaling(const bench_model& model, int trajectories, int repetitions, int max_threads, bool fused_stats,
+				std::vector<bench_result>& results)
+{
+	driver drv;
+	host_compiler compiler;
+	bench_result compilation;
+	if (compile_model(model, drv, compiler, metric_keeper(compilation)))
+		return 1;
+
+	std::vector<int> threads_counts;
+	for (int threads = 1; threads < max_threads; threads *= 2)
+		threads_counts.push_back(threads);
+	threads_counts.push_back(max_threads);
+
+	double single_thread_rate = 0.;
+	for (int threads : threads_counts)
+	{
+		std::cerr << "bench_MaBoSSG> " << model.name << "@" << threads << std::endl;
+
+		thread_pool pool(threads);
+		bench_result result { model.name + "@" + std::to_string(threads), {} };
+		auto keep = metric_keeper(result);
+
+		for (int rep = 0; rep < repetitions; rep++)
+			simulate_model(drv, compiler.functions, trajectories, fused_stats, pool, keep);
+
+		double rate = result.metrics["trajectories_per_s"];
+		if (threads == 1)
+			single_thread_rate = rate;
+		result.metrics["speedup"] = rate / single_thread_rate;
+		result.metrics["efficiency"] = rate / single_thread_rate / threads;
+
+		results.push_back(std::move(result));
+	}
+
+	return 0;
+}
+
+void write_json(std::ostream& os, int trajectories, int threads, bool fused_stats,
+				const std::vector<bench_result>& results)
+{
+	// one benchmark per line, read back by read_baseline
+	os << "{\"trajectories\":" << trajectories << ",\"threads\":" << threads << ",\"fused_stats\":" << fused_stats
+	   << ",\"benchmarks\":[";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		os << (i ? ",\n" : "\n") << "{\"name\":\"" << results[i].name << "\"";
+		for (const auto& [metric, value] : results[i].metrics)
+			os << ",\"" << metric << "\":" << std::setprecision(6) << value;
+		os << "}";
+	}
+	os << "\n]}" << std::endl;
+}
+
+std::vector<bench_result> read_baseline(const std::string& path)
+{
+	std::ifstream ifs(path);
+	if (!ifs)
+		throw std::runtime_error("cannot open " + path);
+
+	std::regex name_regex("\"name\":\"([^\"]*)\"");
+	std::regex metric_regex("\"(\\w+)\":(-?[0-9.]+(?:[eE][-+]?[0-9]+)?)");
+
+	std::vector<bench_result> results;
+	std::string line;
+	while (std::getline(ifs, line))
+	{
+		std::smatch name;
+		if (!std::regex_search(line, name, name_regex))
+			continue;
+
+		bench_result result { name[1], {} };
+		for (std::sregex_iterator it(line.begin(), line.end(), metric_regex), end; it != end; ++it)
+			result.metrics[(*it)[1]] = std::stod((*it)[2]);
+		results.push_back(std::move(result));
+	}
+
+	return results;
+}
+
+// Prints the relative change of every metric against the baseline, returns whether a metric regressed by more than
+// threshold percent
+bool compare(const std::vector<bench_result>& results, const std::vector<bench_result>& baseline, double threshold)
+{
+	bool regressed = false;
+
+	std::cerr << std::left << std::setw(24) << "benchmark" << std::setw(22) << "metric" << std::right
+			  << std::setw(14) << "baseline" << std::setw(14) << "current" << std::setw(10) << "change" << std::endl;
+
+	for (const auto& result : results)
+	{
+		auto base = std::find_if(baseline.begin(), baseline.end(), [&](auto& b) { return b.name == result.name; });
+		if (base == baseline.end())
+			continue;
+
+		for (const auto& [metric, value] : result.metrics)
+		{
+			auto base_value = base->metrics.find(metric);
+			if (base_value == base->metrics.end() || base_value->second == 0)
+				continue;
+
+			double change = (value / base_value->second - 1) * 100;
+			double worse = higher_is_better(metric) ? -change : change;
+			// the phases shorter than a millisecond are too noisy to be flagged
+			bool noisy = !higher_is_better(metric) && std::max(value, base_value->second) < 1.;
+			bool metric_regressed = worse > threshold && !noisy;
+			regressed |= metric_regressed;
+
+			std::cerr << std::left << std::setw(24) << result.name << std::setw(22) << metric << std::right
+					  << std::fixed << std::setprecision(2) << std::setw(14) << base_value->second << std::setw(14)
+					  << value << std::setw(9) << std::showpos << change << "%" << std::noshowpos
+					  << (metric_regressed ? "  regressed" : "") << std::endl;
+			std::cerr.unsetf(std::ios::fixed);
+		}
+	}
+
+	return regressed;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+
+	int trajectories = 10000;
+	int repetitions = 3;
+	int threads = thread_pool::default_threads_count();
+	double threshold = 10.;
+	bool fused_stats = false;
+	int scaling_threads = 0;
+	std::string output_path;
+	std::string baseline_path;
+	std::vector<std::string> synth_specs;
+	std::vector<std::string> positional;
+
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "-o" && i + 1 < args.size())
+			output_path = args[++i];
+		else if (args[i] == "--trajectories" && i + 1 < args.size())
+			trajectories = std::stoi(args[++i]);
+		else if (args[i] == "--repetitions" && i + 1 < args.size())
+			repetitions = std::stoi(args[++i]);
+		else if (args[i] == "--threads" && i + 1 < args.size())
+			threads = std::stoi(args[++i]);
+		else if (args[i] == "--synth" && i + 1 < args.size())
+			synth_specs.push_back(args[++i]);
+		else if (args[i] == "--baseline" && i + 1 < args.size())
+			baseline_path = args[++i];
+		else if (args[i] == "--threshold" && i + 1 < args.size())
+			threshold = std::stod(args[++i]);
+		else if (args[i] == "--fused-stats")
+			fused_stats = true;
+		else if (args[i] == "--scaling" && i + 1 < args.size())
+			scaling_threads = std::stoi(args[++i]);
+		else
+			positional.push_back(args[i]);
+	}
+
+	if (positional.size() % 2 != 0 || trajectories < 1 || repetitions < 1 || threads < 1 || threshold < 0
+		|| scaling_threads < 0)
+	{
+		std::cout << "Usage: bench_MaBoSSG [-o json_file] [--trajectories n] [--repetitions n] [--threads n] "
+					 "[--synth nodes[:signal_length]]... [--baseline json_file [--threshold percent]] [--fused-stats] "
+					 "[--scaling max_threads] "
+					 "[bnd_file cfg_file]..."
+				  << std::endl;
+		return 1;
+	}
+
+	bool bundled = positional.empty() && synth_specs.empty();
+	if (bundled)
+		synth_specs = { "100", "1000:4" };
+
+	// the cfg spreads the non-internal nodes over the ring with a stride of nodes / noninternals
+	std::vector<synth_options> synth_models;
+	for (const auto& spec : synth_specs)
+	{
+		synth_options options;
+		auto colon = spec.find(':');
+		options.nodes = std::stoi(spec.substr(0, colon));
+		if (colon != std::string::npos)
+			options.signal_length = std::stoi(spec.substr(colon + 1));
+
+		if (options.nodes < options.noninternals || options.signal_length < 0)
+		{
+			std::cerr << "A synthetic model needs at least " << options.noninternals
+					  << " nodes and a nonnegative signal length, got " << spec << "." << std::endl;
+			return 1;
+		}
+
+		synth_models.push_back(options);
+	}
+
+	auto work_dir = fs::temp_directory_path() / ("mabossg-bench-" + std::to_string(getpid()));
+	fs::create_directories(work_dir);
+
+	std::vector<bench_model> models;
+	for (size_t i = 0; i < positional.size(); i += 2)
+		models.push_back({ fs::path(positional[i]).stem().string(), positional[i], positional[i + 1] });
+
+	if (bundled)
+		for (const char* name : { "cellcycle", "metastasis", "sizek", "Montagud2022_Prostate_Cancer" })
+			models.push_back({ name, std::string("data/") + name + ".bnd", std::string("data/") + name + ".cfg" });
+
+	for (const auto& options : synth_models)
+	{
+		std::string name = "synth" + std::to_string(options.nodes) + "_" + std::to_string(options.stripe_count());
+		std::string prefix = (work_dir / name).string();
+		write_synth_model(prefix, options);
+		models.push_back({ name, prefix + ".bnd", prefix + ".cfg" });
+	}
+
+	// the scanner exits the process on a missing file
+	for (const auto& model : models)
+		for (const auto& path : { model.bnd_path, model.cfg_path })
+			if (!std::ifstream(path))
+			{
+				std::cerr << "Cannot open " << path << std::endl;
+				fs::remove_all(work_dir);
+				return 1;
+			}
+
+	// a scaling run creates the pools of its threads counts
+	std::optional<thread_pool> pool;
+	if (!scaling_threads)
+		pool.emplace(threads);
+	else
+		threads = scaling_threads;
+
+	std::vector<bench_result> results;
+	for (const auto& model : models)
+	{
+		int failed;
+		if (scaling_threads)
+			failed = run_scaling(model, trajectories, repetitions, scaling_threads, fused_stats, results);
+		else
+		{
+			std::cerr << "bench_MaBoSSG> " << model.name << std::endl;
+
+			results.emplace_back();
+			failed = run_model(model, trajectories, repetitions, fused_stats, *pool, (work_dir / "out").string(),
+							   results.back());
+		}
+
+		if (failed)
+		{
+			std::cerr << "Cannot benchmark " << model.name << std::endl;
+			fs::remove_all(work_dir);
+			return 1;
+		}
+	}
+
+	fs::remove_all(work_dir);
+
+	if (output_path.empty())
+	{
+		write_json(std::cout, trajectories, threads, fused_stats, results);
+	}
+	else
+	{
+		std::ofstream ofs(output_path);
+		write_json(ofs, trajectories, threads, fused_stats, results);
+	}
+
+	if (!baseline_path.empty())
+	{
+		try
+		{
+			if (compare(results, read_baseline(baseline_path), threshold))
+				return 2;
+		}
+		catch (const std::runtime_error& e)
+		{
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+// Synthetic model of data/generate-synth.py, the nodes form a ring where a signal of stripe_count nodes propagates.
+// A node's formula reads 2 * stripe_count + 2 nodes, so stripe_count sets the fan-in. With a positive
+// steps_to_fixed_point one more node NFP pushes the trajectories into a single fixed point. The non-internal nodes are
+// spread over the ring with a stride of nodes / noninternals, so there must be at least as many nodes.
+struct synth_options
+{
+	int nodes = 100;
+	int noninternals = 5;
+	int sample_count = 1000000;
+	int time_tick = 5;
+	int max_time = 100;
+	bool discrete = false;
+	int signal_length = 0; // int(sqrt(nodes)) when not positive
+	bool continuous_noninternals = false;
+	int steps_to_fixed_point = 0;
+
+	int stripe_count() const { return signal_length > 0 ? signal_length : (int)std::sqrt(nodes); }
+};
+
+inline std::string synth_node(int i) { return "N" + std::to_string(i); }
+
+// Formats a finite value like str() of a Python float: the shortest digits reading back the same value, in the fixed
+// notation with at least one fractional digit for the decimal exponents in [-4, 16) and in the scientific one otherwise
+inline std::string python_float(double value)
+{
+	char buffer[32];
+	auto end = std::to_chars(buffer, buffer + sizeof(buffer), std::abs(value), std::chars_format::scientific).ptr;
+	std::string scientific(buffer, end);
+
+	auto e = scientific.find('e');
+	int exponent = std::stoi(scientific.substr(e + 1));
+	std::string digits = scientific.substr(0, 1) + (e > 1 ? scientific.substr(2, e - 2) : "");
+	std::string sign = std::signbit(value) ? "-" : "";
+
+	if (exponent < -4 || exponent >= 16)
+	{
+		char exponent_str[16];
+		std::snprintf(exponent_str, sizeof(exponent_str), "e%c%02d", exponent < 0 ? '-' : '+', std::abs(exponent));
+		return sign + digits.substr(0, 1) + (digits.size() > 1 ? "." + digits.substr(1) : "") + exponent_str;
+	}
+
+	if (exponent < 0)
+		return sign + "0." + std::string(-exponent - 1, '0') + digits;
+	if ((int)digits.size() <= exponent + 1)
+		return sign + digits + std::string(exponent + 1 - digits.size(), '0') + ".0";
+	return sign + digits.substr(0, exponent + 1) + "." + digits.substr(exponent + 1);
+}
+
+inline void write_synth_bnd(const std::string& file_name, const synth_options& options)
+{
+	int nodes_count = options.nodes;
+	int stripe_count = options.stripe_count();
+	bool make_fixed_node = options.steps_to_fixed_point != 0;
+
+	if (make_fixed_node)
+		nodes_count -= 1;
+
+	std::ofstream f(file_name);
+
+	for (int i = 0; i < nodes_count; i++)
+	{
+		std::string up_nodes, down_nodes;
+		for (int j = 1; j <= stripe_count; j++)
+		{
+			up_nodes += synth_node((i - j + nodes_count) % nodes_count) + " & ";
+			down_nodes += (j > 1 ? " & " : "") + synth_node((i + j) % nodes_count);
+		}
+		up_nodes += "!" + synth_node((i - stripe_count - 1 + nodes_count) % nodes_count);
+
+		f << "Node N" << i << " {\n";
+		f << "    logic = (!N" << i << " & ";
+		if (make_fixed_node)
+			f << " !NFP & ";
+		f << up_nodes << ") | (!(N" << i << " & " << down_nodes << ") & N" << i;
+		if (make_fixed_node)
+			f << " & !NFP";
+		f << ")";
+		if (make_fixed_node)
+			f << " | (NFP)";
+		f << ";\n";
+		f << "    rate_up = @logic ? $u_N" << i << " : 0;\n";
+		f << "    rate_down = @logic ? 0 : $d_N" << i << ";\n";
+		f << "}\n\n";
+	}
+
+	if (make_fixed_node)
+	{
+		f << "Node NFP {\n";
+		f << "    logic = !NFP;\n";
+		f << "    rate_up = @logic ? $u_NFP : 0;\n";
+		f << "    rate_down = @logic ? 0 : $d_NFP;\n";
+		f << "}\n\n";
+	}
+}
+
+inline void write_synth_cfg(const std::string& file_name, const synth_options& options)
+{
+	int nodes_count = options.nodes;
+	int noninternals_count = options.noninternals;
+	int stripe_count = options.stripe_count();
+	int internal_stride = options.continuous_noninternals ? 1 : options.nodes / options.noninternals;
+
+	std::ofstream f(file_name);
+
+	f << "sample_count = " << options.sample_count << ";\n";
+	f << "time_tick = " << options.time_tick << ";\n";
+	f << "max_time = " << options.max_time << ";\n";
+	f << "discrete_time = " << (options.discrete ? "True" : "False") << ";\n";
+
+	if (options.steps_to_fixed_point != 0)
+	{
+		nodes_count -= 1;
+		f << "$u_NFP = " << python_float(1. / options.steps_to_fixed_point) << ";\n";
+		f << "$d_NFP = 0;\n";
+		f << "NFP.istate = 0;\n";
+		f << "NFP.is_internal = 0;\n";
+	}
+
+	for (int i = 0; i < nodes_count; i++)
+	{
+		f << "$u_N" << i << " = 1;\n";
+		f << "$d_N" << i << " = 1;\n";
+		f << "N" << i << ".istate = " << (i < stripe_count ? 1 : 0) << ";\n";
+		if (i % internal_stride == 0 && noninternals_count > 0)
+		{
+			f << "N" << i << ".is_internal = 0;\n";
+			noninternals_count--;
+		}
+		else
+		{
+			f << "N" << i << ".is_internal = 1;\n";
+		}
+	}
+}
+
+// Writes prefix.bnd and prefix.cfg
+inline void write_synth_model(const std::string& prefix, const synth_options& options)
+{
+	write_synth_bnd(prefix + ".bnd", options);
+	write_synth_cfg(prefix + ".cfg", options);
+}
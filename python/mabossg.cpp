@@ -0,0 +1,153 @@
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "simulation_session.h"
+#include "statistics/probtraj_format.h"
+
+namespace py = pybind11;
+
+namespace {
+
+// Results kept alive by the NumPy arrays viewing them
+struct results_holder
+{
+	simulation_results results;
+	std::optional<probtraj_view> probtraj;
+
+	explicit results_holder(simulation_results&& r) : results(std::move(r))
+	{
+		if (!results.probtraj.empty())
+			probtraj.emplace(results.probtraj.data(), results.probtraj.size());
+	}
+
+	const probtraj_view& view() const
+	{
+		if (!probtraj)
+			throw std::runtime_error("the results have no window averages");
+		return *probtraj;
+	}
+};
+
+using holder_ptr = std::shared_ptr<results_holder>;
+
+// Read-only array over the holder memory, the holder is the base object of the array
+template <typename T>
+py::array_t<T> view_array(const holder_ptr& holder, const T* data, std::vector<py::ssize_t> shape)
+{
+	py::array_t<T> array(std::move(shape), data, py::cast(holder));
+	array.attr("setflags")(py::arg("write") = false);
+	return array;
+}
+
+template <typename T>
+py::array_t<T> view_vector(const holder_ptr& holder, const std::vector<T>& data)
+{
+	return view_array(holder, data.data(), { (py::ssize_t)data.size() });
+}
+
+} // namespace
+
+PYBIND11_MODULE(mabossg, m)
+{
+	m.doc() = "MaBoSSG simulation of Boolean network models";
+
+	py::class_<results_holder, holder_ptr>(m, "Results")
+		.def_property_readonly("sample_count", [](const holder_ptr& h) { return h->results.n_trajectories; })
+
+		// final states
+		.def_property_readonly("final_state_indices",
+							   [](const holder_ptr& h) { return view_vector(h, h->results.final_state_indices); })
+		.def_property_readonly("final_state_probs",
+							   [](const holder_ptr& h) { return view_vector(h, h->results.final_state_probs); })
+		.def_property_readonly("final_state_labels",
+							   [](const holder_ptr& h) { return h->results.final_state_labels; })
+
+		// fixed points
+		.def_property_readonly("fixed_point_probs",
+							   [](const holder_ptr& h) { return view_vector(h, h->results.fixed_point_probs); })
+		.def_property_readonly("fixed_point_labels",
+							   [](const holder_ptr& h) { return h->results.fixed_point_labels; })
+		.def_property_readonly("fixed_point_nodes",
+							   [](const holder_ptr& h) {
+								   auto&& r = h->results;
+								   py::ssize_t rows = r.fixed_point_probs.size();
+								   py::ssize_t cols = rows ? r.fixed_point_nodes.size() / rows : 0;
+								   return view_array(h, r.fixed_point_nodes.data(), { rows, cols });
+							   })
+
+		// window averages, the entries of the window w are [window_offsets[w], window_offsets[w + 1])
+		.def_property_readonly("window_size", [](const holder_ptr& h) { return h->view().window_size(); })
+		.def_property_readonly(
+			"window_times",
+			[](const holder_ptr& h) { return view_array(h, h->view().window_times(), { h->view().windows_count() }); })
+		.def_property_readonly("transition_entropies",
+							   [](const holder_ptr& h) {
+								   return view_array(h, h->view().transition_entropies(),
+													 { h->view().windows_count() });
+							   })
+		.def_property_readonly("transition_entropy_errors",
+							   [](const holder_ptr& h) {
+								   return view_array(h, h->view().transition_entropy_errors(),
+													 { h->view().windows_count() });
+							   })
+		.def_property_readonly(
+			"entropies",
+			[](const holder_ptr& h) { return view_array(h, h->view().entropies(), { h->view().windows_count() }); })
+		.def_property_readonly("window_offsets",
+							   [](const holder_ptr& h) {
+								   return view_array(h, h->view().window_offsets(),
+													 { h->view().windows_count() + 1 });
+							   })
+		.def_property_readonly("entry_states",
+							   [](const holder_ptr& h) {
+								   return view_array(h, h->view().entry_states(),
+													 { (py::ssize_t)h->view().entries_count() });
+							   })
+		.def_property_readonly("entry_probs",
+							   [](const holder_ptr& h) {
+								   return view_array(h, h->view().entry_probs(),
+													 { (py::ssize_t)h->view().entries_count() });
+							   })
+		.def_property_readonly("entry_errors",
+							   [](const holder_ptr& h) {
+								   return view_array(h, h->view().entry_errors(),
+													 { (py::ssize_t)h->view().entries_count() });
+							   })
+		.def_property_readonly("state_indices",
+							   [](const holder_ptr& h) {
+								   return view_array(h, h->view().state_indices(),
+													 { (py::ssize_t)h->view().states_count() });
+							   })
+		.def_property_readonly("state_labels", [](const holder_ptr& h) {
+			py::list labels;
+			for (uint32_t s = 0; s < h->view().states_count(); s++)
+			{
+				auto label = h->view().state_label(s);
+				labels.append(py::str(label.data(), label.size()));
+			}
+			return labels;
+		});
+
+	py::class_<simulation_session>(m, "Model")
+		.def(py::init<const std::string&, const std::string&, const std::string&, int, bool>(), py::arg("bnd"),
+			 py::arg("cfg"), py::arg("backend") = "host", py::arg("threads") = thread_pool::default_threads_count(),
+			 py::arg("rate_tree") = false)
+		.def_property_readonly("nodes", &simulation_session::node_names)
+		.def(
+			"run",
+			[](simulation_session& session, std::optional<int> sample_count, std::optional<unsigned long long> seed,
+			   bool window_errors) {
+				simulation_results results;
+				{
+					py::gil_scoped_release release;
+					results = session.run(sample_count, seed, window_errors);
+				}
+				return std::make_shared<results_holder>(std::move(results));
+			},
+			py::arg("sample_count") = py::none(), py::arg("seed") = py::none(), py::arg("window_errors") = false);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Serialized form of plain values in the host byte order, the containers are prefixed by their size
+class binary_writer
+{
+	std::string out_;
+
+public:
+	template <typename T>
+	void put(const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		out_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	void put_array(const T* values, size_t count)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		put<uint64_t>(count);
+		out_.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+	}
+
+	template <typename T>
+	void put_vector(const std::vector<T>& values)
+	{
+		put_array(values.data(), values.size());
+	}
+
+	void put_string(const std::string& value)
+	{
+		put<uint64_t>(value.size());
+		out_ += value;
+	}
+
+	// Works for any map-like container of trivially copyable keys and values
+	template <typename map_t>
+	void put_map(const map_t& map)
+	{
+		put<uint64_t>(map.size());
+		for (const auto& [key, value] : map)
+		{
+			put(key);
+			put(value);
+		}
+	}
+
+	std::string take() { return std::move(out_); }
+};
+
+// Reads the values written by binary_writer, errors are thrown as std::runtime_error prefixed by the context
+class binary_reader
+{
+	const std::string& data_;
+	std::string context_;
+	size_t offset_ = 0;
+
+	// the counts come from the data, so they are checked without multiplying them
+	void require(uint64_t count, size_t size = 1) const
+	{
+		if (count > (data_.size() - offset_) / size)
+			fail("truncated data");
+	}
+
+public:
+	binary_reader(const std::string& data, std::string context) : data_(data), context_(std::move(context)) {}
+
+	[[noreturn]] void fail(const std::string& message) const { throw std::runtime_error(context_ + ": " + message); }
+
+	template <typename T>
+	T get()
+	{
+		T value;
+		require(sizeof(T));
+		std::memcpy(&value, data_.data() + offset_, sizeof(T));
+		offset_ += sizeof(T);
+		return value;
+	}
+
+	template <typename T>
+	std::vector<T> get_vector()
+	{
+		auto count = get<uint64_t>();
+		require(count, sizeof(T));
+
+		std::vector<T> values(count);
+		std::memcpy(values.data(), data_.data() + offset_, count * sizeof(T));
+		offset_ += count * sizeof(T);
+		return values;
+	}
+
+	// Reads an array which has to have the given count of values
+	template <typename T>
+	void get_array(T* values, size_t count)
+	{
+		if (get<uint64_t>() != count)
+			fail("unexpected size");
+
+		require(count, sizeof(T));
+		std::memcpy(values, data_.data() + offset_, count * sizeof(T));
+		offset_ += count * sizeof(T);
+	}
+
+	// Reads a vector which has to have the size of values
+	template <typename T>
+	void get_vector(std::vector<T>& values)
+	{
+		get_array(values.data(), values.size());
+	}
+
+	std::string get_string()
+	{
+		auto count = get<uint64_t>();
+		require(count);
+
+		std::string value = data_.substr(offset_, count);
+		offset_ += count;
+		return value;
+	}
+
+	template <typename map_t>
+	map_t get_map()
+	{
+		map_t map;
+		for (auto count = get<uint64_t>(); count > 0; count--)
+		{
+			auto key = get<typename map_t::key_type>();
+			map.emplace(key, get<typename map_t::mapped_type>());
+		}
+		return map;
+	}
+
+	bool at_end() const { return offset_ == data_.size(); }
+};
@@ -0,0 +1,153 @@
+#include "checkpoint.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "binary_stream.h"
+
+checkpointer::checkpointer(std::string path, std::string fingerprint, std::chrono::seconds interval)
+	: path_(std::move(path)),
+	  fingerprint_(std::move(fingerprint)),
+	  interval_(interval),
+	  last_save_(std::chrono::steady_clock::now()),
+	  writer_([this] { write_loop(); })
+{}
+
+checkpointer::~checkpointer()
+{
+	{
+		std::lock_guard lock(mutex_);
+		stopping_ = true;
+	}
+	cv_.notify_all();
+
+	writer_.join();
+}
+
+bool checkpointer::load()
+{
+	std::ifstream ifs(path_, std::ios::binary);
+	if (!ifs)
+		return false;
+
+	std::ostringstream ss;
+	ss << ifs.rdbuf();
+	auto data = ss.str();
+
+	binary_reader r(data, "checkpoint " + path_);
+
+	for (char c : magic_value)
+		if (r.get<char>() != c)
+			r.fail("bad magic");
+
+	auto version = r.get<uint32_t>();
+	if (version != current_version)
+		r.fail("unsupported version " + std::to_string(version));
+
+	if (r.get_string() != fingerprint_)
+		r.fail("written by a run with other inputs");
+
+	resume_state_ = r.get_string();
+
+	if (!r.at_end())
+		r.fail("trailing data");
+
+	return true;
+}
+
+std::optional<std::string> checkpointer::take_resume_state()
+{
+	auto state = std::move(resume_state_);
+	resume_state_.reset();
+	return state;
+}
+
+bool checkpointer::due() const { return std::chrono::steady_clock::now() - last_save_ >= interval_; }
+
+void checkpointer::save(std::string state)
+{
+	binary_writer w;
+	for (char c : magic_value)
+		w.put(c);
+	w.put(current_version);
+	w.put_string(fingerprint_);
+	w.put_string(state);
+
+	{
+		std::lock_guard lock(mutex_);
+		pending_ = w.take();
+	}
+	cv_.notify_all();
+
+	last_save_ = std::chrono::steady_clock::now();
+}
+
+void checkpointer::finish()
+{
+	std::unique_lock lock(mutex_);
+	pending_.reset();
+	cv_.wait(lock, [&] { return !writing_; });
+
+	std::remove(path_.c_str());
+}
+
+void checkpointer::write_loop()
+{
+	std::unique_lock lock(mutex_);
+
+	while (true)
+	{
+		cv_.wait(lock, [&] { return stopping_ || pending_; });
+
+		if (!pending_)
+			return;
+
+		auto data = std::move(*pending_);
+		pending_.reset();
+		writing_ = true;
+
+		lock.unlock();
+		write_file(data);
+		lock.lock();
+
+		writing_ = false;
+		cv_.notify_all();
+	}
+}
+
+void checkpointer::write_file(const std::string& data) const
+{
+
+	// the complete checkpoint is synced before it replaces the previous one
+	auto temp_path = path_ + ".tmp";
+
+	int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	bool written = fd != -1;
+
+	for (size_t offset = 0; written && offset < data.size();)
+	{
+		auto n = write(fd, data.data() + offset, data.size() - offset);
+		if (n < 0 && errno == EINTR)
+			continue;
+
+		written = n > 0;
+		offset += written ? n : 0;
+	}
+
+	written = written && fsync(fd) == 0;
+	if (fd != -1)
+		close(fd);
+
+	if (!written || std::rename(temp_path.c_str(), path_.c_str()) != 0)
+	{
+		std::cerr << "checkpointer> cannot write " << path_ << ": " << std::strerror(errno) << std::endl;
+		std::remove(temp_path.c_str());
+	}
+}
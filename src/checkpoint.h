@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+// Periodic checkpoints of a long simulation, i.e. the batch slots of the runner and the stats accumulated so far.
+// The runner serializes a checkpoint between two batches and a background thread writes it to the file, replacing the
+// previous checkpoint atomically, so the simulation does not wait for the disk and a crash leaves the last complete
+// checkpoint behind.
+class checkpointer
+{
+	static constexpr char magic_value[8] = { 'M', 'B', 'G', 'C', 'K', 'P', 'T', '\0' };
+	static constexpr uint32_t current_version = 2;
+
+	std::string path_;
+	std::string fingerprint_;
+	std::chrono::steady_clock::duration interval_;
+	std::chrono::steady_clock::time_point last_save_;
+
+	std::optional<std::string> resume_state_;
+
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::optional<std::string> pending_;
+	bool writing_ = false;
+	bool stopping_ = false;
+	std::thread writer_;
+
+	void write_loop();
+	void write_file(const std::string& data) const;
+
+public:
+	// The fingerprint identifies the inputs of the run, the checkpoints of other runs are not resumed
+	checkpointer(std::string path, std::string fingerprint, std::chrono::seconds interval);
+
+	// Writes the pending checkpoint
+	~checkpointer();
+
+	checkpointer(const checkpointer&) = delete;
+	checkpointer& operator=(const checkpointer&) = delete;
+
+	// Reads the checkpoint to resume from, returns false if there is none.
+	// Throws std::runtime_error if the file is not a checkpoint of this run.
+	bool load();
+
+	// Takes the state stored by the loaded checkpoint, the runner restores it before its first batch
+	std::optional<std::string> take_resume_state();
+
+	// True once the interval passed since the last checkpoint
+	bool due() const;
+
+	// Hands the serialized state of the runner over to the background writer, a checkpoint still waiting for the
+	// writer is replaced by the newer one
+	void save(std::string state);
+
+	// Waits for the writer and removes the checkpoint file, the run is complete and has nothing to resume
+	void finish();
+};
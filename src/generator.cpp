@@ -3,10 +3,44 @@
 #include <algorithm>
 #include <sstream>
 
+#include "host/transition_selection.h"
 #include "timer.h"
 #include "utils.h"
 
-generator::generator(driver& drv) : drv_(drv) {}
+// dumps the generated code to stderr when debugging the generator
+constexpr bool print_generated_code = false;
+
+generator::generator(driver& drv, code_target target, bool rate_tree)
+	: drv_(drv), target_(target), rate_tree_(rate_tree)
+{}
+
+const char* generator::function_qualifiers(bool exported) const
+{
+	if (target_ == code_target::host)
+		return exported ? "extern \"C\" " : "static inline ";
+	return "__device__ ";
+}
+
+const char* generator::data_qualifiers() const
+{
+	if (target_ == code_target::host)
+		return "static const ";
+	return "__device__ const ";
+}
+
+const char* generator::parameters_declaration() const
+{
+	if (target_ == code_target::host)
+		return ", const float* __restrict__ parameters";
+	return "";
+}
+
+const char* generator::parameters_argument() const
+{
+	if (target_ == code_target::host)
+		return ", parameters";
+	return "";
+}
 
 std::string generator::generate_code() const
 {
@@ -14,11 +48,20 @@ std::string generator::generate_code() const
 
 	std::ostringstream ss;
 
-	ss << "using uint8_t = unsigned char;" << std::endl;
-	ss << "using uint32_t = unsigned int;" << std::endl << std::endl;
+	if (target_ == code_target::host)
+	{
+		ss << "#include <cmath>" << std::endl;
+		ss << "#include <cstdint>" << std::endl << std::endl;
+	}
+	else
+	{
+		ss << "using uint8_t = unsigned char;" << std::endl;
+		ss << "using uint32_t = unsigned int;" << std::endl << std::endl;
+	}
 
 	ss << "constexpr int state_size = " << drv_.nodes.size() << ";" << std::endl;
 	ss << "constexpr int state_words = " << DIV_UP(drv_.nodes.size(), 32) << ";" << std::endl;
+	ss << "constexpr int rate_tree_leaves = " << rate_tree_leaves(drv_.nodes.size()) << ";" << std::endl;
 	ss << "constexpr bool discrete_time = " << (drv_.constants["discrete_time"] != 0) << ";" << std::endl;
 	ss << "constexpr float max_time = " << drv_.constants["max_time"] << ";" << std::endl;
 	ss << "constexpr float time_tick = " << drv_.constants["time_tick"] << ";" << std::endl;
@@ -34,21 +77,31 @@ std::string generator::generate_code() const
 	generate_aggregate_function(ss);
 	ss << std::endl;
 
+	generate_update_function(ss);
+	ss << std::endl;
+
+	generate_rate_tree_update_function(ss);
+	ss << std::endl;
+
 	generate_transition_entropy_function(ss);
 	ss << std::endl;
 
-	const char* traj_status_cu =
+	// the host backend runs its own simulation loop over the exported functions
+	if (target_ == code_target::cuda)
+	{
+		const char* traj_status_cu =
 #include "jit_kernels/include/trajectory_status.h"
-		;
-	ss << traj_status_cu << std::endl;
+			;
+		ss << traj_status_cu << std::endl;
 
-	generate_simulate(ss);
-	ss << std::endl;
+		generate_simulate(ss);
+		ss << std::endl;
+	}
 
 	generate_non_internal_index(ss);
 	ss << std::endl;
 
-	if (timer_stats::enable_diags())
+	if constexpr (print_generated_code)
 		std::cerr << ss.str() << std::endl;
 
 	return ss.str();
@@ -81,17 +134,49 @@ bool is_logic_ternary_expression(const driver& drv, const expression* expr, bool
 	return true;
 }
 
+std::vector<std::vector<int>> build_node_dependents(const driver& drv)
+{
+	std::vector<std::vector<int>> dependents(drv.nodes.size());
+
+	for (size_t i = 0; i < drv.nodes.size(); i++)
+	{
+		auto&& node = drv.nodes[i];
+
+		// the rate of a node always reads the node itself
+		std::vector<int> references = { (int)i };
+		for (auto attr : { "logic", "rate_up", "rate_down" })
+			if (node.has_attr(attr))
+				node.get_attr(attr).second->collect_node_references(drv, node.name, references);
+
+		std::sort(references.begin(), references.end());
+		references.erase(std::unique(references.begin(), references.end()), references.end());
+
+		for (int reference : references)
+			dependents[reference].push_back(i);
+	}
+
+	return dependents;
+}
+
 void generator::generate_node_transitions(std::ostringstream& os) const
 {
 	for (auto&& node : drv_.nodes)
 	{
-		os << "__device__ float " << node.name << "_rate(const state_word_t* __restrict__ state) " << std::endl;
+		os << function_qualifiers(false) << "float " << node.name << "_rate(const state_word_t* __restrict__ state"
+		   << parameters_declaration() << ") " << std::endl;
 		os << "{" << std::endl;
 
 		float up_val, down_val;
 
-		if (is_logic_ternary_expression(drv_, node.get_attr("rate_up").second.get(), true, up_val)
-			&& is_logic_ternary_expression(drv_, node.get_attr("rate_down").second.get(), false, down_val))
+		// the rates reading the runtime variables are evaluated with the parameters, the others are folded
+		auto&& rate_up = node.get_attr("rate_up").second;
+		auto&& rate_down = node.get_attr("rate_down").second;
+		bool runtime_rates = drv_.runtime_variables
+							 && (rate_up->references_variables(drv_, node.name)
+								 || rate_down->references_variables(drv_, node.name));
+
+		if (!runtime_rates && is_logic_ternary_expression(drv_, rate_up.get(), true, up_val)
+			&& is_logic_ternary_expression(drv_, rate_down.get(), false, down_val))
 		{
 			os << "    const bool is_up = ";
 			identifier_expression(node.name).generate_code(drv_, node.name, os);
@@ -123,9 +208,10 @@ void generator::generate_node_transitions(std::ostringstream& os) const
 
 void generator::generate_aggregate_function(std::ostringstream& os) const
 {
-	os << "__device__ float compute_transition_rates(float* __restrict__ transition_rates, const state_word_t* "
-		  "__restrict__ state)"
-	   << std::endl;
+	os << function_qualifiers(true)
+	   << "float compute_transition_rates(float* __restrict__ transition_rates, const state_word_t* "
+		  "__restrict__ state"
+	   << parameters_declaration() << ")" << std::endl;
 	os << "{" << std::endl;
 	os << "    float sum = 0;" << std::endl;
 	os << "    float tmp;" << std::endl;
@@ -134,7 +220,7 @@ void generator::generate_aggregate_function(std::ostringstream& os) const
 	int i = 0;
 	for (auto&& node : drv_.nodes)
 	{
-		os << "    tmp = " << node.name << "_rate(state);" << std::endl;
+		os << "    tmp = " << node.name << "_rate(state" << parameters_argument() << ");" << std::endl;
 		os << "    transition_rates[" << i++ << "] = tmp;" << std::endl;
 		os << "    sum += tmp;" << std::endl;
 		os << std::endl;
@@ -143,9 +229,84 @@ void generator::generate_aggregate_function(std::ostringstream& os) const
 	os << "}" << std::endl;
 }
 
+void generator::generate_update_function(std::ostringstream& os) const
+{
+	auto dependents = build_node_dependents(drv_);
+
+	// the dependents of the node i are node_dependents[node_dependents_offsets[i]] up to the next offset,
+	// node rates are dispatched by a single switch so that each rate function is inlined only once
+	os << data_qualifiers() << "int node_dependents_offsets[] = { 0";
+	size_t offset = 0;
+	for (auto&& node_dependents : dependents)
+		os << ", " << (offset += node_dependents.size());
+	os << " };" << std::endl;
+
+	os << data_qualifiers() << "int node_dependents[] = { ";
+	for (auto&& node_dependents : dependents)
+		for (int dependent : node_dependents)
+			os << dependent << ", ";
+	os << "};" << std::endl << std::endl;
+
+	os << function_qualifiers(false) << "float node_rate(int node, const state_word_t* __restrict__ state"
+	   << parameters_declaration() << ")" << std::endl;
+	os << "{" << std::endl;
+	os << "    switch (node)" << std::endl;
+	os << "    {" << std::endl;
+	for (size_t i = 0; i < drv_.nodes.size(); i++)
+		os << "    case " << i << ": return " << drv_.nodes[i].name << "_rate(state" << parameters_argument() << ");"
+		   << std::endl;
+	os << "    }" << std::endl;
+	os << "    return 0;" << std::endl;
+	os << "}" << std::endl << std::endl;
+
+	// after flipping a node only the rates of its dependents change, the change of the total rate is returned
+	os << function_qualifiers(true)
+	   << "double update_transition_rates(float* __restrict__ transition_rates, const state_word_t* "
+		  "__restrict__ state, int flipped_node"
+	   << parameters_declaration() << ")" << std::endl;
+	os << "{" << std::endl;
+	os << "    double delta = 0;" << std::endl;
+	os << "    for (int i = node_dependents_offsets[flipped_node]; i < node_dependents_offsets[flipped_node + 1]; i++)"
+	   << std::endl;
+	os << "    {" << std::endl;
+	os << "        int node = node_dependents[i];" << std::endl;
+	os << "        float tmp = node_rate(node, state" << parameters_argument() << ");" << std::endl;
+	os << "        delta += (double)tmp - transition_rates[node];" << std::endl;
+	os << "        transition_rates[node] = tmp;" << std::endl;
+	os << "    }" << std::endl;
+	os << "    return delta;" << std::endl;
+	os << "}" << std::endl;
+}
+
+void generator::generate_rate_tree_update_function(std::ostringstream& os) const
+{
+	// the same as update_transition_rates for the rates in the leaves of a rate tree, see host/transition_selection.h
+	os << function_qualifiers(false) << "void update_rate_tree(float* __restrict__ tree, int node)" << std::endl;
+	os << "{" << std::endl;
+	os << "    for (int p = (rate_tree_leaves + node) / 2; p >= 1; p /= 2)" << std::endl;
+	os << "        tree[p] = tree[2 * p] + tree[2 * p + 1];" << std::endl;
+	os << "}" << std::endl << std::endl;
+
+	os << function_qualifiers(true)
+	   << "void update_transition_rate_tree(float* __restrict__ rate_tree, const state_word_t* __restrict__ state, "
+		  "int flipped_node"
+	   << parameters_declaration() << ")" << std::endl;
+	os << "{" << std::endl;
+	os << "    for (int i = node_dependents_offsets[flipped_node]; i < node_dependents_offsets[flipped_node + 1]; i++)"
+	   << std::endl;
+	os << "    {" << std::endl;
+	os << "        int node = node_dependents[i];" << std::endl;
+	os << "        rate_tree[rate_tree_leaves + node] = node_rate(node, state" << parameters_argument() << ");"
+	   << std::endl;
+	os << "        update_rate_tree(rate_tree, node);" << std::endl;
+	os << "    }" << std::endl;
+	os << "}" << std::endl;
+}
+
 void generator::generate_transition_entropy_function(std::ostringstream& os) const
 {
-	os << "__device__ float compute_transition_entropy(const float* __restrict__ transition_rates)" << std::endl;
+	os << function_qualifiers(true) << "float compute_transition_entropy(const float* __restrict__ transition_rates)"
+	   << std::endl;
 	os << "{" << std::endl;
 	os << "    float entropy = 0.f;" << std::endl;
 	os << "    float non_internal_total_rate = 0.f;" << std::endl;
@@ -184,7 +345,8 @@ extern __device__ void simulate_inner(int trajectories_count, int state_size, in
 									  float* __restrict__ trajectory_times,
 									  float* __restrict__ trajectory_transition_entropies,
 									  trajectory_status* __restrict__ trajectory_statuses,
-									  float* __restrict__ transition_rates, state_word_t* __restrict__ state);
+									  float* __restrict__ transition_rates, float* __restrict__ rate_tree,
+									  state_word_t* __restrict__ state);
 
 extern "C" __global__ void simulate(int trajectories_count, int trajectory_limit,
 									state_word_t* __restrict__ last_states, float* __restrict__ last_times,
@@ -193,20 +355,32 @@ extern "C" __global__ void simulate(int trajectories_count, int trajectory_limit
 									float* __restrict__ trajectory_transition_entropies,
 									trajectory_status* __restrict__ trajectory_statuses)
 {
-	float transition_rates[state_size];
+)";
+
+	if (rate_tree_)
+		os << "	float rate_tree[2 * rate_tree_leaves];" << std::endl
+		   << "	float* transition_rates = rate_tree + rate_tree_leaves;" << std::endl;
+	else
+		os << "	float transition_rates[state_size];" << std::endl
+		   << "	float* rate_tree = nullptr;" << std::endl;
 
+	os << R"(
 	state_word_t state[state_words];
 
 	simulate_inner(trajectories_count, state_size, trajectory_limit, time_tick, max_time, discrete_time, last_states,
 				   last_times, rands, trajectory_states, trajectory_times, trajectory_transition_entropies,
-				   trajectory_statuses, transition_rates, state);
+				   trajectory_statuses, transition_rates, rate_tree, state);
 }
 )";
 }
 
 void generator::generate_non_internal_index(std::ostringstream& os) const
 {
-	os << "__device__ uint32_t get_non_internal_index(const state_word_t* __restrict__ state)" << std::endl;
+	// the CUDA statistics index dense arrays by it, the host ones may key hash tables by up to 64 non-internal nodes
+	const char* index_type = target_ == code_target::host ? "uint64_t" : "uint32_t";
+
+	os << function_qualifiers(true) << index_type << " get_non_internal_index(const state_word_t* __restrict__ state)"
+	   << std::endl;
 	os << "{" << std::endl;
 	os << "    return" << std::endl;
 	os << "			";
@@ -217,7 +391,7 @@ void generator::generate_non_internal_index(std::ostringstream& os) const
 	{
 		if (!drv_.nodes[i].is_internal(drv_))
 		{
-			os << "((state[" << i / 32 << "] & " << (1u << i % 32) << "u)";
+			os << "((" << index_type << ")(state[" << i / 32 << "] & " << (1u << i % 32) << "u)";
 			auto shift = (int)(i % 32) - non_internals++;
 			if (shift > 0)
 				os << " >> " << shift;
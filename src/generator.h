@@ -1,15 +1,32 @@
 #pragma once
 
 #include <sstream>
+#include <vector>
 
 #include "parser/driver.h"
 
+// Device the generated code is compiled for
+enum class code_target
+{
+	cuda,
+	host
+};
+
+// Checks if expr is "@logic ? val : 0" for the up rate or "@logic ? 0 : val" for the down rate and stores val
+bool is_logic_ternary_expression(const driver& drv, const expression* expr, bool up, float& val);
+
+// Dependency graph of the node rates, dependents[i] lists in ascending order the nodes whose rate reads the node i
+std::vector<std::vector<int>> build_node_dependents(const driver& drv);
+
 class generator
 {
 	driver& drv_;
+	code_target target_;
+	bool rate_tree_;
 
 public:
-	generator(driver& drv);
+	// With rate_tree the generated CUDA simulation selects the flips by a rate tree instead of a linear scan
+	generator(driver& drv, code_target target = code_target::cuda, bool rate_tree = false);
 
 	std::string generate_code() const;
 
@@ -17,7 +34,20 @@ private:
 	void generate_node_transitions(std::ostringstream& os) const;
 	void generate_transition_entropy_function(std::ostringstream& os) const;
 	void generate_aggregate_function(std::ostringstream& os) const;
+	void generate_update_function(std::ostringstream& os) const;
+	void generate_rate_tree_update_function(std::ostringstream& os) const;
 	void generate_simulate(std::ostringstream& os) const;
 
 	void generate_non_internal_index(std::ostringstream& os) const;
+
+	// Qualifiers of a generated function, exported ones are the entry points of the simulation module
+	const char* function_qualifiers(bool exported) const;
+
+	// Qualifiers of a generated constant table
+	const char* data_qualifiers() const;
+
+	// Trailing parameter of the generated rate functions and the matching argument, the host code takes the runtime
+	// parameters of the model (see driver::runtime_variables)
+	const char* parameters_declaration() const;
+	const char* parameters_argument() const;
 };
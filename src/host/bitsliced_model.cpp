@@ -0,0 +1,313 @@
+#include "bitsliced_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "../generator.h"
+#include "../timer.h"
+#include "transition_selection.h"
+
+constexpr int word_size = sizeof(state_word_t) * 8;
+
+// Lowers a Boolean formula to the bitwise code, returns false if the formula is not Boolean
+bool lower_logic(const driver& drv, const expression* expr, const std::string& current_node,
+				 bitsliced_program& program, int depth)
+{
+	using opcode = bitsliced_program::opcode;
+
+	if (depth >= bitsliced_model::max_stack_depth)
+		return false;
+
+	if (auto e = dynamic_cast<const parenthesis_expression*>(expr))
+		return lower_logic(drv, e->expr.get(), current_node, program, depth);
+
+	if (auto e = dynamic_cast<const identifier_expression*>(expr))
+	{
+		auto it =
+			std::find_if(drv.nodes.begin(), drv.nodes.end(), [&](auto&& node) { return node.name == e->name; });
+		if (it == drv.nodes.end())
+			throw std::runtime_error("unknown node name: " + e->name);
+
+		program.code.push_back({ opcode::push_node, (uint32_t)(it - drv.nodes.begin()) });
+		return true;
+	}
+
+	if (dynamic_cast<const literal_expression*>(expr) || dynamic_cast<const variable_expression*>(expr))
+	{
+		float value = expr->evaluate(drv);
+		if (value != 0.f && value != 1.f)
+			return false;
+
+		program.code.push_back({ value == 0.f ? opcode::push_zeros : opcode::push_ones, 0 });
+		return true;
+	}
+
+	if (auto e = dynamic_cast<const alias_expression*>(expr))
+	{
+		auto it = std::find_if(drv.nodes.begin(), drv.nodes.end(),
+							   [&](auto&& node) { return node.name == current_node; });
+
+		return lower_logic(drv, it->get_attr(e->name.substr(1)).second.get(), current_node, program, depth);
+	}
+
+	if (auto e = dynamic_cast<const unary_expression*>(expr))
+	{
+		if (e->op != operation::NOT && e->op != operation::PLUS)
+			return false;
+
+		if (!lower_logic(drv, e->expr.get(), current_node, program, depth))
+			return false;
+
+		if (e->op == operation::NOT)
+			program.code.push_back({ opcode::bit_not, 0 });
+		return true;
+	}
+
+	if (auto e = dynamic_cast<const binary_expression*>(expr))
+	{
+		if (e->op != operation::AND && e->op != operation::OR)
+			return false;
+
+		if (!lower_logic(drv, e->left.get(), current_node, program, depth)
+			|| !lower_logic(drv, e->right.get(), current_node, program, depth + 1))
+			return false;
+
+		program.code.push_back({ e->op == operation::AND ? opcode::bit_and : opcode::bit_or, 0 });
+		return true;
+	}
+
+	return false;
+}
+
+// Lowers the logic of all the nodes and collects their rates, returns false if the model is not supported
+bool lower_model(const driver& drv, bitsliced_program& program, std::vector<size_t>& logic_entries,
+				 std::vector<float>& up_rates, std::vector<float>& down_rates)
+{
+	for (auto&& node : drv.nodes)
+	{
+		float up_val, down_val;
+
+		if (!node.has_attr("logic")
+			|| !is_logic_ternary_expression(drv, node.get_attr("rate_up").second.get(), true, up_val)
+			|| !is_logic_ternary_expression(drv, node.get_attr("rate_down").second.get(), false, down_val))
+			return false;
+
+		logic_entries.push_back(program.code.size());
+
+		if (!lower_logic(drv, node.get_attr("logic").second.get(), node.name, program, 0))
+			return false;
+
+		program.code.push_back({ bitsliced_program::opcode::ret, 0 });
+
+		up_rates.push_back(up_val);
+		down_rates.push_back(down_val);
+	}
+
+	return true;
+}
+
+bool bitsliced_model::is_supported(const driver& drv)
+{
+	bitsliced_program program;
+	std::vector<size_t> logic_entries;
+	std::vector<float> up_rates, down_rates;
+
+	return lower_model(drv, program, logic_entries, up_rates, down_rates);
+}
+
+bitsliced_model::bitsliced_model(const driver& drv)
+{
+	timer_stats stats("bitsliced_model> lower");
+
+	if (!lower_model(drv, program_, logic_entries_, up_rates_, down_rates_))
+		throw std::runtime_error("the model has node rates which are not supported by the bitsliced engine");
+
+	for (size_t i = 0; i < drv.nodes.size(); i++)
+		if (!drv.nodes[i].is_internal(drv))
+			non_internals_.push_back(i);
+}
+
+int bitsliced_model::state_size() const { return logic_entries_.size(); }
+
+void bitsliced_model::evaluate_logic(size_t entry, const uint64_t* __restrict__ nodes,
+									 uint64_t* __restrict__ logic) const
+{
+	using opcode = bitsliced_program::opcode;
+
+	uint64_t stack[max_stack_depth][lane_words];
+	int top = -1;
+
+	for (size_t pc = entry;; pc++)
+	{
+		const auto& i = program_.code[pc];
+
+		switch (i.op)
+		{
+			case opcode::push_node:
+				top++;
+				for (int w = 0; w < lane_words; w++)
+					stack[top][w] = nodes[i.node * lane_words + w];
+				break;
+			case opcode::push_zeros:
+				top++;
+				for (int w = 0; w < lane_words; w++)
+					stack[top][w] = 0;
+				break;
+			case opcode::push_ones:
+				top++;
+				for (int w = 0; w < lane_words; w++)
+					stack[top][w] = ~0ull;
+				break;
+			case opcode::bit_not:
+				for (int w = 0; w < lane_words; w++)
+					stack[top][w] = ~stack[top][w];
+				break;
+			case opcode::bit_and:
+				top--;
+				for (int w = 0; w < lane_words; w++)
+					stack[top][w] &= stack[top + 1][w];
+				break;
+			case opcode::bit_or:
+				top--;
+				for (int w = 0; w < lane_words; w++)
+					stack[top][w] |= stack[top + 1][w];
+				break;
+			case opcode::ret:
+				for (int w = 0; w < lane_words; w++)
+					logic[w] = stack[top][w];
+				return;
+		}
+	}
+}
+
+// Lanes of a nibble, nibble_lanes[n][l] is 1 if the bit l of n is set
+constexpr float nibble_lanes[16][4] = {
+	{ 0, 0, 0, 0 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 1, 1, 0, 0 }, { 0, 0, 1, 0 }, { 1, 0, 1, 0 },
+	{ 0, 1, 1, 0 }, { 1, 1, 1, 0 }, { 0, 0, 0, 1 }, { 1, 0, 0, 1 }, { 0, 1, 0, 1 }, { 1, 1, 0, 1 },
+	{ 0, 0, 1, 1 }, { 1, 0, 1, 1 }, { 0, 1, 1, 1 }, { 1, 1, 1, 1 },
+};
+
+void bitsliced_model::compute_transition_rates(const uint64_t* __restrict__ nodes, float* __restrict__ rates,
+											   float* __restrict__ total_rates) const
+{
+	std::fill(total_rates, total_rates + lanes, 0.f);
+
+	for (size_t i = 0; i < logic_entries_.size(); i++)
+	{
+		uint64_t logic[lane_words];
+		evaluate_logic(logic_entries_[i], nodes, logic);
+
+		const float up_rate = up_rates_[i];
+		const float down_rate = down_rates_[i];
+		float* __restrict__ node_rates = rates + i * lanes;
+
+		for (int w = 0; w < lane_words; w++)
+		{
+			// the node goes up if it is unset and its logic holds, it goes down if it is set and its logic does not
+			const uint64_t up = ~nodes[i * lane_words + w] & logic[w];
+			const uint64_t down = nodes[i * lane_words + w] & ~logic[w];
+
+			// the bits are expanded into lanes a nibble at a time so that the loop vectorizes
+			for (int b = 0; b < 64; b += 4)
+			{
+				const float* up_lanes = nibble_lanes[(up >> b) & 0xf];
+				const float* down_lanes = nibble_lanes[(down >> b) & 0xf];
+
+				for (int l = 0; l < 4; l++)
+					node_rates[w * 64 + b + l] = up_lanes[l] * up_rate + down_lanes[l] * down_rate;
+			}
+		}
+
+		for (int lane = 0; lane < lanes; lane++)
+			total_rates[lane] += node_rates[lane];
+	}
+}
+
+// Entropy of the transitions of the non-internal nodes, the rate of the node i is rates[i * stride]
+float transition_entropy(const std::vector<int>& non_internals, const float* __restrict__ rates, int stride)
+{
+	float entropy = 0.f;
+	float non_internal_total_rate = 0.f;
+
+	for (int i : non_internals)
+		non_internal_total_rate += rates[i * stride];
+
+	if (non_internal_total_rate == 0.f)
+		return 0.f;
+
+	for (int i : non_internals)
+	{
+		float tmp_prob = rates[i * stride] / non_internal_total_rate;
+		entropy -= (tmp_prob == 0.f) ? 0.f : std::log2(tmp_prob) * tmp_prob;
+	}
+
+	return entropy;
+}
+
+float bitsliced_model::compute_transition_entropy(const float* __restrict__ rates, int lane) const
+{
+	return transition_entropy(non_internals_, rates + lane, lanes);
+}
+
+float bitsliced_model::compute_transition_rates(float* __restrict__ transition_rates,
+												const state_word_t* __restrict__ state) const
+{
+	// a single state is simulated as the lane 0 of a block
+	std::vector<uint64_t> nodes(logic_entries_.size() * lane_words);
+	std::vector<float> rates(logic_entries_.size() * lanes), total_rates(lanes);
+
+	for (size_t i = 0; i < logic_entries_.size(); i++)
+		nodes[i * lane_words] = (state[i / word_size] >> (i % word_size)) & 1u;
+
+	compute_transition_rates(nodes.data(), rates.data(), total_rates.data());
+
+	for (size_t i = 0; i < logic_entries_.size(); i++)
+		transition_rates[i] = rates[i * lanes];
+
+	return total_rates[0];
+}
+
+double bitsliced_model::update_transition_rates(float* __restrict__ transition_rates,
+												const state_word_t* __restrict__ state, int) const
+{
+	// the lanes of a block flip different nodes, so the rates are always recomputed as a whole
+	std::vector<float> rates(logic_entries_.size());
+	compute_transition_rates(rates.data(), state);
+
+	double delta = 0;
+	for (size_t i = 0; i < rates.size(); i++)
+	{
+		delta += (double)rates[i] - transition_rates[i];
+		transition_rates[i] = rates[i];
+	}
+
+	return delta;
+}
+
+void bitsliced_model::update_transition_rate_tree(float* __restrict__ rate_tree,
+												  const state_word_t* __restrict__ state, int) const
+{
+	int leaves = rate_tree_leaves(logic_entries_.size());
+
+	compute_transition_rates(rate_tree + leaves, state);
+	build_rate_tree(logic_entries_.size(), leaves, rate_tree);
+}
+
+float bitsliced_model::compute_transition_entropy(const float* __restrict__ transition_rates) const
+{
+	return transition_entropy(non_internals_, transition_rates, 1);
+}
+
+uint64_t bitsliced_model::get_non_internal_index(const state_word_t* __restrict__ state) const
+{
+	uint64_t idx = 0;
+
+	for (size_t j = 0; j < non_internals_.size(); j++)
+	{
+		int i = non_internals_[j];
+		idx |= (uint64_t)((state[i / word_size] >> (i % word_size)) & 1u) << j;
+	}
+
+	return idx;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../parser/driver.h"
+#include "host_model.h"
+
+// Bitwise code of the node logic formulas evaluated for a whole block of lanes at once
+class bitsliced_program
+{
+public:
+	enum class opcode : uint8_t
+	{
+		push_node,
+		push_zeros,
+		push_ones,
+		bit_not,
+		bit_and,
+		bit_or,
+		ret
+	};
+
+	struct instruction
+	{
+		opcode op;
+		uint32_t node;
+	};
+
+	std::vector<instruction> code;
+};
+
+// Model whose node rates are all of the form "@logic ? rate : 0" with a Boolean logic and constant rates.
+// The state of a block of trajectories is transposed, so one machine word holds the value of a node in 64
+// trajectories (lanes) and a logic formula is evaluated for all the lanes with a few bitwise instructions.
+class bitsliced_model : public host_model
+{
+public:
+	// the lane words of a block are processed in loops the compiler vectorizes to the available SIMD width
+	static constexpr int lane_words = 4;
+	static constexpr int lanes = lane_words * 64;
+
+	// at most this many formula values are on the evaluation stack
+	static constexpr int max_stack_depth = 32;
+
+private:
+	bitsliced_program program_;
+	std::vector<size_t> logic_entries_;
+	std::vector<float> up_rates_, down_rates_;
+	std::vector<int> non_internals_;
+
+	void evaluate_logic(size_t entry, const uint64_t* __restrict__ nodes, uint64_t* __restrict__ logic) const;
+
+public:
+	bitsliced_model(const driver& drv);
+
+	// Checks if all the nodes have constant rates and a Boolean logic
+	static bool is_supported(const driver& drv);
+
+	int state_size() const;
+
+	// Computes the node rates of a block, nodes holds lane_words words per node and rates holds lanes floats per node
+	void compute_transition_rates(const uint64_t* __restrict__ nodes, float* __restrict__ rates,
+								  float* __restrict__ total_rates) const;
+
+	// Transition entropy of the lane from the rates of a block
+	float compute_transition_entropy(const float* __restrict__ rates, int lane) const;
+
+	float compute_transition_rates(float* __restrict__ transition_rates,
+								   const state_word_t* __restrict__ state) const override;
+
+	double update_transition_rates(float* __restrict__ transition_rates, const state_word_t* __restrict__ state,
+								   int flipped_node) const override;
+
+	void update_transition_rate_tree(float* __restrict__ rate_tree, const state_word_t* __restrict__ state,
+									 int flipped_node) const override;
+
+	float compute_transition_entropy(const float* __restrict__ transition_rates) const override;
+
+	uint64_t get_non_internal_index(const state_word_t* __restrict__ state) const override;
+};
@@ -0,0 +1,195 @@
+#include "bytecode.h"
+
+#include <stdexcept>
+
+constexpr int word_size = sizeof(state_word_t) * 8;
+
+int stack_effect(opcode op)
+{
+	switch (op)
+	{
+		case opcode::push_const:
+		case opcode::push_node:
+		case opcode::push_node_not:
+			return 1;
+		case opcode::negate:
+		case opcode::logical_not:
+		case opcode::jump:
+		case opcode::and_node:
+		case opcode::and_node_not:
+		case opcode::or_node:
+		case opcode::or_node_not:
+			return 0;
+		default:
+			return -1;
+	}
+}
+
+size_t bytecode_program::size() const { return code_.size(); }
+
+// Returns the instruction replacing the node push followed by op, or op itself if there is none
+opcode fuse_node_push(opcode push, opcode op)
+{
+	bool negated = push == opcode::push_node_not;
+
+	switch (op)
+	{
+		case opcode::logical_not:
+			return negated ? opcode::push_node : opcode::push_node_not;
+		case opcode::logical_and:
+			return negated ? opcode::and_node_not : opcode::and_node;
+		case opcode::logical_or:
+			return negated ? opcode::or_node_not : opcode::or_node;
+		default:
+			return op;
+	}
+}
+
+void bytecode_program::emit(opcode op, uint32_t arg)
+{
+	depth_ += stack_effect(op);
+
+	// a jump to the fused push executes both of the fused instructions, but a jump right after the push must not skip op
+	if (!code_.empty() && jump_target_ != code_.size()
+		&& (code_.back().op == opcode::push_node || code_.back().op == opcode::push_node_not))
+	{
+		if (auto fused = fuse_node_push(code_.back().op, op); fused != op)
+		{
+			code_.back().op = fused;
+			return;
+		}
+	}
+
+	instruction i;
+	i.op = op;
+	i.arg = arg;
+	code_.push_back(i);
+
+	if (depth_ > max_stack_depth)
+		throw std::runtime_error("expression too deep for the bytecode interpreter");
+
+	// each program leaves the stack empty
+	if (op == opcode::ret)
+		depth_ = 0;
+}
+
+void bytecode_program::emit_const(float value)
+{
+	emit(opcode::push_const);
+	code_.back().value = value;
+}
+
+bytecode_program::jump_label bytecode_program::emit_jump(opcode op)
+{
+	emit(op);
+	return { code_.size() - 1, depth_ };
+}
+
+void bytecode_program::patch_jump(const jump_label& label)
+{
+	code_[label.at].arg = code_.size();
+	jump_target_ = code_.size();
+	depth_ = label.depth;
+}
+
+float bytecode_program::run(size_t entry, const state_word_t* __restrict__ state) const
+{
+	float stack[max_stack_depth];
+	int top = -1;
+
+	const instruction* code = code_.data();
+	size_t pc = entry;
+
+	while (true)
+	{
+		const instruction& i = code[pc++];
+
+		switch (i.op)
+		{
+			case opcode::push_const:
+				stack[++top] = i.value;
+				break;
+			case opcode::push_node:
+				stack[++top] = (state[i.arg / word_size] >> (i.arg % word_size)) & 1u;
+				break;
+			case opcode::negate:
+				stack[top] = -stack[top];
+				break;
+			case opcode::logical_not:
+				stack[top] = !stack[top];
+				break;
+			case opcode::add:
+				top--;
+				stack[top] = stack[top] + stack[top + 1];
+				break;
+			case opcode::sub:
+				top--;
+				stack[top] = stack[top] - stack[top + 1];
+				break;
+			case opcode::mul:
+				top--;
+				stack[top] = stack[top] * stack[top + 1];
+				break;
+			case opcode::div:
+				top--;
+				stack[top] = stack[top] / stack[top + 1];
+				break;
+			case opcode::logical_and:
+				top--;
+				stack[top] = stack[top] && stack[top + 1];
+				break;
+			case opcode::logical_or:
+				top--;
+				stack[top] = stack[top] || stack[top + 1];
+				break;
+			case opcode::eq:
+				top--;
+				stack[top] = stack[top] == stack[top + 1];
+				break;
+			case opcode::ne:
+				top--;
+				stack[top] = stack[top] != stack[top + 1];
+				break;
+			case opcode::le:
+				top--;
+				stack[top] = stack[top] <= stack[top + 1];
+				break;
+			case opcode::lt:
+				top--;
+				stack[top] = stack[top] < stack[top + 1];
+				break;
+			case opcode::ge:
+				top--;
+				stack[top] = stack[top] >= stack[top + 1];
+				break;
+			case opcode::gt:
+				top--;
+				stack[top] = stack[top] > stack[top + 1];
+				break;
+			case opcode::jump_if_zero:
+				if (stack[top--] == 0.f)
+					pc = i.arg;
+				break;
+			case opcode::jump:
+				pc = i.arg;
+				break;
+			case opcode::ret:
+				return stack[top];
+			case opcode::push_node_not:
+				stack[++top] = !((state[i.arg / word_size] >> (i.arg % word_size)) & 1u);
+				break;
+			case opcode::and_node:
+				stack[top] = stack[top] && ((state[i.arg / word_size] >> (i.arg % word_size)) & 1u);
+				break;
+			case opcode::and_node_not:
+				stack[top] = stack[top] && !((state[i.arg / word_size] >> (i.arg % word_size)) & 1u);
+				break;
+			case opcode::or_node:
+				stack[top] = stack[top] || ((state[i.arg / word_size] >> (i.arg % word_size)) & 1u);
+				break;
+			case opcode::or_node_not:
+				stack[top] = stack[top] || !((state[i.arg / word_size] >> (i.arg % word_size)) & 1u);
+				break;
+		}
+	}
+}
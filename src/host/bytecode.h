@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../state_word.h"
+
+enum class opcode : uint8_t
+{
+	push_const,
+	push_node,
+	negate,
+	logical_not,
+	add,
+	sub,
+	mul,
+	div,
+	logical_and,
+	logical_or,
+	eq,
+	ne,
+	le,
+	lt,
+	ge,
+	gt,
+	jump_if_zero,
+	jump,
+	ret,
+	// fused push_node followed by the operation, they spare the stack traffic of the logic formulas
+	push_node_not,
+	and_node,
+	and_node_not,
+	or_node,
+	or_node_not
+};
+
+struct instruction
+{
+	opcode op;
+	union
+	{
+		// node index for push_node, target instruction for jumps
+		uint32_t arg;
+		float value;
+	};
+};
+
+// Flat stack machine code of the node rate expressions.
+// All expressions share a single instruction array, each one is run from its entry offset up to its ret.
+class bytecode_program
+{
+	std::vector<instruction> code_;
+
+	int depth_ = 0;
+	size_t jump_target_ = 0;
+
+public:
+	static constexpr int max_stack_depth = 64;
+
+	struct jump_label
+	{
+		size_t at;
+		// stack depth at the jump target
+		int depth;
+	};
+
+	size_t size() const;
+
+	void emit(opcode op, uint32_t arg = 0);
+	void emit_const(float value);
+
+	// Emits a jump with the target set later by patch_jump
+	jump_label emit_jump(opcode op);
+	// Targets the jump to the next emitted instruction
+	void patch_jump(const jump_label& label);
+
+	float run(size_t entry, const state_word_t* __restrict__ state) const;
+};
@@ -0,0 +1,114 @@
+#include "bytecode_model.h"
+
+#include <cmath>
+
+#include "../generator.h"
+#include "../timer.h"
+#include "transition_selection.h"
+
+constexpr int word_size = sizeof(state_word_t) * 8;
+
+bytecode_model::bytecode_model(const driver& drv)
+{
+	timer_stats stats("bytecode_model> lower");
+
+	for (size_t i = 0; i < drv.nodes.size(); i++)
+	{
+		auto&& node = drv.nodes[i];
+
+		node_entries_.push_back(program_.size());
+
+		// node ? rate_down : rate_up
+		program_.emit(opcode::push_node, i);
+		auto to_up = program_.emit_jump(opcode::jump_if_zero);
+
+		node.get_attr("rate_down").second->generate_bytecode(drv, node.name, program_);
+		auto to_end = program_.emit_jump(opcode::jump);
+
+		program_.patch_jump(to_up);
+		node.get_attr("rate_up").second->generate_bytecode(drv, node.name, program_);
+
+		program_.patch_jump(to_end);
+		program_.emit(opcode::ret);
+
+		if (!node.is_internal(drv))
+			non_internals_.push_back(i);
+	}
+
+	dependents_ = build_node_dependents(drv);
+}
+
+float bytecode_model::compute_transition_rates(float* __restrict__ transition_rates,
+											   const state_word_t* __restrict__ state) const
+{
+	float sum = 0;
+
+	for (size_t i = 0; i < node_entries_.size(); i++)
+	{
+		float tmp = program_.run(node_entries_[i], state);
+		transition_rates[i] = tmp;
+		sum += tmp;
+	}
+
+	return sum;
+}
+
+double bytecode_model::update_transition_rates(float* __restrict__ transition_rates,
+											   const state_word_t* __restrict__ state, int flipped_node) const
+{
+	double delta = 0;
+
+	for (int i : dependents_[flipped_node])
+	{
+		float tmp = program_.run(node_entries_[i], state);
+		delta += (double)tmp - transition_rates[i];
+		transition_rates[i] = tmp;
+	}
+
+	return delta;
+}
+
+void bytecode_model::update_transition_rate_tree(float* __restrict__ rate_tree,
+												 const state_word_t* __restrict__ state, int flipped_node) const
+{
+	int leaves = rate_tree_leaves(node_entries_.size());
+
+	for (int i : dependents_[flipped_node])
+	{
+		rate_tree[leaves + i] = program_.run(node_entries_[i], state);
+		update_rate_tree(leaves, rate_tree, i);
+	}
+}
+
+float bytecode_model::compute_transition_entropy(const float* __restrict__ transition_rates) const
+{
+	float entropy = 0.f;
+	float non_internal_total_rate = 0.f;
+
+	for (int i : non_internals_)
+		non_internal_total_rate += transition_rates[i];
+
+	if (non_internal_total_rate == 0.f)
+		return 0.f;
+
+	for (int i : non_internals_)
+	{
+		float tmp_prob = transition_rates[i] / non_internal_total_rate;
+		entropy -= (tmp_prob == 0.f) ? 0.f : std::log2(tmp_prob) * tmp_prob;
+	}
+
+	return entropy;
+}
+
+uint64_t bytecode_model::get_non_internal_index(const state_word_t* __restrict__ state) const
+{
+	uint64_t idx = 0;
+
+	for (size_t j = 0; j < non_internals_.size(); j++)
+	{
+		int i = non_internals_[j];
+		idx |= (uint64_t)((state[i / word_size] >> (i % word_size)) & 1u) << j;
+	}
+
+	return idx;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "../parser/driver.h"
+#include "bytecode.h"
+#include "host_model.h"
+
+// Evaluates the model by interpreting the node rate expressions lowered to bytecode.
+// It needs no compilation, so the simulation starts right after the parsing.
+class bytecode_model : public host_model
+{
+	bytecode_program program_;
+
+	// entry offsets of the node rate programs
+	std::vector<size_t> node_entries_;
+	// nodes whose rate reads the node i
+	std::vector<std::vector<int>> dependents_;
+	std::vector<int> non_internals_;
+
+public:
+	bytecode_model(const driver& drv);
+
+	float compute_transition_rates(float* __restrict__ transition_rates,
+								   const state_word_t* __restrict__ state) const override;
+
+	double update_transition_rates(float* __restrict__ transition_rates, const state_word_t* __restrict__ state,
+								   int flipped_node) const override;
+
+	void update_transition_rate_tree(float* __restrict__ rate_tree, const state_word_t* __restrict__ state,
+									 int flipped_node) const override;
+
+	float compute_transition_entropy(const float* __restrict__ transition_rates) const override;
+
+	uint64_t get_non_internal_index(const state_word_t* __restrict__ state) const override;
+};
@@ -0,0 +1,194 @@
+#include "host_compiler.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "../timer.h"
+
+namespace fs = std::filesystem;
+
+// The compiler used to build the project is the default one for the generated code
+const char* host_cxx()
+{
+	if (const char* cxx = std::getenv("MABOSSG_HOST_CXX"))
+		return cxx;
+	return HOST_CXX;
+}
+
+int run_command(const std::string& command, std::string& output)
+{
+	FILE* pipe = popen((command + " 2>&1").c_str(), "r");
+	if (!pipe)
+		return -1;
+
+	char buffer[256];
+	while (std::fgets(buffer, sizeof(buffer), pipe))
+		output += buffer;
+
+	return pclose(pipe);
+}
+
+host_compiler::host_compiler(module_cache cache) : cache_(std::move(cache)) {}
+
+host_compiler::~host_compiler()
+{
+	timer_stats stats("host_compiler> free");
+
+	if (handle_)
+		dlclose(handle_);
+
+	if (!work_dir_.empty())
+	{
+		std::error_code ec;
+		fs::remove_all(work_dir_, ec);
+	}
+}
+
+// The toolchain and the host CPU (the code is built for -march=native) are a part of the cache key
+std::string toolchain_id()
+{
+	std::string id;
+	run_command(std::string("\"") + host_cxx() + "\" --version", id);
+
+	std::ifstream cpuinfo("/proc/cpuinfo");
+	for (std::string line; std::getline(cpuinfo, line);)
+	{
+		if (line.rfind("model name", 0) == 0 || line.rfind("flags", 0) == 0)
+			id += line + "\n";
+	}
+
+	return id;
+}
+
+int host_compiler::compile_simulation(const std::string& code)
+{
+	timer_stats stats("host_compiler> whole_compilation");
+
+	const std::string options = "-std=c++17 -O3 -march=native -w -shared -fPIC";
+
+	if (!cache_.enabled())
+	{
+		if (create_work_dir())
+			return 1;
+
+		auto library = (fs::path(work_dir_) / "simulation.so").string();
+
+		if (build(code, options, library))
+			return 1;
+
+		return load(library);
+	}
+
+	std::string key;
+	{
+		timer_stats stats("host_compiler> cache_key");
+
+		key = module_cache::make_key({ code, host_cxx(), options, toolchain_id() });
+	}
+
+	if (std::error_code ec; !fs::exists(cache_.path(key, ".so"), ec))
+	{
+		if (create_work_dir())
+			return 1;
+
+		// other processes may build the same module concurrently, the last one to commit wins
+		auto temp_library = cache_.temp_path(key, ".so");
+
+		if (build(code, options, temp_library))
+		{
+			fs::remove(temp_library, ec);
+			return 1;
+		}
+
+		if (!cache_.commit(temp_library, key, ".so"))
+		{
+			std::cerr << "host_compiler> cannot store the module in the cache" << std::endl;
+			return 1;
+		}
+	}
+
+	return load(cache_.path(key, ".so"));
+}
+
+int host_compiler::create_work_dir()
+{
+	std::string dir_template = (fs::temp_directory_path() / "mabossg-XXXXXX").string();
+	if (!mkdtemp(dir_template.data()))
+	{
+		std::cerr << "host_compiler> cannot create a temporary directory" << std::endl;
+		return 1;
+	}
+	work_dir_ = dir_template;
+
+	return 0;
+}
+
+int host_compiler::build(const std::string& code, const std::string& options, const std::string& library)
+{
+	auto source = (fs::path(work_dir_) / "simulation.cpp").string();
+
+	{
+		timer_stats stats("host_compiler> write_source");
+
+		std::ofstream ofs(source);
+		ofs << code;
+	}
+
+	{
+		timer_stats stats("host_compiler> compile");
+
+		std::string command =
+			std::string("\"") + host_cxx() + "\" " + options + " -o \"" + library + "\" \"" + source + "\"";
+
+		std::string log;
+		int result = run_command(command, log);
+
+		if (!log.empty())
+			std::cerr << log << std::endl;
+
+		if (result != 0)
+		{
+			std::cerr << "host_compiler> compilation failed: " << command << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int host_compiler::load(const std::string& library)
+{
+	timer_stats stats("host_compiler> load");
+
+	handle_ = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (!handle_)
+	{
+		std::cerr << "host_compiler> " << dlerror() << std::endl;
+		return 1;
+	}
+
+	std::vector<std::pair<const char*, void**>> function_names = {
+		{ "compute_transition_rates", reinterpret_cast<void**>(&functions.compute_transition_rates_) },
+		{ "update_transition_rates", reinterpret_cast<void**>(&functions.update_transition_rates_) },
+		{ "update_transition_rate_tree", reinterpret_cast<void**>(&functions.update_transition_rate_tree_) },
+		{ "compute_transition_entropy", reinterpret_cast<void**>(&functions.compute_transition_entropy_) },
+		{ "get_non_internal_index", reinterpret_cast<void**>(&functions.get_non_internal_index_) }
+	};
+
+	for (auto&& [name, function] : function_names)
+	{
+		*function = dlsym(handle_, name);
+		if (!*function)
+		{
+			std::cerr << "host_compiler> " << dlerror() << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "../module_cache.h"
+#include "host_functions.h"
+
+// Builds the generated simulation code with the system C++ compiler into a shared object and loads it.
+// The shared objects are kept in the module cache, so an unchanged model is not compiled again.
+class host_compiler
+{
+	void* handle_ = nullptr;
+	std::string work_dir_;
+	module_cache cache_;
+
+	int create_work_dir();
+	int build(const std::string& code, const std::string& options, const std::string& library);
+	int load(const std::string& library);
+
+public:
+	host_functions functions;
+
+	host_compiler() = default;
+	explicit host_compiler(module_cache cache);
+	~host_compiler();
+
+	host_compiler(const host_compiler&) = delete;
+	host_compiler& operator=(const host_compiler&) = delete;
+
+	int compile_simulation(const std::string& code);
+};
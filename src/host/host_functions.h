@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../state_word.h"
+#include "host_model.h"
+
+// Signatures of the entry points of a simulation module compiled for the host
+using compute_transition_rates_t = float (*)(float* __restrict__ transition_rates,
+											 const state_word_t* __restrict__ state,
+											 const float* __restrict__ parameters);
+using update_transition_rates_t = double (*)(float* __restrict__ transition_rates,
+											const state_word_t* __restrict__ state, int flipped_node,
+											const float* __restrict__ parameters);
+using update_transition_rate_tree_t = void (*)(float* __restrict__ rate_tree, const state_word_t* __restrict__ state,
+											   int flipped_node, const float* __restrict__ parameters);
+using compute_transition_entropy_t = float (*)(const float* __restrict__ transition_rates);
+using get_non_internal_index_t = uint64_t (*)(const state_word_t* __restrict__ state);
+
+// Entry points loaded from a simulation module by host_compiler
+class host_functions : public host_model
+{
+	// values of the model variables when the module was generated with runtime variables
+	const float* parameters_ = nullptr;
+
+	compute_transition_rates_t compute_transition_rates_ = nullptr;
+	update_transition_rates_t update_transition_rates_ = nullptr;
+	update_transition_rate_tree_t update_transition_rate_tree_ = nullptr;
+	compute_transition_entropy_t compute_transition_entropy_ = nullptr;
+	get_non_internal_index_t get_non_internal_index_ = nullptr;
+
+	friend class host_compiler;
+
+public:
+	// The same entry points evaluated with the given variable values, which have to outlive the returned model
+	host_functions with_parameters(const float* parameters) const
+	{
+		host_functions functions = *this;
+		functions.parameters_ = parameters;
+		return functions;
+	}
+
+	float compute_transition_rates(float* __restrict__ transition_rates,
+								   const state_word_t* __restrict__ state) const override
+	{
+		return compute_transition_rates_(transition_rates, state, parameters_);
+	}
+
+	double update_transition_rates(float* __restrict__ transition_rates, const state_word_t* __restrict__ state,
+								   int flipped_node) const override
+	{
+		return update_transition_rates_(transition_rates, state, flipped_node, parameters_);
+	}
+
+	void update_transition_rate_tree(float* __restrict__ rate_tree, const state_word_t* __restrict__ state,
+									 int flipped_node) const override
+	{
+		update_transition_rate_tree_(rate_tree, state, flipped_node, parameters_);
+	}
+
+	float compute_transition_entropy(const float* __restrict__ transition_rates) const override
+	{
+		return compute_transition_entropy_(transition_rates);
+	}
+
+	uint64_t get_non_internal_index(const state_word_t* __restrict__ state) const override
+	{
+		return get_non_internal_index_(state);
+	}
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../state_word.h"
+
+// Model functions the host simulation and statistics are evaluated with.
+// They are provided either by a compiled simulation module or by the bytecode interpreter.
+class host_model
+{
+public:
+	virtual ~host_model() = default;
+
+	// Fills transition_rates with the flip rate of each node and returns their sum
+	virtual float compute_transition_rates(float* __restrict__ transition_rates,
+										   const state_word_t* __restrict__ state) const = 0;
+
+	// Recomputes the rates of the nodes reading flipped_node after it flipped in state, returns the change of their sum
+	virtual double update_transition_rates(float* __restrict__ transition_rates, const state_word_t* __restrict__ state,
+										   int flipped_node) const = 0;
+
+	// Same as update_transition_rates for the rates kept in the leaves of a rate tree, see transition_selection.h
+	virtual void update_transition_rate_tree(float* __restrict__ rate_tree, const state_word_t* __restrict__ state,
+											 int flipped_node) const = 0;
+
+	virtual float compute_transition_entropy(const float* __restrict__ transition_rates) const = 0;
+
+	// Index of the state restricted to the non-internal nodes
+	virtual uint64_t get_non_internal_index(const state_word_t* __restrict__ state) const = 0;
+};
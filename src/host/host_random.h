@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+// Random stream of a single host trajectory.
+// It is a xoroshiro128+ generator seeded from the simulation seed and the trajectory id, so the stream of a
+// trajectory does not depend on the thread or the batch slot which simulates it.
+struct host_random
+{
+	uint64_t s0, s1;
+
+	host_random() = default;
+
+	host_random(unsigned long long seed, unsigned long long trajectory_id)
+	{
+		// the id is hashed first, a plain multiple of the splitmix64 increment would make the states of neighbouring
+		// ids overlap, the s1 of one trajectory being the s0 of the next one
+		uint64_t id = trajectory_id;
+		uint64_t x = seed ^ splitmix64(id);
+		s0 = splitmix64(x);
+		s1 = splitmix64(x);
+	}
+
+	uint64_t next()
+	{
+		const uint64_t a = s0;
+		uint64_t b = s1;
+		const uint64_t result = a + b;
+
+		b ^= a;
+		s0 = rotl(a, 24) ^ b ^ (b << 16);
+		s1 = rotl(b, 37);
+
+		return result;
+	}
+
+	// Uniformly distributed float in (0, 1], the same range as curand_uniform
+	float uniform() { return ((next() >> 40) + 1) * (1.f / 16777216.f); }
+
+private:
+	static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+	static uint64_t splitmix64(uint64_t& x)
+	{
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+};
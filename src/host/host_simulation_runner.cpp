@@ -0,0 +1,871 @@
+#include "host_simulation_runner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "../binary_stream.h"
+#include "../timer.h"
+#include "../utils.h"
+#include "host_random.h"
+#include "transition_selection.h"
+
+constexpr int word_size = sizeof(state_word_t) * 8;
+
+// the simulated slots are split into this many chunks per worker to be balanced by work stealing
+constexpr int chunks_per_worker = 16;
+
+// the running sum of the transition rates drifts from the rates by the rounding of the updates, once it falls under
+// this fraction of its maximum it is summed again from the rates so that a fixed point gives exactly zero
+constexpr double rate_sum_resync = 1e-5;
+
+void initialize_initial_state(int state_size, const float* __restrict__ initial_probs, state_word_t* __restrict__ state,
+							  float& time, host_random& rand)
+{
+	int state_words = (state_size + word_size - 1) / word_size;
+
+	std::fill(state, state + state_words, 0);
+
+	// randomly set free vars
+	for (int i = 0; i < state_size; i++)
+	{
+		if (rand.uniform() <= initial_probs[i])
+			state[i / word_size] |= 1u << (i % word_size);
+	}
+
+	time = 0.f;
+}
+
+// Records the steps of simulate_trajectory into the trajectory buffers of a batch slot
+struct buffer_recorder
+{
+	int state_words;
+	int trajectory_limit;
+	state_word_t* __restrict__ trajectory_states;
+	float* __restrict__ trajectory_times;
+	float* __restrict__ trajectory_transition_entropies;
+
+	// as the first time set the last from the prev run
+	void begin(float time) { trajectory_times[0] = time; }
+
+	void add_step(int step, const state_word_t* state, float, float time, float transition_entropy)
+	{
+		std::copy(state, state + state_words, trajectory_states + step * state_words);
+		trajectory_times[step] = time;
+		trajectory_transition_entropies[step] = transition_entropy;
+	}
+
+	// zeroed times mark the unused part of the trajectory buffer
+	void end(int steps) { std::fill(trajectory_times + steps, trajectory_times + trajectory_limit, 0.f); }
+};
+
+// Passes the steps of simulate_trajectory to the accumulators of the fused stats, nothing is buffered
+struct fused_recorder
+{
+	const std::vector<step_accumulator*>& accumulators;
+	int traj;
+	int worker;
+
+	void begin(float) {}
+
+	void add_step(int, const state_word_t* state, float begin_time, float end_time, float transition_entropy)
+	{
+		for (auto accumulator : accumulators)
+			accumulator->add_step(traj, worker, state, begin_time, end_time, transition_entropy);
+	}
+
+	void end(int) {}
+};
+
+// Host version of simulate_inner from jit_kernels/simulation.cu, it advances a single trajectory by at most
+// trajectory_limit - 1 steps and passes them to the recorder. With a rate_tree of 2 * rate_tree_leaves(state_size)
+// floats the transition rates are kept in its leaves.
+template <typename recorder_t>
+trajectory_status simulate_trajectory(const host_model& model, int state_size, int trajectory_limit,
+									  float time_tick, float max_time, bool discrete_time,
+									  state_word_t* __restrict__ last_state, float& last_time, host_random& rand,
+									  recorder_t& recorder, float* __restrict__ transition_rates,
+									  float* __restrict__ rate_tree, state_word_t* __restrict__ state)
+{
+	int state_words = (state_size + word_size - 1) / word_size;
+	int leaves = rate_tree_leaves(state_size);
+
+	if (rate_tree)
+		transition_rates = rate_tree + leaves;
+
+	std::copy(last_state, last_state + state_words, state);
+	float time = last_time;
+	int step = 0;
+	trajectory_status status = trajectory_status::CONTINUE;
+
+	recorder.begin(time);
+	step++;
+
+	// get transition rates for the initial state, after a flip only the rates reading the flipped node are updated
+	double total_rate_sum = model.compute_transition_rates(transition_rates, state);
+	if (rate_tree)
+		total_rate_sum = build_rate_tree(state_size, leaves, rate_tree);
+	double max_rate_sum = total_rate_sum;
+
+	while (true)
+	{
+		float total_rate = total_rate_sum;
+
+		float transition_entropy = 0.f;
+		float prev_time = time;
+
+		// if total rate is zero, no transition is possible
+		if (total_rate == 0.f)
+		{
+			status = trajectory_status::FIXED_POINT;
+			time = max_time;
+		}
+		else
+		{
+			if (discrete_time)
+			{
+				time += time_tick;
+				// due to a common rounding error for discrete simulations,
+				// we set time to max_time explicitely if it is close enough to max_time
+				time = max_time - time_tick < time ? max_time : time;
+			}
+			else
+				time += -std::log(rand.uniform()) / total_rate;
+
+			time = std::min(time, max_time);
+
+			// if total rate is nonzero, we compute the transition entropy
+			transition_entropy = model.compute_transition_entropy(transition_rates);
+		}
+
+		recorder.add_step(step, state, prev_time, time, transition_entropy);
+		step++;
+
+		if (time >= max_time || step >= trajectory_limit)
+			break;
+
+		int flip_bit = rate_tree ? select_flip_bit_tree(leaves, rate_tree, rand)
+								 : select_flip_bit(state_size, transition_rates, total_rate, rand);
+		state[flip_bit / word_size] ^= 1u << (flip_bit % word_size);
+
+		if (rate_tree)
+		{
+			model.update_transition_rate_tree(rate_tree, state, flip_bit);
+			total_rate_sum = rate_tree[1];
+		}
+		else
+		{
+			total_rate_sum += model.update_transition_rates(transition_rates, state, flip_bit);
+			max_rate_sum = std::max(max_rate_sum, total_rate_sum);
+
+			if (total_rate_sum <= max_rate_sum * rate_sum_resync)
+				total_rate_sum = std::accumulate(transition_rates, transition_rates + state_size, 0.);
+		}
+	}
+
+	recorder.end(step);
+
+	// save trajectory variables
+	std::copy(state, state + state_words, last_state);
+	last_time = time;
+
+	if (status != trajectory_status::FIXED_POINT)
+	{
+		status = (time >= max_time) ? trajectory_status::FINISHED : trajectory_status::CONTINUE;
+	}
+
+	return status;
+}
+
+// Scratch buffers of simulate_block
+struct bitsliced_block
+{
+	std::vector<uint64_t> nodes;
+	std::vector<float> rates, total_rates;
+	std::vector<state_word_t> states;
+	std::vector<float> times, flip_thresholds;
+	std::vector<int> steps, flip_bits;
+	std::vector<char> active;
+
+	bitsliced_block(int state_size, int state_words)
+		: nodes((size_t)state_size * bitsliced_model::lane_words),
+		  rates((size_t)state_size * bitsliced_model::lanes),
+		  total_rates(bitsliced_model::lanes),
+		  states((size_t)state_words * bitsliced_model::lanes),
+		  times(bitsliced_model::lanes),
+		  flip_thresholds(bitsliced_model::lanes),
+		  steps(bitsliced_model::lanes),
+		  flip_bits(bitsliced_model::lanes),
+		  active(bitsliced_model::lanes)
+	{}
+};
+
+// Bit-sliced version of simulate_trajectory, it advances count <= bitsliced_model::lanes trajectories in lockstep.
+// Each lane draws its random numbers in the same order as simulate_trajectory, so the trajectories are the same.
+void simulate_block(const bitsliced_model& model, int count, int state_size, int trajectory_limit, float time_tick,
+					float max_time, bool discrete_time, state_word_t* __restrict__ last_states,
+					float* __restrict__ last_times, host_random* __restrict__ rands,
+					state_word_t* __restrict__ trajectory_states, float* __restrict__ trajectory_times,
+					float* __restrict__ trajectory_transition_entropies,
+					trajectory_status* __restrict__ trajectory_statuses, bitsliced_block& block)
+{
+	constexpr int lanes = bitsliced_model::lanes;
+	constexpr int lane_words = bitsliced_model::lane_words;
+
+	int state_words = (state_size + word_size - 1) / word_size;
+	int active_count = count;
+
+	// transpose the states into the node words
+	std::fill(block.nodes.begin(), block.nodes.end(), 0);
+
+	for (int lane = 0; lane < lanes; lane++)
+	{
+		block.active[lane] = lane < count;
+
+		if (lane >= count)
+			continue;
+
+		state_word_t* state = block.states.data() + lane * state_words;
+		std::copy(last_states + lane * state_words, last_states + (lane + 1) * state_words, state);
+
+		for (int i = 0; i < state_size; i++)
+			if (state[i / word_size] & (1u << (i % word_size)))
+				block.nodes[i * lane_words + lane / 64] |= 1ull << (lane % 64);
+
+		block.times[lane] = last_times[lane];
+		block.steps[lane] = 0;
+		trajectory_statuses[lane] = trajectory_status::CONTINUE;
+
+		// as the first time set the last from the prev run
+		trajectory_times[lane * trajectory_limit + block.steps[lane]++] = block.times[lane];
+	}
+
+	while (active_count)
+	{
+		// get transition rates for current states
+		model.compute_transition_rates(block.nodes.data(), block.rates.data(), block.total_rates.data());
+
+		for (int lane = 0; lane < count; lane++)
+		{
+			if (!block.active[lane])
+				continue;
+
+			float total_rate = block.total_rates[lane];
+			float time = block.times[lane];
+			float transition_entropy = 0.f;
+
+			// if total rate is zero, no transition is possible
+			if (total_rate == 0.f)
+			{
+				trajectory_statuses[lane] = trajectory_status::FIXED_POINT;
+				time = max_time;
+			}
+			else
+			{
+				if (discrete_time)
+				{
+					time += time_tick;
+					time = max_time - time_tick < time ? max_time : time;
+				}
+				else
+					time += -std::log(rands[lane].uniform()) / total_rate;
+
+				time = std::min(time, max_time);
+
+				transition_entropy = model.compute_transition_entropy(block.rates.data(), lane);
+			}
+
+			int step = block.steps[lane]++;
+			size_t id = (size_t)lane * trajectory_limit + step;
+
+			std::copy(block.states.data() + lane * state_words, block.states.data() + (lane + 1) * state_words,
+					  trajectory_states + id * state_words);
+			trajectory_times[id] = time;
+			trajectory_transition_entropies[id] = transition_entropy;
+			block.times[lane] = time;
+
+			if (time >= max_time || step + 1 >= trajectory_limit)
+			{
+				block.active[lane] = false;
+				active_count--;
+				continue;
+			}
+
+			block.flip_thresholds[lane] = rands[lane].uniform() * total_rate;
+		}
+
+		if (!active_count)
+			break;
+
+		// select the flip bits of all the lanes at once, inactive lanes select garbage
+		std::fill(block.flip_bits.begin(), block.flip_bits.end(), 0);
+		std::fill(block.total_rates.begin(), block.total_rates.end(), 0.f);
+
+		for (int i = 0; i < state_size; i++)
+		{
+			const float* __restrict__ node_rates = block.rates.data() + i * lanes;
+
+			for (int lane = 0; lane < lanes; lane++)
+			{
+				block.total_rates[lane] += node_rates[lane];
+				block.flip_bits[lane] += (block.total_rates[lane] < block.flip_thresholds[lane]) ? 1 : 0;
+			}
+		}
+
+		for (int lane = 0; lane < count; lane++)
+		{
+			if (!block.active[lane])
+				continue;
+
+			int flip_bit = block.flip_bits[lane];
+			block.nodes[flip_bit * lane_words + lane / 64] ^= 1ull << (lane % 64);
+			block.states[lane * state_words + flip_bit / word_size] ^= 1u << (flip_bit % word_size);
+		}
+	}
+
+	for (int lane = 0; lane < count; lane++)
+	{
+		// zeroed times mark the unused part of the trajectory buffer
+		std::fill(trajectory_times + lane * trajectory_limit + block.steps[lane],
+				  trajectory_times + (lane + 1) * trajectory_limit, 0.f);
+
+		// save trajectory variables
+		std::copy(block.states.data() + lane * state_words, block.states.data() + (lane + 1) * state_words,
+				  last_states + lane * state_words);
+		last_times[lane] = block.times[lane];
+
+		if (trajectory_statuses[lane] != trajectory_status::FIXED_POINT)
+		{
+			trajectory_statuses[lane] =
+				(block.times[lane] >= max_time) ? trajectory_status::FINISHED : trajectory_status::CONTINUE;
+		}
+	}
+}
+
+host_simulation_runner::host_simulation_runner(int n_trajectories, int state_size, unsigned long long seed,
+											   std::vector<float> inital_probs, float max_time, float time_tick,
+											   bool discrete_time, thread_pool& pool, bool rate_tree,
+											   unsigned long long first_trajectory)
+	: n_trajectories_(n_trajectories),
+	  state_size_(state_size),
+	  state_words_(DIV_UP(state_size, word_size)),
+	  seed_(seed),
+	  first_trajectory_(first_trajectory),
+	  inital_probs_(std::move(inital_probs)),
+	  max_time_(max_time),
+	  time_tick_(time_tick),
+	  discrete_time_(discrete_time),
+	  rate_tree_(rate_tree),
+	  pool_(pool)
+{
+	trajectory_batch_limit = std::min(max_batch_slots_, n_trajectories);
+	trajectory_len_limit = 100;
+}
+
+void host_simulation_runner::fit_memory_budget(size_t memory_budget, const host_model& model,
+											   const float* initial_probs, size_t stats_bytes, size_t stats_slot_bytes)
+{
+	timer_stats stats("host_simulation_runner> fit_memory_budget");
+
+	constexpr int warm_up_trajectories = 256;
+	constexpr int warm_up_len = 1024;
+
+	// the histograms of the stats are allocated up front, the rest of the budget goes to the batches
+	if (stats_bytes >= memory_budget)
+		throw std::runtime_error("the memory budget of " + std::to_string(memory_budget)
+								 + " bytes cannot hold the statistics histograms of " + std::to_string(stats_bytes)
+								 + " bytes");
+	memory_budget -= stats_bytes;
+
+	// an empty run has no trajectories to size the buffers from
+	if (n_trajectories_ == 0)
+		return;
+
+	if (!initial_probs)
+		initial_probs = inital_probs_.data();
+
+	// the warm-up draws from its own random streams, so the simulated trajectories are not affected
+	int warm_up_count = std::min(warm_up_trajectories, n_trajectories_);
+	std::vector<long long> steps(warm_up_count);
+
+	// the warm-up trajectories are the most uneven, they are stolen in small chunks
+	pool_.parallel_for_stealing(warm_up_count, 4, [&](int begin, int end, int) {
+		std::vector<state_word_t> last_state(state_words_), traj_states((size_t)warm_up_len * state_words_),
+			state(state_words_);
+		std::vector<float> traj_times(warm_up_len), traj_tr_entropies(warm_up_len), transition_rates(state_size_);
+		std::vector<float> rate_tree(rate_tree_ ? 2 * rate_tree_leaves(state_size_) : 0);
+
+		for (int i = begin; i < end; i++)
+		{
+			host_random rand(~seed_, i);
+			float last_time;
+			initialize_initial_state(state_size_, initial_probs, last_state.data(), last_time, rand);
+
+			buffer_recorder recorder { state_words_, warm_up_len, traj_states.data(), traj_times.data(),
+									   traj_tr_entropies.data() };
+
+			trajectory_status status;
+			do
+			{
+				status = simulate_trajectory(model, state_size_, warm_up_len, time_tick_, max_time_, discrete_time_,
+											 last_state.data(), last_time, rand, recorder, transition_rates.data(),
+											 rate_tree_ ? rate_tree.data() : nullptr, state.data());
+
+				// the first step holds only the time where the trajectory continues from
+				steps[i] += std::count_if(traj_times.begin() + 1, traj_times.end(), [](float t) { return t != 0.f; });
+			} while (status == trajectory_status::CONTINUE);
+		}
+	});
+
+	size_t slot_bytes = state_words_ * sizeof(state_word_t) + sizeof(float) + sizeof(host_random) + sizeof(int)
+						+ sizeof(trajectory_status) + stats_slot_bytes;
+	size_t step_bytes = state_words_ * sizeof(state_word_t) + 2 * sizeof(float);
+
+	// a pipelined run keeps a second set of the buffers and of the last states for the stats
+	if (stats_pool_)
+	{
+		slot_bytes += state_words_ * sizeof(state_word_t) + sizeof(trajectory_status);
+		step_bytes *= 2;
+	}
+
+	// the workers need enough slots to share, the longer trajectories continue in the next batches
+	size_t min_slots = std::min(n_trajectories_, std::max(4096, 256 * pool_.size()));
+	size_t max_len = memory_budget / min_slots > slot_bytes ? (memory_budget / min_slots - slot_bytes) / step_bytes : 0;
+
+	// 90% of the warm-up trajectories fit into one batch
+	std::sort(steps.begin(), steps.end());
+	long long typical_steps = steps[steps.size() * 9 / 10];
+
+	// a budget too small for min_slots gets the shortest buffers and fewer slots
+	trajectory_len_limit = std::clamp<long long>(typical_steps + 1, 2, std::clamp<size_t>(max_len, 2, 1 << 20));
+	max_batch_slots_ = std::clamp<size_t>(memory_budget / (slot_bytes + trajectory_len_limit * step_bytes), 1,
+										  std::numeric_limits<int>::max() / trajectory_len_limit);
+	trajectory_batch_limit = std::min(max_batch_slots_, n_trajectories_);
+}
+
+void host_simulation_runner::run_simulation(stats_composite& stats_runner, const host_model& model)
+{
+	run_variants({ &stats_runner }, { &model }, { inital_probs_ });
+}
+
+void host_simulation_runner::run_variants(const std::vector<stats_composite*>& stats_runners,
+										  const std::vector<const host_model*>& models,
+										  const std::vector<std::vector<float>>& initial_probs)
+{
+	std::vector<const float*> variant_initial_probs;
+	for (auto&& probs : initial_probs)
+		variant_initial_probs.push_back(probs.data());
+
+	if (fused_stats_ && stats_pool_)
+		throw std::runtime_error("the fused stats cannot be pipelined");
+
+	// the fused stats take the steps right from simulate_trajectory
+	std::vector<std::vector<step_accumulator*>> accumulators;
+	if (fused_stats_)
+		for (auto&& stats_runner : stats_runners)
+			accumulators.push_back(stats_runner->fuse());
+
+	run(stats_runners, accumulators, variant_initial_probs, 1, [&](int begin, int end, int worker) {
+		std::vector<float> transition_rates(state_size_);
+		std::vector<float> rate_tree(rate_tree_ ? 2 * rate_tree_leaves(state_size_) : 0);
+		std::vector<state_word_t> state(state_words_);
+
+		auto simulate = [&](int i, auto& recorder) {
+			return simulate_trajectory(*models[traj_variants_[i]], state_size_, trajectory_len_limit, time_tick_,
+									   max_time_, discrete_time_, last_states_.data() + i * state_words_,
+									   last_times_[i], rands_[i], recorder, transition_rates.data(),
+									   rate_tree_ ? rate_tree.data() : nullptr, state.data());
+		};
+
+		for (int i = begin; i < end; i++)
+		{
+			if (fused_stats_)
+			{
+				const auto& variant_accumulators = accumulators[traj_variants_[i]];
+				fused_recorder recorder { variant_accumulators, i - variant_begins_[traj_variants_[i]], worker };
+
+				traj_statuses_[i] = simulate(i, recorder);
+
+				for (auto accumulator : variant_accumulators)
+					accumulator->end_trajectory(recorder.traj, worker, traj_statuses_[i]);
+			}
+			else
+			{
+				size_t traj_offset = (size_t)i * trajectory_len_limit;
+				buffer_recorder recorder { state_words_, trajectory_len_limit,
+										   traj_states_.data() + traj_offset * state_words_,
+										   traj_times_.data() + traj_offset, traj_tr_entropies_.data() + traj_offset };
+
+				traj_statuses_[i] = simulate(i, recorder);
+			}
+		}
+	});
+}
+
+void host_simulation_runner::run_simulation(stats_composite& stats_runner, const bitsliced_model& model)
+{
+	if (fused_stats_)
+		throw std::runtime_error("the bitsliced simulation does not support fused stats");
+
+	run({ &stats_runner }, {}, { inital_probs_.data() }, bitsliced_model::lanes, [&](int begin, int end, int) {
+		bitsliced_block block(state_size_, state_words_);
+
+		for (int i = begin; i < end; i += bitsliced_model::lanes)
+		{
+			size_t traj_offset = (size_t)i * trajectory_len_limit;
+
+			simulate_block(model, std::min(end - i, bitsliced_model::lanes), state_size_, trajectory_len_limit,
+						   time_tick_, max_time_, discrete_time_, last_states_.data() + i * state_words_,
+						   last_times_.data() + i, rands_.data() + i, traj_states_.data() + traj_offset * state_words_,
+						   traj_times_.data() + traj_offset, traj_tr_entropies_.data() + traj_offset,
+						   traj_statuses_.data() + i, block);
+		}
+	});
+}
+
+void host_simulation_runner::run(const std::vector<stats_composite*>& stats_runners,
+								 const std::vector<std::vector<step_accumulator*>>& accumulators,
+								 const std::vector<const float*>& initial_probs, int block_size,
+								 const std::function<void(int, int, int)>& simulate)
+{
+	int variants_count = stats_runners.size();
+	batch_progress progress;
+	progress.remaining_trajs = (long long)n_trajectories_ * variants_count;
+	progress.trajs_to_start = progress.remaining_trajs;
+	progress.next_trajectory_id = 0;
+
+	// the variants share the batch slots
+	trajectory_batch_limit = std::min<long long>(max_batch_slots_, progress.remaining_trajs);
+
+	// smaller batches let a converged run stop sooner, each worker still gets a block of slots
+	bool adaptive = tolerance_ > 0.f && variants_count == 1;
+	if (adaptive)
+		trajectory_batch_limit = std::min(trajectory_batch_limit, std::max(4096, block_size * pool_.size()));
+	progress.next_convergence_check = trajectory_batch_limit;
+
+	{
+		timer_stats stats("host_simulation_runner> allocate");
+
+		last_states_.resize((size_t)trajectory_batch_limit * state_words_);
+		last_times_.resize(trajectory_batch_limit);
+		rands_.resize(trajectory_batch_limit);
+		traj_variants_.resize(trajectory_batch_limit);
+		variant_begins_.resize(variants_count + 1);
+
+		// the fused stats need no trajectory buffers
+		size_t buffered_len = fused_stats_ ? 0 : trajectory_len_limit;
+		traj_states_.resize((size_t)trajectory_batch_limit * buffered_len * state_words_);
+		traj_times_.resize((size_t)trajectory_batch_limit * buffered_len);
+		traj_tr_entropies_.resize((size_t)trajectory_batch_limit * buffered_len);
+		traj_statuses_.resize(trajectory_batch_limit);
+
+		if (stats_pool_)
+		{
+			stats_traj_states_.resize(traj_states_.size());
+			stats_traj_times_.resize(traj_times_.size());
+			stats_traj_tr_entropies_.resize(traj_tr_entropies_.size());
+			stats_last_states_.resize(last_states_.size());
+			stats_traj_statuses_.resize(traj_statuses_.size());
+		}
+	}
+
+	// computes the statistics over the simulated trajs, each variant processes its range of slots
+	auto process_stats = [&](state_word_t* traj_states, float* traj_times, float* traj_tr_entropies,
+							 state_word_t* last_states, trajectory_status* traj_statuses,
+							 const std::vector<int>& variant_begins) {
+		timer_stats stats("host_simulation_runner> stats");
+
+		for (int variant = 0; variant < variants_count; variant++)
+		{
+			int begin = variant_begins[variant];
+			int end = variant_begins[variant + 1];
+			if (begin == end)
+				continue;
+
+			// the fused stats get the batches without the buffers
+			size_t traj_offset = fused_stats_ ? 0 : (size_t)begin * trajectory_len_limit;
+			stats_runners[variant]->process_batch({ traj_states + traj_offset * state_words_, traj_times + traj_offset,
+													traj_tr_entropies + traj_offset,
+													last_states + (size_t)begin * state_words_, traj_statuses + begin,
+													end - begin });
+		}
+	};
+
+	// the stats of the previous batch of a pipelined run, the simulation waits for them only when they are slower
+	std::future<void> stats_stage;
+	auto wait_for_stats = [&] {
+		if (!stats_stage.valid())
+			return;
+
+		timer_stats stats("host_simulation_runner> wait_for_stats");
+
+		stats_stage.get();
+	};
+
+	// starts new trajectories in the batch slots [begin, end)
+	auto initialize = [&](int begin, int end) {
+		pool_.parallel_for(end - begin, [&](int b, int e, int) {
+			for (int i = begin + b; i < begin + e; i++)
+			{
+				unsigned long long trajectory_id = progress.next_trajectory_id + (i - begin);
+				int variant = trajectory_id / n_trajectories_;
+				auto stream = first_trajectory_ + trajectory_id - (unsigned long long)variant * n_trajectories_;
+
+				traj_variants_[i] = variant;
+				rands_[i] = host_random(seed_, stream);
+				initialize_initial_state(state_size_, initial_probs[variant], last_states_.data() + i * state_words_,
+										 last_times_[i], rands_[i]);
+			}
+		});
+
+		progress.next_trajectory_id += end - begin;
+	};
+
+	auto resume_state = checkpoints_ ? checkpoints_->take_resume_state() : std::nullopt;
+
+	if (resume_state)
+	{
+		timer_stats stats("host_simulation_runner> resume");
+
+		load_checkpoint(*resume_state, progress, stats_runners);
+	}
+	else
+	{
+		timer_stats stats("host_simulation_runner> initialize");
+
+		progress.trajectories_in_batch = std::min<long long>(progress.trajs_to_start, trajectory_batch_limit);
+		progress.trajs_to_start -= progress.trajectories_in_batch;
+
+		initialize(0, progress.trajectories_in_batch);
+	}
+
+	while (progress.trajectories_in_batch)
+	{
+		// each variant occupies its contiguous range of slots [variant_begins_[v], variant_begins_[v + 1])
+		for (int v = 0, i = 0; v <= variants_count; v++)
+		{
+			while (i < progress.trajectories_in_batch && traj_variants_[i] < v)
+				i++;
+			variant_begins_[v] = i;
+		}
+
+		for (size_t v = 0; v < accumulators.size(); v++)
+			for (auto accumulator : accumulators[v])
+				accumulator->begin_batch(variant_begins_[v + 1] - variant_begins_[v]);
+
+		{
+			timer_stats stats("host_simulation_runner> simulate");
+
+			int blocks = DIV_UP(progress.trajectories_in_batch, block_size);
+			auto simulate_blocks = [&](int begin, int end, int worker) {
+				simulate(begin * block_size, std::min(end * block_size, progress.trajectories_in_batch), worker);
+			};
+
+			// the trajectories take uneven time, the workers done with their share steal the chunks of the others.
+			// The fused stats sum the steps per worker, they keep the static split so that their sums are reproducible.
+			if (fused_stats_)
+				pool_.parallel_for(blocks, simulate_blocks);
+			else
+				pool_.parallel_for_stealing(blocks, std::max(1, blocks / (pool_.size() * chunks_per_worker)),
+											simulate_blocks);
+		}
+
+		if (stats_pool_)
+		{
+			// the stats take over the buffers of this batch and the next one is simulated into those of the previous
+			wait_for_stats();
+
+			std::swap(traj_states_, stats_traj_states_);
+			std::swap(traj_times_, stats_traj_times_);
+			std::swap(traj_tr_entropies_, stats_traj_tr_entropies_);
+			int slots = progress.trajectories_in_batch;
+			std::copy(last_states_.begin(), last_states_.begin() + (size_t)slots * state_words_,
+					  stats_last_states_.begin());
+			std::copy(traj_statuses_.begin(), traj_statuses_.begin() + slots, stats_traj_statuses_.begin());
+			stats_variant_begins_ = variant_begins_;
+
+			stats_stage = std::async(std::launch::async, [&] {
+				process_stats(stats_traj_states_.data(), stats_traj_times_.data(), stats_traj_tr_entropies_.data(),
+							  stats_last_states_.data(), stats_traj_statuses_.data(), stats_variant_begins_);
+			});
+		}
+		else
+			process_stats(traj_states_.data(), traj_times_.data(), traj_tr_entropies_.data(), last_states_.data(),
+						  traj_statuses_.data(), variant_begins_);
+
+		// prepare for the next iteration
+		{
+			timer_stats stats("host_simulation_runner> prepare_next_iter");
+
+			// move unfinished trajs to the front and update trajectories_in_batch
+			{
+				int remaining_trajectories_in_batch = 0;
+				for (int i = 0; i < progress.trajectories_in_batch; i++)
+				{
+					if (traj_statuses_[i] != trajectory_status::CONTINUE)
+						continue;
+
+					int j = remaining_trajectories_in_batch++;
+					if (i != j)
+					{
+						auto last_state = last_states_.begin() + i * state_words_;
+						std::copy(last_state, last_state + state_words_, last_states_.begin() + j * state_words_);
+						last_times_[j] = last_times_[i];
+						rands_[j] = rands_[i];
+						traj_variants_[j] = traj_variants_[i];
+					}
+				}
+
+				progress.remaining_trajs -= progress.trajectories_in_batch - remaining_trajectories_in_batch;
+				progress.trajectories_in_batch = remaining_trajectories_in_batch;
+			}
+
+			// add new work to the batch
+			{
+				int batch_free_size = trajectory_batch_limit - progress.trajectories_in_batch;
+				int new_batch_addition = std::min<long long>(batch_free_size, progress.trajs_to_start);
+
+				if (new_batch_addition)
+				{
+					initialize(progress.trajectories_in_batch, progress.trajectories_in_batch + new_batch_addition);
+
+					progress.trajectories_in_batch += new_batch_addition;
+					progress.trajs_to_start -= new_batch_addition;
+				}
+			}
+		}
+
+		// the started trajectories are kept until they finish, so the results have no bias towards the short ones
+		long long finished_trajs = progress.next_trajectory_id - progress.trajectories_in_batch;
+		if (adaptive && progress.trajs_to_start && finished_trajs >= progress.next_convergence_check)
+		{
+			wait_for_stats();
+
+			timer_stats stats("host_simulation_runner> convergence");
+
+			if (stats_runners.front()->max_error(finished_trajs) <= tolerance_)
+			{
+				progress.remaining_trajs -= progress.trajs_to_start;
+				progress.trajs_to_start = 0;
+			}
+			else
+				progress.next_convergence_check = finished_trajs + finished_trajs / 4;
+		}
+
+		// the slots are serialized right away, the disk is written in the background
+		if (checkpoints_ && progress.trajectories_in_batch && checkpoints_->due())
+		{
+			wait_for_stats();
+
+			timer_stats stats("host_simulation_runner> checkpoint");
+
+			checkpoints_->save(save_checkpoint(progress, stats_runners));
+		}
+
+		timer_stats::counter("host_simulation_runner> remaining trajs", progress.remaining_trajs);
+	}
+
+	wait_for_stats();
+
+	simulated_trajectories_ = progress.next_trajectory_id / variants_count;
+
+	if (adaptive)
+	{
+		timer_stats stats("host_simulation_runner> convergence");
+
+		achieved_error_ = stats_runners.front()->max_error(simulated_trajectories_);
+	}
+}
+
+void host_simulation_runner::fuse_stats() { fused_stats_ = true; }
+
+void host_simulation_runner::pipeline_stats(thread_pool& stats_pool) { stats_pool_ = &stats_pool; }
+
+void host_simulation_runner::enable_checkpoints(checkpointer& checkpoints) { checkpoints_ = &checkpoints; }
+
+void host_simulation_runner::stop_at_tolerance(float tolerance) { tolerance_ = tolerance; }
+
+int host_simulation_runner::simulated_trajectories() const { return simulated_trajectories_; }
+
+float host_simulation_runner::achieved_error() const { return achieved_error_; }
+
+std::string host_simulation_runner::save_checkpoint(const batch_progress& progress,
+													const std::vector<stats_composite*>& stats_runners) const
+{
+	binary_writer w;
+
+	// the run the checkpoint belongs to
+	w.put<int32_t>(n_trajectories_);
+	w.put<int32_t>(stats_runners.size());
+	w.put<int32_t>(state_words_);
+	w.put<uint64_t>(seed_);
+	w.put<uint64_t>(first_trajectory_);
+	w.put<int32_t>(trajectory_batch_limit);
+	w.put<int32_t>(pool_.size());
+	w.put(tolerance_);
+
+	w.put(progress.remaining_trajs);
+	w.put(progress.trajs_to_start);
+	w.put(progress.next_trajectory_id);
+	w.put(progress.trajectories_in_batch);
+	w.put(progress.next_convergence_check);
+
+	int slots = progress.trajectories_in_batch;
+	w.put_array(last_states_.data(), (size_t)slots * state_words_);
+	w.put_array(last_times_.data(), slots);
+	w.put_array(rands_.data(), slots);
+	w.put_array(traj_variants_.data(), slots);
+
+	for (auto&& stats_runner : stats_runners)
+		stats_runner->save(w);
+
+	return w.take();
+}
+
+void host_simulation_runner::load_checkpoint(const std::string& state, batch_progress& progress,
+											 const std::vector<stats_composite*>& stats_runners)
+{
+	binary_reader r(state, "checkpoint");
+
+	bool same_run = r.get<int32_t>() == n_trajectories_;
+	same_run &= r.get<int32_t>() == (int)stats_runners.size();
+	same_run &= r.get<int32_t>() == state_words_;
+	same_run &= r.get<uint64_t>() == seed_;
+	same_run &= r.get<uint64_t>() == first_trajectory_;
+	same_run &= r.get<int32_t>() == trajectory_batch_limit;
+	same_run &= r.get<int32_t>() == pool_.size();
+	same_run &= r.get<float>() == tolerance_;
+
+	if (!same_run)
+		r.fail("written by another run");
+
+	progress.remaining_trajs = r.get<long long>();
+	progress.trajs_to_start = r.get<long long>();
+	progress.next_trajectory_id = r.get<unsigned long long>();
+	progress.trajectories_in_batch = r.get<int>();
+	progress.next_convergence_check = r.get<long long>();
+
+	int slots = progress.trajectories_in_batch;
+	if (slots < 0 || slots > trajectory_batch_limit)
+		r.fail("invalid batch");
+
+	r.get_array(last_states_.data(), (size_t)slots * state_words_);
+	r.get_array(last_times_.data(), slots);
+	r.get_array(rands_.data(), slots);
+	r.get_array(traj_variants_.data(), slots);
+
+	// the slots of each variant are found by the order of the variants
+	for (int i = 0; i < slots; i++)
+		if (traj_variants_[i] < 0 || traj_variants_[i] >= (int)stats_runners.size()
+			|| (i && traj_variants_[i] < traj_variants_[i - 1]))
+			r.fail("invalid trajectory variants");
+
+	for (auto&& stats_runner : stats_runners)
+		stats_runner->load(r);
+
+	if (!r.at_end())
+		r.fail("trailing data");
+}
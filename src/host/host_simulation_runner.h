@@ -0,0 +1,144 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "../checkpoint.h"
+#include "../statistics/stats_composite.h"
+#include "bitsliced_model.h"
+#include "host_model.h"
+#include "host_random.h"
+#include "thread_pool.h"
+
+// Host counterpart of simulation_runner, it simulates batches of trajectories on the threads of a thread_pool
+class host_simulation_runner
+{
+	int n_trajectories_;
+	int state_size_;
+	int state_words_;
+	unsigned long long seed_;
+	// id of the first simulated trajectory, shards of a run simulate disjoint ranges of the random streams
+	unsigned long long first_trajectory_;
+	std::vector<float> inital_probs_;
+
+	float max_time_;
+	float time_tick_;
+	bool discrete_time_;
+
+	// selects the flips by a rate tree instead of a linear scan
+	bool rate_tree_;
+
+	thread_pool& pool_;
+
+	std::vector<state_word_t> last_states_;
+	std::vector<float> last_times_;
+	std::vector<host_random> rands_;
+	// variant of the trajectory in the batch slot, the slots are kept in the ascending order of the variants
+	std::vector<int> traj_variants_;
+	// first batch slot of each variant and the end of the slots
+	std::vector<int> variant_begins_;
+
+	std::vector<state_word_t> traj_states_;
+	std::vector<float> traj_times_;
+	std::vector<float> traj_tr_entropies_;
+	std::vector<trajectory_status> traj_statuses_;
+
+	// the stats of a pipelined run reduce the previous batch from these while the next one is simulated
+	thread_pool* stats_pool_ = nullptr;
+	std::vector<state_word_t> stats_traj_states_;
+	std::vector<float> stats_traj_times_;
+	std::vector<float> stats_traj_tr_entropies_;
+	std::vector<state_word_t> stats_last_states_;
+	std::vector<trajectory_status> stats_traj_statuses_;
+	std::vector<int> stats_variant_begins_;
+
+	checkpointer* checkpoints_ = nullptr;
+
+	// the steps are passed right to the stats instead of through the trajectory buffers
+	bool fused_stats_ = false;
+
+	// most trajectories in the batch slots, fit_memory_budget sizes it to the trajectory buffers
+	int max_batch_slots_ = 1 << 16;
+
+	// a positive tolerance stops starting new trajectories once the max_error of the stats falls under it
+	float tolerance_ = 0.f;
+	int simulated_trajectories_ = 0;
+	float achieved_error_ = 0.f;
+
+	// Progress of run over the batches, a checkpoint stores it together with the occupied batch slots
+	struct batch_progress
+	{
+		long long remaining_trajs;
+		long long trajs_to_start;
+		unsigned long long next_trajectory_id;
+		int trajectories_in_batch;
+		// finished trajectories count at which the convergence is checked next
+		long long next_convergence_check;
+	};
+
+	// Runs the batch loop over n_trajectories of each variant, simulate advances the trajectories in the batch slots
+	// [begin, end) on the worker. The slots are split among the workers in multiples of block_size. The accumulators
+	// of the fused stats of each variant, if any, begin every batch before it is simulated.
+	void run(const std::vector<stats_composite*>& stats_runners,
+			 const std::vector<std::vector<step_accumulator*>>& accumulators,
+			 const std::vector<const float*>& initial_probs, int block_size,
+			 const std::function<void(int, int, int)>& simulate);
+
+	std::string save_checkpoint(const batch_progress& progress,
+								const std::vector<stats_composite*>& stats_runners) const;
+
+	// Restores the batch slots and the stats, throws std::runtime_error if the state belongs to another run
+	void load_checkpoint(const std::string& state, batch_progress& progress,
+						 const std::vector<stats_composite*>& stats_runners);
+
+public:
+	int trajectory_len_limit;
+	int trajectory_batch_limit;
+
+	// Simulates the trajectories [first_trajectory, first_trajectory + n_trajectories) of the seed
+	host_simulation_runner(int n_trajectories, int state_size, unsigned long long seed, std::vector<float> inital_probs,
+						   float max_time, float time_tick, bool discrete_time, thread_pool& pool,
+						   bool rate_tree = false, unsigned long long first_trajectory = 0);
+
+	void run_simulation(stats_composite& stats_runner, const host_model& model);
+
+	// Simulates n_trajectories of every variant in shared batches. The trajectories of the variant v evolve by
+	// models[v] from initial_probs[v] and are processed by stats_runners[v]. The trajectory i of every variant draws
+	// from the same random stream as the trajectory i of run_simulation.
+	void run_variants(const std::vector<stats_composite*>& stats_runners, const std::vector<const host_model*>& models,
+					  const std::vector<std::vector<float>>& initial_probs);
+
+	// Simulates the trajectories in blocks of bitsliced_model::lanes
+	void run_simulation(stats_composite& stats_runner, const bitsliced_model& model);
+
+	// Reduces the stats of every batch on the threads of stats_pool while the next batch is simulated, the trajectory
+	// buffers are doubled for it. The stats must be created on stats_pool and the run waits for them only before the
+	// convergence checks, the checkpoints and at its end. It must be called before fit_memory_budget, the fused stats
+	// do not support it.
+	void pipeline_stats(thread_pool& stats_pool);
+
+	// Sizes trajectory_len_limit and the batch slots so that the trajectory buffers and the stats take at most
+	// memory_budget bytes. The stats allocate stats_bytes up front and stats_slot_bytes for each batch slot, see
+	// host_stats_bytes, and a budget which cannot hold them throws std::runtime_error. The length fits the steps of
+	// most trajectories of a warm-up simulated by model from initial_probs, or from the initial probabilities of the
+	// runner when null, and the rest of the budget goes to the batch slots. It must be called before the stats are
+	// created from trajectory_len_limit.
+	void fit_memory_budget(size_t memory_budget, const host_model& model, const float* initial_probs = nullptr,
+						   size_t stats_bytes = 0, size_t stats_slot_bytes = 0);
+
+	// Passes the simulated steps right to the stats, which accumulate them on the fly instead of reading them from the
+	// trajectory buffers afterwards, so the buffers are not allocated. The stats must support it (see stats::fuse),
+	// the bitsliced simulation does not.
+	void fuse_stats();
+
+	// Checkpoints the runs periodically, a checkpoint loaded into checkpoints is resumed by the next run
+	void enable_checkpoints(checkpointer& checkpoints);
+
+	// Ends the runs of a single variant early once the largest 95% confidence half-width of their probabilities falls
+	// under tolerance, the trajectories already started are finished. n_trajectories becomes the maximum.
+	void stop_at_tolerance(float tolerance);
+
+	// Trajectories per variant simulated by the last run and the max_error of its stats with a tolerance
+	int simulated_trajectories() const;
+	float achieved_error() const;
+};
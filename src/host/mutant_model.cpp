@@ -0,0 +1,73 @@
+#include "mutant_model.h"
+
+#include "transition_selection.h"
+
+constexpr int word_size = sizeof(state_word_t) * 8;
+
+mutant_model::mutant_model(const host_model& base, const std::vector<std::vector<int>>& dependents,
+						   std::vector<float> rate_scales)
+	: base_(base), dependents_(dependents), rate_scales_(std::move(rate_scales))
+{}
+
+float mutant_model::scale(const state_word_t* __restrict__ state, int node) const
+{
+	return rate_scales_[2 * node + ((state[node / word_size] >> (node % word_size)) & 1u)];
+}
+
+float mutant_model::compute_transition_rates(float* __restrict__ transition_rates,
+											 const state_word_t* __restrict__ state) const
+{
+	base_.compute_transition_rates(transition_rates, state);
+
+	float sum = 0.f;
+	for (int i = 0; i < (int)dependents_.size(); i++)
+	{
+		transition_rates[i] *= scale(state, i);
+		sum += transition_rates[i];
+	}
+
+	return sum;
+}
+
+double mutant_model::update_transition_rates(float* __restrict__ transition_rates,
+											 const state_word_t* __restrict__ state, int flipped_node) const
+{
+	const auto& dependents = dependents_[flipped_node];
+
+	double old_sum = 0.0;
+	for (int node : dependents)
+		old_sum += transition_rates[node];
+
+	// the base model rewrites exactly the rates of the dependents
+	base_.update_transition_rates(transition_rates, state, flipped_node);
+
+	double new_sum = 0.0;
+	for (int node : dependents)
+	{
+		transition_rates[node] *= scale(state, node);
+		new_sum += transition_rates[node];
+	}
+
+	return new_sum - old_sum;
+}
+
+void mutant_model::update_transition_rate_tree(float* __restrict__ rate_tree, const state_word_t* __restrict__ state,
+											   int flipped_node) const
+{
+	int leaves = rate_tree_leaves(dependents_.size());
+
+	update_transition_rates(rate_tree + leaves, state, flipped_node);
+
+	for (int node : dependents_[flipped_node])
+		update_rate_tree(leaves, rate_tree, node);
+}
+
+float mutant_model::compute_transition_entropy(const float* __restrict__ transition_rates) const
+{
+	return base_.compute_transition_entropy(transition_rates);
+}
+
+uint64_t mutant_model::get_non_internal_index(const state_word_t* __restrict__ state) const
+{
+	return base_.get_non_internal_index(state);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "host_model.h"
+
+// Applies the rate overrides of a mutant variant on top of the rates of a model, so all the variants of a batch are
+// simulated by one compiled module. The initial state overrides are applied by the runner.
+class mutant_model : public host_model
+{
+	const host_model& base_;
+
+	// nodes whose rate reads the node i, as built by build_node_dependents
+	const std::vector<std::vector<int>>& dependents_;
+	// multipliers of the up and down rates of the nodes, see mutant_variant
+	std::vector<float> rate_scales_;
+
+	float scale(const state_word_t* __restrict__ state, int node) const;
+
+public:
+	mutant_model(const host_model& base, const std::vector<std::vector<int>>& dependents,
+				 std::vector<float> rate_scales);
+
+	float compute_transition_rates(float* __restrict__ transition_rates,
+								   const state_word_t* __restrict__ state) const override;
+
+	double update_transition_rates(float* __restrict__ transition_rates, const state_word_t* __restrict__ state,
+								   int flipped_node) const override;
+
+	void update_transition_rate_tree(float* __restrict__ rate_tree, const state_word_t* __restrict__ state,
+									 int flipped_node) const override;
+
+	float compute_transition_entropy(const float* __restrict__ transition_rates) const override;
+
+	uint64_t get_non_internal_index(const state_word_t* __restrict__ state) const override;
+};
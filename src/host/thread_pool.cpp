@@ -0,0 +1,145 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace {
+
+// Deque of the chunks [head, tail) of a worker packed into one word, so the owner taking the head and the thieves
+// taking the tail agree by a compare-and-swap. The chunks are only taken, never pushed, which keeps it this simple.
+struct alignas(64) chunk_deque
+{
+	std::atomic<uint64_t> bounds { 0 };
+
+	void assign(uint32_t head, uint32_t tail) { bounds.store((uint64_t)head << 32 | tail, std::memory_order_relaxed); }
+
+	bool take(bool front, int& chunk)
+	{
+		uint64_t current = bounds.load(std::memory_order_relaxed);
+		while (true)
+		{
+			uint32_t head = current >> 32;
+			uint32_t tail = (uint32_t)current;
+			if (head >= tail)
+				return false;
+
+			uint64_t next = front ? (uint64_t)(head + 1) << 32 | tail : (uint64_t)head << 32 | (tail - 1);
+			if (bounds.compare_exchange_weak(current, next, std::memory_order_relaxed))
+			{
+				chunk = front ? head : tail - 1;
+				return true;
+			}
+		}
+	}
+};
+
+} // namespace
+
+thread_pool::thread_pool(int threads_count)
+{
+	for (int i = 1; i < std::max(threads_count, 1); i++)
+		workers_.emplace_back(&thread_pool::worker_loop, this, i);
+}
+
+thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	task_cv_.notify_all();
+
+	for (auto&& worker : workers_)
+		worker.join();
+}
+
+int thread_pool::size() const { return workers_.size() + 1; }
+
+void thread_pool::worker_loop(int worker_id)
+{
+	size_t seen_generation = 0;
+
+	while (true)
+	{
+		const std::function<void(int)>* task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			task_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+
+			if (stop_)
+				return;
+
+			seen_generation = generation_;
+			task = task_;
+		}
+
+		(*task)(worker_id);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (--running_ == 0)
+				done_cv_.notify_one();
+		}
+	}
+}
+
+void thread_pool::run(const std::function<void(int)>& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		task_ = &task;
+		running_ = workers_.size();
+		generation_++;
+	}
+	task_cv_.notify_all();
+
+	task(0);
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	done_cv_.wait(lock, [&] { return running_ == 0; });
+}
+
+void thread_pool::parallel_for(int n, const std::function<void(int, int, int)>& fn)
+{
+	const int workers = size();
+	const int chunk = (n + workers - 1) / workers;
+
+	run([&](int worker_id) {
+		int begin = std::min(n, worker_id * chunk);
+		int end = std::min(n, begin + chunk);
+
+		if (begin < end)
+			fn(begin, end, worker_id);
+	});
+}
+
+void thread_pool::parallel_for_stealing(int n, int chunk_size, const std::function<void(int, int, int)>& fn)
+{
+	const int workers = size();
+	const int chunks = (n + chunk_size - 1) / chunk_size;
+	const int share = (chunks + workers - 1) / workers;
+
+	std::unique_ptr<chunk_deque[]> deques(new chunk_deque[workers]);
+	for (int i = 0; i < workers; i++)
+		deques[i].assign(std::min(chunks, i * share), std::min(chunks, (i + 1) * share));
+
+	run([&](int worker_id) {
+		auto run_chunk = [&](int chunk) { fn(chunk * chunk_size, std::min(n, (chunk + 1) * chunk_size), worker_id); };
+
+		int chunk;
+		while (deques[worker_id].take(true, chunk))
+			run_chunk(chunk);
+
+		// no chunks are added, so a victim found empty stays empty
+		for (int i = 1; i < workers; i++)
+		{
+			auto& victim = deques[(worker_id + i) % workers];
+			while (victim.take(false, chunk))
+				run_chunk(chunk);
+		}
+	});
+}
+
+int thread_pool::default_threads_count() { return std::max(1u, std::thread::hardware_concurrency()); }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads executing the host simulation.
+// The calling thread takes part in every task as the worker 0.
+class thread_pool
+{
+	std::vector<std::thread> workers_;
+
+	std::mutex mutex_;
+	std::condition_variable task_cv_, done_cv_;
+	const std::function<void(int)>* task_ = nullptr;
+	size_t generation_ = 0;
+	int running_ = 0;
+	bool stop_ = false;
+
+	void worker_loop(int worker_id);
+
+public:
+	explicit thread_pool(int threads_count);
+	~thread_pool();
+
+	int size() const;
+
+	// Runs task(worker_id) once on every worker and waits for all of them
+	void run(const std::function<void(int)>& task);
+
+	// Splits [0, n) into contiguous chunks, one per worker, and runs fn(begin, end, worker_id) on them
+	void parallel_for(int n, const std::function<void(int, int, int)>& fn);
+
+	// Splits [0, n) into chunks of chunk_size and runs fn(begin, end, worker_id) on them by work stealing. Each worker
+	// has a deque of the chunks of its contiguous share, it takes them from the front and once it runs out it steals
+	// from the backs of the others, so the workers stay busy until the last chunk when the chunks take uneven time.
+	void parallel_for_stealing(int n, int chunk_size, const std::function<void(int, int, int)>& fn);
+
+	static int default_threads_count();
+};
@@ -0,0 +1,66 @@
+#include "transition_selection.h"
+
+#include <algorithm>
+
+int select_flip_bit(int state_size, const float* __restrict__ transition_rates, float total_rate, host_random& rand)
+{
+	float r = rand.uniform() * total_rate;
+	float sum = 0;
+	int idx = 0;
+	int last_nonzero = 0;
+	for (int i = 0; i < state_size; i++)
+	{
+		sum += transition_rates[i];
+		idx += (sum < r) ? 1 : 0;
+		last_nonzero = (transition_rates[i] != 0.f) ? i : last_nonzero;
+	}
+	// the incrementally updated total rate may round above the sum of the rates
+	return std::min(idx, last_nonzero);
+}
+
+int rate_tree_leaves(int state_size)
+{
+	int leaves = 1;
+	while (leaves < state_size)
+		leaves *= 2;
+	return leaves;
+}
+
+float build_rate_tree(int state_size, int leaves, float* __restrict__ tree)
+{
+	std::fill(tree + leaves + state_size, tree + 2 * leaves, 0.f);
+
+	for (int p = leaves - 1; p >= 1; p--)
+		tree[p] = tree[2 * p] + tree[2 * p + 1];
+
+	return tree[1];
+}
+
+void update_rate_tree(int leaves, float* __restrict__ tree, int node)
+{
+	for (int p = (leaves + node) / 2; p >= 1; p /= 2)
+		tree[p] = tree[2 * p] + tree[2 * p + 1];
+}
+
+int select_flip_bit_tree(int leaves, const float* __restrict__ tree, host_random& rand)
+{
+	float r = rand.uniform() * tree[1];
+	int p = 1;
+
+	while (p < leaves)
+	{
+		float left = tree[2 * p];
+		float right = tree[2 * p + 1];
+
+		// the same choice as the linear scan, except that a subtree with zero rate is never entered
+		if (left != 0.f && (r <= left || right == 0.f))
+			p = 2 * p;
+		else
+		{
+			r -= left;
+			p = 2 * p + 1;
+		}
+	}
+
+	return p - leaves;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "host_random.h"
+
+// Selects the node to flip with a probability proportional to its rate by a linear scan over the rates
+int select_flip_bit(int state_size, const float* __restrict__ transition_rates, float total_rate, host_random& rand);
+
+// A rate tree is a complete binary tree of partial sums of the transition rates. The rate of the node i is stored in
+// the leaf tree[leaves + i], the inner node p holds tree[2p] + tree[2p + 1] and the root tree[1] is the total rate.
+// Updating a rate and selecting a flip then take O(log state_size) instead of O(state_size).
+
+// Number of leaves of the rate tree of a state, the tree occupies 2 * leaves floats
+int rate_tree_leaves(int state_size);
+
+// Zeroes the unused leaves and sums the inner nodes from the leaves, returns the total rate
+float build_rate_tree(int state_size, int leaves, float* __restrict__ tree);
+
+// Recomputes the sums on the path from the leaf of the node to the root
+void update_rate_tree(int leaves, float* __restrict__ tree, int node);
+
+// Same as select_flip_bit but it descends the rate tree
+int select_flip_bit_tree(int leaves, const float* __restrict__ tree, host_random& rand);
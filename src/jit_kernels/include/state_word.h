@@ -0,0 +1,5 @@
+R"====(
+#pragma once
+
+using state_word_t = uint32_t;
+)===="
\ No newline at end of file
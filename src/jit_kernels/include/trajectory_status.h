@@ -0,0 +1,10 @@
+R"====(
+#pragma once
+
+enum class trajectory_status : uint8_t
+{
+	CONTINUE,
+	FINISHED,
+	FIXED_POINT
+};
+)===="
\ No newline at end of file
@@ -12,23 +12,69 @@ __device__ int select_flip_bit(int state_size, const float* __restrict__ transit
 	float r = curand_uniform(rand) * total_rate;
 	float sum = 0;
 	int idx = 0;
+	int last_nonzero = 0;
 	for (int i = 0; i < state_size; i++)
 	{
 		sum += transition_rates[i];
 		idx += (sum < r) ? 1 : 0;
+		last_nonzero = (transition_rates[i] != 0.f) ? i : last_nonzero;
 	}
-	return idx;
+	// the incrementally updated total rate may round above the sum of the rates
+	return min(idx, last_nonzero);
+}
+
+// Device version of the rate tree from host/transition_selection.h
+__device__ int rate_tree_leaves(int state_size)
+{
+	int leaves = 1;
+	while (leaves < state_size)
+		leaves *= 2;
+	return leaves;
+}
+
+__device__ float build_rate_tree(int state_size, int leaves, float* __restrict__ tree)
+{
+	for (int i = leaves + state_size; i < 2 * leaves; i++)
+		tree[i] = 0.f;
+
+	for (int p = leaves - 1; p >= 1; p--)
+		tree[p] = tree[2 * p] + tree[2 * p + 1];
+
+	return tree[1];
+}
+
+__device__ int select_flip_bit_tree(int leaves, const float* __restrict__ tree, curandState* __restrict__ rand)
+{
+	float r = curand_uniform(rand) * tree[1];
+	int p = 1;
+
+	while (p < leaves)
+	{
+		float left = tree[2 * p];
+		float right = tree[2 * p + 1];
+
+		// the same choice as the linear scan, except that a subtree with zero rate is never entered
+		if (left != 0.f && (r <= left || right == 0.f))
+			p = 2 * p;
+		else
+		{
+			r -= left;
+			p = 2 * p + 1;
+		}
+	}
+
+	return p - leaves;
 }
 
 extern "C" __global__ void initialize_random(int trajectories_count, unsigned long long seed,
-											 curandState* __restrict__ rands)
+											 unsigned long long first_trajectory, curandState* __restrict__ rands)
 {
 	auto id = blockIdx.x * blockDim.x + threadIdx.x;
 	if (id >= trajectories_count)
 		return;
 
-	// initialize random number generator
-	curand_init(seed, id, 0, rands + id);
+	// initialize random number generator, the shards of a run take disjoint subsequences
+	curand_init(seed, first_trajectory + id, 0, rands + id);
 }
 
 extern "C" __global__ void initialize_initial_state(int trajectories_count, int state_size,
@@ -72,6 +118,10 @@ extern "C" __global__ void initialize_initial_state(int trajectories_count, int
 
 extern __device__ float compute_transition_rates(float* __restrict__ transition_rates,
 												 const state_word_t* __restrict__ state);
+extern __device__ double update_transition_rates(float* __restrict__ transition_rates,
+												  const state_word_t* __restrict__ state, int flipped_node);
+extern __device__ void update_transition_rate_tree(float* __restrict__ rate_tree,
+												   const state_word_t* __restrict__ state, int flipped_node);
 extern __device__ float compute_transition_entropy(const float* __restrict__ transition_rates);
 
 __device__ void simulate_inner(int trajectories_count, int state_size, int trajectory_limit, float time_tick,
@@ -80,7 +130,8 @@ __device__ void simulate_inner(int trajectories_count, int state_size, int traje
 							   state_word_t* __restrict__ trajectory_states, float* __restrict__ trajectory_times,
 							   float* __restrict__ trajectory_transition_entropies,
 							   trajectory_status* __restrict__ trajectory_statuses,
-							   float* __restrict__ transition_rates, state_word_t* __restrict__ state)
+							   float* __restrict__ transition_rates, float* __restrict__ rate_tree,
+							   state_word_t* __restrict__ state)
 {
 	curandState* __restrict__ rands = reinterpret_cast<curandState*>(rands_v);
 	auto id = blockIdx.x * blockDim.x + threadIdx.x;
@@ -89,6 +140,7 @@ __device__ void simulate_inner(int trajectories_count, int state_size, int traje
 
 	constexpr int word_size = sizeof(state_word_t) * 8;
 	int state_words = (state_size + word_size - 1) / word_size;
+	int leaves = rate_tree_leaves(state_size);
 
 	for (int i = 0; i < state_words; i++)
 		state[i] = last_states[id * state_words + i];
@@ -103,10 +155,16 @@ __device__ void simulate_inner(int trajectories_count, int state_size, int traje
 	// as the first time set the last from the prev run
 	trajectory_times[step++] = time;
 
+	// get transition rates for the initial state, after a flip only the rates reading the flipped node are updated
+	// with a rate tree, transition_rates points to its leaves
+	double total_rate_sum = compute_transition_rates(transition_rates, state);
+	if (rate_tree)
+		total_rate_sum = build_rate_tree(state_size, leaves, rate_tree);
+	double max_rate_sum = total_rate_sum;
+
 	while (true)
 	{
-		// get transition rates for current state
-		float total_rate = compute_transition_rates(transition_rates, state);
+		float total_rate = total_rate_sum;
 
 		float transition_entropy = 0.f;
 
@@ -143,8 +201,29 @@ __device__ void simulate_inner(int trajectories_count, int state_size, int traje
 		if (time >= max_time || step >= trajectory_limit)
 			break;
 
-		int flip_bit = select_flip_bit(state_size, transition_rates, total_rate, &rand);
+		int flip_bit = rate_tree ? select_flip_bit_tree(leaves, rate_tree, &rand)
+								 : select_flip_bit(state_size, transition_rates, total_rate, &rand);
 		state[flip_bit / word_size] ^= 1 << (flip_bit % word_size);
+
+		if (rate_tree)
+		{
+			update_transition_rate_tree(rate_tree, state, flip_bit);
+			total_rate_sum = rate_tree[1];
+		}
+		else
+		{
+			total_rate_sum += update_transition_rates(transition_rates, state, flip_bit);
+			max_rate_sum = fmax(max_rate_sum, total_rate_sum);
+
+			// the running sum drifts by the rounding of the updates, close to zero it is summed again from the rates
+			// so that a fixed point gives exactly zero
+			if (total_rate_sum <= max_rate_sum * 1e-5)
+			{
+				total_rate_sum = 0.;
+				for (int i = 0; i < state_size; i++)
+					total_rate_sum += transition_rates[i];
+			}
+		}
 	}
 
 	// save thread variables
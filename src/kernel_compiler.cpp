@@ -1,5 +1,6 @@
 #include "kernel_compiler.h"
 
+#include <iterator>
 #include <memory>
 #include <nvJitLink.h>
 #include <vector>
@@ -58,10 +59,78 @@ kernel_compiler::~kernel_compiler()
 	CU_CHECK(cuCtxDestroy(cuContext_));
 }
 
+const char* compile_options[] = { "-dlto", "--relocatable-device-code=true" };
+const char* link_options[] = { "-dlto", "-arch=sm_" CUDA_CC };
+
+// The toolchain versions and the options are a part of the cache key
+std::string toolchain_id()
+{
+	int major, minor;
+	NVRTC_CHECK(nvrtcVersion(&major, &minor));
+
+	std::string id = std::to_string(CUDA_VERSION) + " nvrtc " + std::to_string(major) + "." + std::to_string(minor);
+
+	for (auto option : compile_options)
+		id += std::string(" ") + option;
+	for (auto option : link_options)
+		id += std::string(" ") + option;
+
+	return id;
+}
+
 int kernel_compiler::compile_simulation(const std::string& code, bool discrete_time)
 {
 	timer_stats stats("compiler> whole_compilation");
 
+	std::vector<std::pair<const char*, CUfunction*>> kernel_names = {
+		{ "initialize_random", &initialize_random.kernel },
+		{ "initialize_initial_state", &initialize_initial_state.kernel },
+		{ "simulate", &simulate.kernel },
+		{ discrete_time ? "window_average_small_discrete" : "window_average_small", &window_average_small.kernel },
+		{ "final_states", &final_states.kernel }
+	};
+
+	std::string key;
+	{
+		timer_stats stats("compiler> cache_key");
+
+		// the offline compiled kernels are linked into the module as well
+		key = module_cache::make_key(
+			{ code, toolchain_id(),
+			  std::string_view((const char*)simulation_fatbin, sizeof(simulation_fatbin)),
+			  std::string_view((const char*)final_states_fatbin, sizeof(final_states_fatbin)),
+			  std::string_view((const char*)window_average_small_fatbin, sizeof(window_average_small_fatbin)) });
+	}
+
+	std::string cubin;
+	if (!cache_.load(key, ".cubin", cubin))
+	{
+		if (compile_cubin(code, cubin))
+			return 1;
+
+		cache_.store(key, ".cubin", cubin);
+	}
+
+	{
+		timer_stats stats("compiler> module_load");
+
+		CU_CHECK(cuModuleLoadData(&cuModule_, cubin.data()));
+	}
+
+	{
+		timer_stats stats("compiler> module_get_function");
+
+		for (auto&& [name, kernel] : kernel_names)
+		{
+			CU_CHECK(cuModuleGetFunction(kernel, cuModule_, name));
+		}
+	}
+
+	return 0;
+}
+
+int kernel_compiler::compile_cubin(const std::string& code, std::string& cubin)
+{
 	// Create an instance of nvrtcProgram with the code string.
 	nvrtcProgram prog;
 	{
@@ -75,19 +144,11 @@ int kernel_compiler::compile_simulation(const std::string& code, bool discrete_t
 									   NULL));			// includeNames
 	}
 
-	std::vector<std::pair<const char*, CUfunction*>> kernel_names = {
-		{ "initialize_random", &initialize_random.kernel },
-		{ "initialize_initial_state", &initialize_initial_state.kernel },
-		{ "simulate", &simulate.kernel },
-		{ discrete_time ? "window_average_small_discrete" : "window_average_small", &window_average_small.kernel },
-		{ "final_states", &final_states.kernel }
-	};
-
 	nvrtcResult compileResult;
 	{
 		timer_stats stats("compiler> nvrtc_compile_program");
 
-		std::vector<const char*> opts = { "-dlto", "--relocatable-device-code=true" };
+		std::vector<const char*> opts(std::begin(compile_options), std::end(compile_options));
 		compileResult = nvrtcCompileProgram(prog,		  // prog
 											opts.size(),  // numOptions
 											opts.data()); // options
@@ -127,8 +188,7 @@ int kernel_compiler::compile_simulation(const std::string& code, bool discrete_t
 		timer_stats stats("compiler> link");
 
 		nvJitLinkHandle handle;
-		const char* lopts[] = { "-dlto", "-arch=sm_" CUDA_CC };
-		NVJITLINK_CHECK(handle, nvJitLinkCreate(&handle, 2, lopts));
+		NVJITLINK_CHECK(handle, nvJitLinkCreate(&handle, std::size(link_options), link_options));
 
 		// The fatbinary contains LTO IR generated offline using nvcc
 		NVJITLINK_CHECK(handle, nvJitLinkAddData(handle, NVJITLINK_INPUT_FATBIN, (void*)simulation_fatbin,
@@ -144,20 +204,9 @@ int kernel_compiler::compile_simulation(const std::string& code, bool discrete_t
 		NVJITLINK_CHECK(handle, nvJitLinkComplete(handle));
 		size_t cubinSize;
 		NVJITLINK_CHECK(handle, nvJitLinkGetLinkedCubinSize(handle, &cubinSize));
-		std::unique_ptr<char[]> cubin = std::make_unique<char[]>(cubinSize);
-		NVJITLINK_CHECK(handle, nvJitLinkGetLinkedCubin(handle, cubin.get()));
+		cubin.resize(cubinSize);
+		NVJITLINK_CHECK(handle, nvJitLinkGetLinkedCubin(handle, cubin.data()));
 		NVJITLINK_CHECK(handle, nvJitLinkDestroy(&handle));
-
-		CU_CHECK(cuModuleLoadData(&cuModule_, cubin.get()));
-	}
-
-	{
-		timer_stats stats("compiler> module_get_function");
-
-		for (auto&& [name, kernel] : kernel_names)
-		{
-			CU_CHECK(cuModuleGetFunction(kernel, cuModule_, name));
-		}
 	}
 
 	return 0;
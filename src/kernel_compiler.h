@@ -3,6 +3,7 @@
 #include <string>
 
 #include "kernel.h"
+#include "module_cache.h"
 
 class kernel_compiler
 {
@@ -10,6 +11,11 @@ class kernel_compiler
 	CUdevice cuDevice_;
 	CUcontext cuContext_;
 
+	// linked cubins are cached, so an unchanged model skips both nvrtc and nvJitLink
+	module_cache cache_;
+
+	int compile_cubin(const std::string& code, std::string& cubin);
+
 public:
 	kernel_wrapper initialize_random, initialize_initial_state, simulate, window_average_small, final_states;
 
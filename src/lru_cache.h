@@ -0,0 +1,57 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// Keeps the values used most recently, up to capacity (at least 1) of them
+template <typename value_t>
+class lru_cache
+{
+	using entry_t = std::pair<std::string, std::unique_ptr<value_t>>;
+
+	size_t capacity_;
+
+	// the most recently used entry first
+	std::list<entry_t> entries_;
+	std::unordered_map<std::string, typename std::list<entry_t>::iterator> index_;
+
+public:
+	explicit lru_cache(size_t capacity) : capacity_(capacity) {}
+
+	// Returns the value of key and marks it as the most recently used, nullptr if it is not cached
+	value_t* find(const std::string& key)
+	{
+		auto it = index_.find(key);
+		if (it == index_.end())
+			return nullptr;
+
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return it->second->second.get();
+	}
+
+	// Stores the value as the most recently used one, evicting the least recently used value if the cache is full
+	value_t* insert(const std::string& key, std::unique_ptr<value_t> value)
+	{
+		if (auto it = index_.find(key); it != index_.end())
+		{
+			entries_.erase(it->second);
+			index_.erase(it);
+		}
+
+		if (entries_.size() == capacity_)
+		{
+			index_.erase(entries_.back().first);
+			entries_.pop_back();
+		}
+
+		entries_.emplace_front(key, std::move(value));
+		index_[key] = entries_.begin();
+
+		return entries_.front().second.get();
+	}
+
+	size_t size() const { return entries_.size(); }
+};
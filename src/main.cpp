@@ -1,45 +1,49 @@
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <optional>
+#include <sstream>
+#include <thread>
 
+#include "checkpoint.h"
 #include "generator.h"
-#include "kernel_compiler.h"
-#include "simulation_runner.h"
+#include "host/bitsliced_model.h"
+#include "host/bytecode_model.h"
+#include "host/host_compiler.h"
+#include "host/host_simulation_runner.h"
+#include "host/mutant_model.h"
+#include "module_cache.h"
+#include "mutants.h"
+#include "server.h"
+#include "simulation_session.h"
 #include "state_word.h"
 #include "statistics/final_states.h"
-#include "statistics/fixed_states.h"
+#include "statistics/host/host_stats.h"
+#include "statistics/partial_results.h"
+#include "statistics/partial_stats.h"
 #include "statistics/stats_composite.h"
 #include "statistics/window_average_small.h"
+#include "sweep.h"
 #include "timer.h"
 
-state_t create_noninternals_mask(driver& drv)
-{
-	state_t mask(drv.nodes.size());
-	for (size_t i = 0; i < drv.nodes.size(); ++i)
-	{
-		if (!drv.nodes[i].is_internal(drv))
-			mask.set(i);
-	}
-
-	return mask;
-}
+#ifdef MABOSSG_CUDA
+	#include "kernel_compiler.h"
+	#include "simulation_runner.h"
+	#include "statistics/cuda/final_states_reducer.h"
+	#include "statistics/cuda/fixed_states_reducer.h"
+	#include "statistics/cuda/window_average_small_reducer.h"
+#endif
 
-std::vector<float> create_initial_probs(driver& drv)
-{
-	std::vector<float> initial_probs;
-	for (auto&& node : drv.nodes)
-	{
-		initial_probs.push_back(node.istate);
-	}
-
-	return initial_probs;
-}
-
-int do_compilation(driver& drv, bool discrete_time, std::optional<kernel_compiler>& compiler)
+#ifdef MABOSSG_CUDA
+int do_compilation(driver& drv, bool discrete_time, bool rate_tree, std::optional<kernel_compiler>& compiler)
 {
 	timer_stats stats("main> compilation");
 
-	generator gen(drv);
+	generator gen(drv, code_target::cuda, rate_tree);
 
 	auto s = gen.generate_code();
 
@@ -52,26 +56,33 @@ int do_compilation(driver& drv, bool discrete_time, std::optional<kernel_compile
 }
 
 stats_composite do_simulation(bool discrete_time, float max_time, float time_tick, int sample_count, int state_size,
-							  unsigned long long seed, std::vector<float> initial_probs,
-							  const state_t& noninternals_mask, int noninternals_count, kernel_compiler& compiler)
+							  unsigned long long seed, unsigned long long first_trajectory,
+							  std::vector<float> initial_probs, const state_t& noninternals_mask,
+							  int noninternals_count, kernel_compiler& compiler, size_t memory_budget)
 {
 	timer_stats stats("main> simulation");
 
-	simulation_runner r(sample_count, state_size, seed, std::move(initial_probs));
+	simulation_runner r(sample_count, state_size, seed, std::move(initial_probs), first_trajectory);
+	if (memory_budget)
+		r.fit_memory_budget(memory_budget);
 
 	stats_composite stats_runner;
 
 	// for final states
-	stats_runner.add(
-		std::make_unique<final_states_stats>(noninternals_mask, noninternals_count, compiler.final_states));
+	stats_runner.add(std::make_unique<final_states_stats>(
+		noninternals_mask,
+		std::make_unique<final_states_cuda_reducer>(noninternals_count, noninternals_mask.words_n(),
+													compiler.final_states)));
 
 	// for fixed states
-	fixed_states_stats_builder::add_fixed_states_stats(stats_runner, noninternals_mask.words_n());
+	add_fixed_states_stats_cuda(stats_runner, noninternals_mask.words_n());
 
 	// for window averages
 	stats_runner.add(std::make_unique<window_average_small_stats>(
-		time_tick, max_time, discrete_time, noninternals_mask, noninternals_count, r.trajectory_len_limit,
-		r.trajectory_batch_limit, compiler.window_average_small));
+		time_tick, max_time, discrete_time, noninternals_mask,
+		std::make_unique<window_average_small_cuda_reducer>(time_tick, max_time, discrete_time, noninternals_count,
+															noninternals_mask.words_n(), r.trajectory_len_limit,
+															compiler.window_average_small)));
 
 	// // run
 	r.run_simulation(stats_runner, compiler.initialize_random, compiler.initialize_initial_state, compiler.simulate);
@@ -81,14 +92,184 @@ stats_composite do_simulation(bool discrete_time, float max_time, float time_tic
 
 	return stats_runner;
 }
+#endif
+
+int do_host_compilation(driver& drv, host_compiler& compiler)
+{
+	timer_stats stats("main> compilation");
+
+	generator gen(drv, code_target::host);
+
+	auto s = gen.generate_code();
+
+	if (compiler.compile_simulation(s))
+		return 1;
+
+	return 0;
+}
+
+// With a positive tolerance the run stops once the results are within it, sample_count becomes the number of the
+// simulated trajectories
+template <typename model_t>
+stats_composite do_host_simulation(bool discrete_time, float max_time, float time_tick, int& sample_count,
+								   int state_size, unsigned long long seed, unsigned long long first_trajectory,
+								   std::vector<float> initial_probs, const state_t& noninternals_mask,
+								   int noninternals_count, const model_t& model, thread_pool& pool, bool rate_tree,
+								   checkpointer* checkpoints, float tolerance, size_t memory_budget, bool fused_stats,
+								   bool window_errors, thread_pool* stats_pool)
+{
+	timer_stats stats("main> simulation");
+
+	host_simulation_runner r(sample_count, state_size, seed, std::move(initial_probs), max_time, time_tick,
+							 discrete_time, pool, rate_tree, first_trajectory);
+	if (stats_pool)
+		r.pipeline_stats(*stats_pool);
+	if (memory_budget)
+		r.fit_memory_budget(memory_budget, model, nullptr,
+							host_stats_bytes(discrete_time, max_time, time_tick, noninternals_count,
+											 (stats_pool ? *stats_pool : pool).size(), window_errors),
+							host_stats_slot_bytes(window_errors));
+	if (fused_stats)
+		r.fuse_stats();
+	if (checkpoints)
+		r.enable_checkpoints(*checkpoints);
+	if (tolerance > 0.f)
+		r.stop_at_tolerance(tolerance);
+
+	stats_composite stats_runner;
+
+	add_host_stats(stats_runner, discrete_time, max_time, time_tick, noninternals_mask, noninternals_count,
+				   r.trajectory_len_limit, model, stats_pool ? *stats_pool : pool, window_errors);
 
+	// run
+	r.run_simulation(stats_runner, model);
+
+	if (tolerance > 0.f)
+	{
+		if (r.achieved_error() <= tolerance)
+			std::cerr << "Converged with " << r.simulated_trajectories() << " trajectories, the largest error is "
+					  << r.achieved_error() << "." << std::endl;
+		else
+			std::cerr << "Not converged after all the " << r.simulated_trajectories()
+					  << " trajectories, the largest error is " << r.achieved_error() << "." << std::endl;
+
+		sample_count = r.simulated_trajectories();
+	}
+
+	// finalize
+	stats_runner.finalize();
+
+	return stats_runner;
+}
+
+// Simulates the variants given by their models and initial probabilities in shared batches, the stats are evaluated
+// by the model of the whole network. Returns the stats of each variant.
+std::vector<stats_composite> do_host_variant_simulation(bool discrete_time, float max_time, float time_tick,
+														int sample_count, int state_size, unsigned long long seed,
+														unsigned long long first_trajectory,
+														const std::vector<const host_model*>& variant_models,
+														const std::vector<std::vector<float>>& variant_initial_probs,
+														const state_t& noninternals_mask, int noninternals_count,
+														const host_model& model, thread_pool& pool, bool rate_tree,
+														checkpointer* checkpoints, size_t memory_budget,
+														bool fused_stats, bool window_errors, thread_pool* stats_pool)
+{
+	timer_stats stats("main> simulation");
+
+	host_simulation_runner r(sample_count, state_size, seed, {}, max_time, time_tick, discrete_time, pool, rate_tree,
+							 first_trajectory);
+	if (stats_pool)
+		r.pipeline_stats(*stats_pool);
+	if (memory_budget)
+		r.fit_memory_budget(memory_budget, *variant_models.front(), variant_initial_probs.front().data(),
+							host_stats_bytes(discrete_time, max_time, time_tick, noninternals_count,
+											 (stats_pool ? *stats_pool : pool).size(), window_errors)
+								* variant_models.size(),
+							host_stats_slot_bytes(window_errors));
+	if (fused_stats)
+		r.fuse_stats();
+	if (checkpoints)
+		r.enable_checkpoints(*checkpoints);
+
+	std::vector<stats_composite> stats_runners(variant_models.size());
+	std::vector<stats_composite*> variant_stats;
+
+	for (auto&& stats_runner : stats_runners)
+	{
+		add_host_stats(stats_runner, discrete_time, max_time, time_tick, noninternals_mask, noninternals_count,
+					   r.trajectory_len_limit, model, stats_pool ? *stats_pool : pool, window_errors);
+
+		variant_stats.push_back(&stats_runner);
+	}
+
+	// run
+	r.run_variants(variant_stats, variant_models, variant_initial_probs);
+
+	// finalize
+	for (auto&& stats_runner : stats_runners)
+		stats_runner.finalize();
+
+	return stats_runners;
+}
+
+// Simulates all the mutant variants by the one model in shared batches, returns the stats of each variant
+std::vector<stats_composite> do_host_mutant_simulation(bool discrete_time, float max_time, float time_tick,
+													   int sample_count, const driver& drv, unsigned long long seed,
+													   unsigned long long first_trajectory,
+													   const std::vector<mutant_variant>& variants,
+													   const state_t& noninternals_mask, int noninternals_count,
+													   const host_model& model, thread_pool& pool, bool rate_tree,
+													   checkpointer* checkpoints, size_t memory_budget,
+													   bool fused_stats, bool window_errors, thread_pool* stats_pool)
+{
+	auto dependents = build_node_dependents(drv);
+
+	std::vector<std::unique_ptr<mutant_model>> mutant_models;
+	std::vector<const host_model*> variant_models;
+	std::vector<std::vector<float>> variant_initial_probs;
+
+	for (auto&& variant : variants)
+	{
+		// the variants without rate overrides run the model directly
+		if (variant.is_wild_type())
+			variant_models.push_back(&model);
+		else
+		{
+			mutant_models.push_back(std::make_unique<mutant_model>(model, dependents, variant.rate_scales));
+			variant_models.push_back(mutant_models.back().get());
+		}
+
+		variant_initial_probs.push_back(variant.initial_probs);
+	}
+
+	return do_host_variant_simulation(discrete_time, max_time, time_tick, sample_count, drv.nodes.size(), seed,
+									  first_trajectory, variant_models, variant_initial_probs, noninternals_mask,
+									  noninternals_count, model, pool, rate_tree, checkpoints, memory_budget,
+									  fused_stats, window_errors, stats_pool);
+}
+
+// Writes the stats in the output format, the partial format stores the sums together with the fields of shard
+// identifying the simulated trajectories
 void do_visualization(stats_composite& stats_runner, int sample_count, const std::vector<std::string>& node_names,
-					  const std::string& output_prefix)
+					  const std::string& output_prefix, const std::string& format, const partial_results& shard)
 {
 	timer_stats stats("main> visualization");
 
 	// visualize
-	if (output_prefix.size() > 0)
+	if (output_prefix.size() > 0 && format == "partial")
+	{
+		// a converged run simulates only the beginning of its range
+		auto partial = shard;
+		partial.n_trajectories = sample_count;
+		partial.trajectory_ranges.front().second = partial.trajectory_ranges.front().first + sample_count;
+		stats_runner.export_partial(partial);
+		write_partial_results(output_prefix + "_partial.bin", partial);
+	}
+	else if (output_prefix.size() > 0 && format == "binary")
+	{
+		stats_runner.write_binary(sample_count, node_names, output_prefix);
+	}
+	else if (output_prefix.size() > 0)
 	{
 		stats_runner.write_csv(sample_count, node_names, output_prefix);
 	}
@@ -98,26 +279,343 @@ void do_visualization(stats_composite& stats_runner, int sample_count, const std
 	}
 }
 
+// Writes the stats of each variant, the outputs are suffixed by the variant name
+void do_variant_visualization(std::vector<stats_composite>& stats_runners, const std::vector<std::string>& names,
+							  int sample_count, const std::vector<std::string>& node_names,
+							  const std::string& output_prefix, const std::string& format, const partial_results& shard)
+{
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		if (output_prefix.empty())
+			std::cout << "variant " << names[i] << ":" << std::endl;
+
+		do_visualization(stats_runners[i], sample_count, node_names,
+						 output_prefix.empty() ? output_prefix : output_prefix + "_" + names[i], format, shard);
+	}
+}
+
+// Merges the partial results of the shards and writes them as the output of a single run over all their trajectories
+int do_merge(const std::vector<std::string>& paths, const std::string& output_prefix, const std::string& format)
+{
+	partial_results merged;
+
+	try
+	{
+		timer_stats stats("main> merge");
+
+		merged = merge_partial_results(paths);
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	stats_composite stats_runner;
+	add_partial_stats(stats_runner, merged);
+	stats_runner.finalize();
+
+	do_visualization(stats_runner, merged.n_trajectories, merged.nodes, output_prefix, format, merged);
+
+	return 0;
+}
+
+// Parses the trajectory id range "begin:end", sample_count becomes the number of trajectories in the range
+int parse_trajectory_range(const std::string& range, unsigned long long& first_trajectory, int& sample_count)
+{
+	auto colon = range.find(':');
+	bool digits = range.find_first_not_of("0123456789:") == std::string::npos;
+
+	if (digits && colon != std::string::npos && colon > 0 && colon + 1 < range.size()
+		&& range.find(':', colon + 1) == std::string::npos)
+	{
+		try
+		{
+			auto begin = std::stoull(range.substr(0, colon));
+			auto end = std::stoull(range.substr(colon + 1));
+
+			if (begin < end && end - begin <= (unsigned long long)std::numeric_limits<int>::max())
+			{
+				first_trajectory = begin;
+				sample_count = end - begin;
+				return 0;
+			}
+		}
+		catch (const std::out_of_range&)
+		{}
+	}
+
+	std::cerr << "Invalid trajectory range " << range << ", expected begin:end with begin < end." << std::endl;
+	return 1;
+}
+
+// Parses the whole text as a number of the option
+template <typename T>
+int parse_number(const std::string& option, const std::string& text, T& value)
+{
+	auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+	if (ec == std::errc() && end == text.data() + text.size())
+		return 0;
+
+	std::cerr << "Invalid value " << text << " of " << option << ", expected "
+			  << (std::is_integral_v<T> ? "an integer." : "a number.") << std::endl;
+	return 1;
+}
+
+// Parses a number of bytes with an optional K, M or G suffix of the binary multiples
+int parse_memory_size(const std::string& size, size_t& bytes)
+{
+	size_t digits = size.find_first_not_of("0123456789");
+	std::string suffix = digits == std::string::npos ? "" : size.substr(digits);
+
+	if (digits != 0 && (suffix.empty() || suffix == "K" || suffix == "M" || suffix == "G"))
+	{
+		try
+		{
+			int shift = suffix.empty() ? 0 : suffix == "K" ? 10 : suffix == "M" ? 20 : 30;
+			unsigned long long value = std::stoull(size.substr(0, digits));
+
+			if (value > 0 && value <= (std::numeric_limits<size_t>::max() >> shift))
+			{
+				bytes = value << shift;
+				return 0;
+			}
+		}
+		catch (const std::out_of_range&)
+		{}
+	}
+
+	std::cerr << "Invalid memory budget " << size << ", expected a positive number of bytes with an optional K, M or G "
+				 "suffix."
+			  << std::endl;
+	return 1;
+}
+
+// Identifies the inputs of a run, a checkpoint is resumed only by a run with the same fingerprint
+std::string run_fingerprint(const std::vector<std::string>& paths, const std::vector<std::string>& options)
+{
+	std::string contents;
+	for (auto&& path : paths)
+	{
+		std::ifstream ifs(path, std::ios::binary);
+		std::ostringstream ss;
+		ss << ifs.rdbuf();
+		contents += module_cache::make_key({ path, ss.str() });
+	}
+
+	for (auto&& option : options)
+		contents += module_cache::make_key({ option });
+
+	return module_cache::make_key({ contents });
+}
+
 int main(int argc, char** argv)
 {
 	std::vector<std::string> args(argv + 1, argv + argc);
 
-	if (!(args.size() == 2 || (args.size() == 4 && args[0] == "-o")))
+	std::string output_prefix = "";
+#ifdef MABOSSG_CUDA
+	std::string backend = "cuda";
+#else
+	std::string backend = "host";
+#endif
+	int threads = thread_pool::default_threads_count();
+	std::string selection = "linear";
+	std::string format = "csv";
+	std::string mutants_path;
+	std::string sweep_path;
+	std::string serve_path;
+	int cache_size = 16;
+	std::string trajectories;
+	std::string checkpoint_path;
+	int checkpoint_interval = 60;
+	bool resume = false;
+	float tolerance = 0.f;
+	std::string memory_budget_arg;
+	bool fused_stats = false;
+	int stats_threads = 0;
+	bool window_errors = false;
+	std::string profile_prefix;
+	std::vector<std::string> positional;
+	// a value that is not a number is reported with the usage
+	bool invalid_numbers = false;
+
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i] == "-o" && i + 1 < args.size())
+			output_prefix = args[++i];
+		else if (args[i] == "--backend" && i + 1 < args.size())
+			backend = args[++i];
+		else if (args[i] == "--threads" && i + 1 < args.size())
+		{
+			invalid_numbers |= parse_number(args[i], args[i + 1], threads);
+			i++;
+		}
+		else if (args[i] == "--selection" && i + 1 < args.size())
+			selection = args[++i];
+		else if (args[i] == "--format" && i + 1 < args.size())
+			format = args[++i];
+		else if (args[i] == "--mutants" && i + 1 < args.size())
+			mutants_path = args[++i];
+		else if (args[i] == "--sweep" && i + 1 < args.size())
+			sweep_path = args[++i];
+		else if (args[i] == "--serve" && i + 1 < args.size())
+			serve_path = args[++i];
+		else if (args[i] == "--cache-size" && i + 1 < args.size())
+		{
+			invalid_numbers |= parse_number(args[i], args[i + 1], cache_size);
+			i++;
+		}
+		else if (args[i] == "--trajectories" && i + 1 < args.size())
+			trajectories = args[++i];
+		else if (args[i] == "--checkpoint" && i + 1 < args.size())
+			checkpoint_path = args[++i];
+		else if (args[i] == "--checkpoint-interval" && i + 1 < args.size())
+		{
+			invalid_numbers |= parse_number(args[i], args[i + 1], checkpoint_interval);
+			i++;
+		}
+		else if (args[i] == "--resume")
+			resume = true;
+		else if (args[i] == "--tolerance" && i + 1 < args.size())
+		{
+			invalid_numbers |= parse_number(args[i], args[i + 1], tolerance);
+			i++;
+		}
+		else if (args[i] == "--memory-budget" && i + 1 < args.size())
+			memory_budget_arg = args[++i];
+		else if (args[i] == "--fused-stats")
+			fused_stats = true;
+		else if (args[i] == "--stats-threads" && i + 1 < args.size())
+		{
+			invalid_numbers |= parse_number(args[i], args[i + 1], stats_threads);
+			i++;
+		}
+		else if (args[i] == "--window-errors")
+			window_errors = true;
+		else if (args[i] == "--profile" && i + 1 < args.size())
+			profile_prefix = args[++i];
+		else
+			positional.push_back(args[i]);
+	}
+
+	// the profiling is enabled without changing the command line, e.g. in scripts, by the environment
+	if (const char* env_prefix = std::getenv("MABOSSG_PROFILE"); profile_prefix.empty() && env_prefix)
+		profile_prefix = env_prefix;
+
+	if (!profile_prefix.empty())
+		timer_stats::enable_profiling(profile_prefix);
+
+	if (!serve_path.empty())
 	{
-		std::cout << "Usage: MaBoSSG [-o prefix] bnd_file cfg_file" << std::endl;
+		if (!positional.empty() || invalid_numbers || threads < 1 || cache_size < 1)
+		{
+			std::cout << "Usage: MaBoSSG --serve socket [--threads n] [--cache-size n] [--profile prefix]" << std::endl;
+			return 1;
+		}
+
+		// SIGINT and SIGTERM are taken by a dedicated thread which stops the server
+		sigset_t signals;
+		sigemptyset(&signals);
+		sigaddset(&signals, SIGINT);
+		sigaddset(&signals, SIGTERM);
+		pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+		simulation_server server(serve_path, threads, cache_size);
+
+		std::thread signal_waiter([&] {
+			int signal;
+			sigwait(&signals, &signal);
+			server.stop();
+		});
+		signal_waiter.detach();
+
+		int result = server.serve();
+
+		timer_stats::write_profile();
+
+		return result;
+	}
+
+	// the partial results are written only into files
+	bool valid_format = format == "csv" || format == "binary" || (format == "partial" && !output_prefix.empty());
+
+	if (!positional.empty() && positional.front() == "merge")
+	{
+		if (positional.size() < 2 || !valid_format || invalid_numbers)
+		{
+			std::cout << "Usage: MaBoSSG merge [-o prefix] [--format csv|binary|partial] partial_file..." << std::endl;
+			return 1;
+		}
+
+		if (do_merge({ positional.begin() + 1, positional.end() }, output_prefix, format))
+			return 1;
+
+		timer_stats::write_profile();
+
+		return 0;
+	}
+
+	if (positional.size() != 2 || invalid_numbers || threads < 1
+		|| (backend != "cuda" && backend != "host" && backend != "interpreter" && backend != "bitsliced")
+		|| (selection != "linear" && selection != "tree") || !valid_format || checkpoint_interval < 1
+		|| (resume && checkpoint_path.empty()) || tolerance < 0.f || stats_threads < 0)
+	{
+		std::cout << "Usage: MaBoSSG [-o prefix] [--format csv|binary|partial] "
+					 "[--backend cuda|host|interpreter|bitsliced] [--threads n] [--selection linear|tree] "
+					 "[--mutants file | --sweep file] [--trajectories begin:end] "
+					 "[--checkpoint file [--checkpoint-interval seconds] [--resume]] [--tolerance error] "
+					 "[--memory-budget bytes[K|M|G]] [--fused-stats | --stats-threads n] [--window-errors] "
+					 "[--profile prefix] bnd_file cfg_file"
+				  << std::endl
+				  << "       MaBoSSG merge [-o prefix] [--format csv|binary|partial] partial_file..." << std::endl
+				  << "       MaBoSSG --serve socket [--threads n] [--cache-size n] [--profile prefix]" << std::endl;
 		return 1;
 	}
 
-	std::string output_prefix = "";
-	std::string bnd_path = args[0];
-	std::string cfg_path = args[1];
-	if (args[0] == "-o")
+	bool rate_tree = selection == "tree";
+
+	size_t memory_budget = 0;
+	if (!memory_budget_arg.empty() && parse_memory_size(memory_budget_arg, memory_budget))
+		return 1;
+
+	if (backend == "bitsliced" && rate_tree)
 	{
-		output_prefix = args[1];
-		bnd_path = args[2];
-		cfg_path = args[3];
+		std::cerr << "The bitsliced backend selects the flips of a whole block at once and supports only the linear "
+					 "selection."
+				  << std::endl;
+		return 1;
 	}
 
+	if (fused_stats && backend != "host" && backend != "interpreter")
+	{
+		std::cerr << "The fused stats are supported only by the host and interpreter backends." << std::endl;
+		return 1;
+	}
+
+	if (stats_threads && (backend == "cuda" || fused_stats))
+	{
+		std::cerr << "The stats are pipelined only by the CPU backends without the fused stats." << std::endl;
+		return 1;
+	}
+
+	if (window_errors && backend == "cuda")
+	{
+		std::cerr << "The window errors are estimated only by the CPU backends." << std::endl;
+		return 1;
+	}
+
+#ifndef MABOSSG_CUDA
+	if (backend == "cuda")
+	{
+		std::cerr << "This executable was built without the CUDA backend." << std::endl;
+		return 1;
+	}
+#endif
+
+	std::string bnd_path = positional[0];
+	std::string cfg_path = positional[1];
+
 	driver drv;
 	{
 		timer_stats stats("main> compilation");
@@ -130,6 +628,7 @@ int main(int argc, char** argv)
 	float time_tick = drv.constants["time_tick"];
 	int sample_count = drv.constants["sample_count"];
 	unsigned long long seed = drv.constants["seed_pseudorandom"];
+	unsigned long long first_trajectory = 0;
 	auto initial_probs = create_initial_probs(drv);
 	auto noninternals_mask = create_noninternals_mask(drv);
 	int noninternals_count =
@@ -139,31 +638,304 @@ int main(int argc, char** argv)
 	for (auto&& node : drv.nodes)
 		node_names.push_back(node.name);
 
-	if (noninternals_count > 20)
+	// a shard simulates only its range of the trajectories
+	if (!trajectories.empty() && parse_trajectory_range(trajectories, first_trajectory, sample_count))
+		return 1;
+
+	partial_results shard;
+	shard.n_trajectories = sample_count;
+	shard.seed = seed;
+	shard.trajectory_ranges = { { first_trajectory, first_trajectory + sample_count } };
+	shard.nodes = node_names;
+
+	if (noninternals_count > max_noninternals)
+	{
+		std::cerr << "This executable supports a maximum of " << max_noninternals << " non-internal nodes."
+				  << std::endl;
+		return 1;
+	}
+
+	if (backend == "cuda" && noninternals_count > max_dense_noninternals)
 	{
-		std::cerr << "This executable supports a maximum of 20 non-internal nodes." << std::endl;
+		std::cerr << "The CUDA backend supports a maximum of " << max_dense_noninternals
+				  << " non-internal nodes, use a host backend for bigger models." << std::endl;
 		return 1;
 	}
 
-	if (drv.nodes.size() > MAX_NODES)
+	if (!mutants_path.empty() && !sweep_path.empty())
 	{
-		std::cerr << "This executable supports a maximum of " << MAX_NODES << " nodes." << std::endl;
+		std::cerr << "The mutant variants and the parameter sweep cannot be combined." << std::endl;
 		return 1;
 	}
 
+	std::vector<mutant_variant> variants;
+	if (!mutants_path.empty())
+	{
+		if (backend != "host" && backend != "interpreter")
+		{
+			std::cerr << "The mutant variants are supported only by the host and interpreter backends." << std::endl;
+			return 1;
+		}
+
+		if (parse_mutants(mutants_path, drv, initial_probs, variants))
+			return 1;
+	}
+
+	std::vector<parameter_set> sweep;
+	if (!sweep_path.empty())
+	{
+		if (backend != "host" && backend != "interpreter")
+		{
+			std::cerr << "The parameter sweep is supported only by the host and interpreter backends." << std::endl;
+			return 1;
+		}
+
+		if (parse_sweep(sweep_path, drv, sweep))
+			return 1;
+	}
+
+	std::vector<std::string> variant_names;
+	for (auto&& variant : variants)
+		variant_names.push_back(variant.name);
+	for (auto&& set : sweep)
+		variant_names.push_back(set.name);
+
+	if (tolerance > 0.f && (backend == "cuda" || !variants.empty() || !sweep.empty()))
+	{
+		std::cerr << "The tolerance is supported only by the CPU backends simulating a single model." << std::endl;
+		return 1;
+	}
+
+	std::unique_ptr<checkpointer> checkpoints;
+	if (!checkpoint_path.empty())
+	{
+		if (backend == "cuda")
+		{
+			std::cerr << "The checkpoints are supported only by the CPU backends." << std::endl;
+			return 1;
+		}
+
+		// the per-thread accumulators are resumed as they are, so the threads count is a part of the run
+		auto fingerprint =
+			run_fingerprint({ bnd_path, cfg_path, mutants_path, sweep_path },
+							{ backend, selection, std::to_string(threads), std::to_string(first_trajectory),
+							  std::to_string(sample_count), std::to_string(tolerance), std::to_string(memory_budget),
+							  std::to_string(stats_threads), std::to_string(window_errors) });
+
+		checkpoints =
+			std::make_unique<checkpointer>(checkpoint_path, fingerprint, std::chrono::seconds(checkpoint_interval));
+
+		try
+		{
+			if (resume && !checkpoints->load())
+				std::cerr << "There is no checkpoint in " << checkpoint_path << ", the run starts from the beginning."
+						  << std::endl;
+		}
+		catch (const std::runtime_error& e)
+		{
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	// the CPU backends take the histograms of the stats of every variant out of the budget
+	if (memory_budget && backend != "cuda")
+	{
+		size_t stats_bytes =
+			host_stats_bytes(discrete_time, max_time, time_tick, noninternals_count,
+							 stats_threads ? stats_threads : threads, window_errors)
+			* std::max<size_t>(variant_names.size(), 1);
+
+		if (stats_bytes >= memory_budget)
+		{
+			std::cerr << "The memory budget cannot hold the " << stats_bytes
+					  << " bytes of the statistics histograms, raise it or use fewer threads." << std::endl;
+			return 1;
+		}
+	}
+
+	// the stats of a batch are reduced on their own threads while the next batch is simulated
+	std::unique_ptr<thread_pool> stats_pool;
+	if (stats_threads)
+		stats_pool = std::make_unique<thread_pool>(stats_threads);
+
+	if (backend == "host" && !variants.empty())
+	{
+		host_compiler compiler;
+		thread_pool pool(threads);
+
+		if (do_host_compilation(drv, compiler))
+			return 1;
+
+		auto stats_runners =
+			do_host_mutant_simulation(discrete_time, max_time, time_tick, sample_count, drv, seed, first_trajectory,
+									  variants, noninternals_mask, noninternals_count, compiler.functions, pool,
+									  rate_tree, checkpoints.get(), memory_budget, fused_stats, window_errors,
+									  stats_pool.get());
+
+		do_variant_visualization(stats_runners, variant_names, sample_count, node_names, output_prefix, format,
+								 shard);
+	}
+	else if (backend == "host" && !sweep.empty())
+	{
+		host_compiler compiler;
+		thread_pool pool(threads);
+
+		// one module evaluates all the parameter sets
+		drv.runtime_variables = true;
+
+		if (do_host_compilation(drv, compiler))
+			return 1;
+
+		std::vector<host_functions> set_models;
+		for (auto&& set : sweep)
+			set_models.push_back(compiler.functions.with_parameters(set.values.data()));
+
+		std::vector<const host_model*> variant_models;
+		for (auto&& set_model : set_models)
+			variant_models.push_back(&set_model);
+
+		auto stats_runners = do_host_variant_simulation(
+			discrete_time, max_time, time_tick, sample_count, drv.nodes.size(), seed, first_trajectory, variant_models,
+			std::vector<std::vector<float>>(sweep.size(), initial_probs), noninternals_mask, noninternals_count,
+			compiler.functions, pool, rate_tree, checkpoints.get(), memory_budget, fused_stats, window_errors,
+			stats_pool.get());
+
+		do_variant_visualization(stats_runners, variant_names, sample_count, node_names, output_prefix, format,
+								 shard);
+	}
+	else if (backend == "host")
+	{
+		host_compiler compiler;
+		thread_pool pool(threads);
+
+		if (do_host_compilation(drv, compiler))
+			return 1;
+
+		auto stats_runner = do_host_simulation(
+			discrete_time, max_time, time_tick, sample_count, drv.nodes.size(), seed, first_trajectory,
+			std::move(initial_probs), noninternals_mask, noninternals_count, compiler.functions, pool, rate_tree,
+			checkpoints.get(), tolerance, memory_budget, fused_stats, window_errors, stats_pool.get());
+
+		do_visualization(stats_runner, sample_count, node_names, output_prefix, format, shard);
+	}
+	else if (backend == "interpreter" && !variants.empty())
+	{
+		thread_pool pool(threads);
+
+		std::optional<bytecode_model> model;
+		{
+			timer_stats stats("main> compilation");
+			model.emplace(drv);
+		}
+
+		auto stats_runners =
+			do_host_mutant_simulation(discrete_time, max_time, time_tick, sample_count, drv, seed, first_trajectory,
+									  variants, noninternals_mask, noninternals_count, *model, pool, rate_tree,
+									  checkpoints.get(), memory_budget, fused_stats, window_errors, stats_pool.get());
+
+		do_variant_visualization(stats_runners, variant_names, sample_count, node_names, output_prefix, format,
+								 shard);
+	}
+	else if (backend == "interpreter" && !sweep.empty())
+	{
+		thread_pool pool(threads);
+
+		// the interpreter has nothing to compile, each parameter set gets its own bytecode
+		std::vector<bytecode_model> set_models;
+		{
+			timer_stats stats("main> compilation");
+
+			for (auto&& set : sweep)
+			{
+				auto value = set.values.begin();
+				for (auto&& variable : drv.variables)
+					variable.second = *value++;
+
+				set_models.emplace_back(drv);
+			}
+		}
+
+		std::vector<const host_model*> variant_models;
+		for (auto&& set_model : set_models)
+			variant_models.push_back(&set_model);
+
+		auto stats_runners = do_host_variant_simulation(
+			discrete_time, max_time, time_tick, sample_count, drv.nodes.size(), seed, first_trajectory, variant_models,
+			std::vector<std::vector<float>>(sweep.size(), initial_probs), noninternals_mask, noninternals_count,
+			*variant_models.front(), pool, rate_tree, checkpoints.get(), memory_budget, fused_stats, window_errors,
+			stats_pool.get());
+
+		do_variant_visualization(stats_runners, variant_names, sample_count, node_names, output_prefix, format,
+								 shard);
+	}
+	else if (backend == "interpreter")
+	{
+		thread_pool pool(threads);
+
+		std::optional<bytecode_model> model;
+		{
+			timer_stats stats("main> compilation");
+			model.emplace(drv);
+		}
+
+		auto stats_runner = do_host_simulation(discrete_time, max_time, time_tick, sample_count, drv.nodes.size(),
+											   seed, first_trajectory, std::move(initial_probs), noninternals_mask,
+											   noninternals_count, *model, pool, rate_tree, checkpoints.get(),
+											   tolerance, memory_budget, fused_stats, window_errors, stats_pool.get());
+
+		do_visualization(stats_runner, sample_count, node_names, output_prefix, format, shard);
+	}
+	else if (backend == "bitsliced")
+	{
+		if (!bitsliced_model::is_supported(drv))
+		{
+			std::cerr << "The bitsliced backend supports only models with constant rates of the form "
+						 "\"@logic ? rate : 0\" and Boolean logic formulas."
+					  << std::endl;
+			return 1;
+		}
+
+		thread_pool pool(threads);
+
+		std::optional<bitsliced_model> model;
+		{
+			timer_stats stats("main> compilation");
+			model.emplace(drv);
+		}
+
+		auto stats_runner = do_host_simulation(discrete_time, max_time, time_tick, sample_count, drv.nodes.size(),
+											   seed, first_trajectory, std::move(initial_probs), noninternals_mask,
+											   noninternals_count, *model, pool, rate_tree, checkpoints.get(),
+											   tolerance, memory_budget, fused_stats, window_errors, stats_pool.get());
+
+		do_visualization(stats_runner, sample_count, node_names, output_prefix, format, shard);
+	}
+#ifdef MABOSSG_CUDA
+	else
 	{
 		std::optional<kernel_compiler> compiler;
 
-		if (do_compilation(drv, discrete_time, compiler))
+		if (do_compilation(drv, discrete_time, rate_tree, compiler))
 			return 1;
 
 		auto stats_runner = do_simulation(discrete_time, max_time, time_tick, sample_count, drv.nodes.size(), seed,
-										  std::move(initial_probs), noninternals_mask, noninternals_count, *compiler);
+										  first_trajectory, std::move(initial_probs), noninternals_mask,
+										  noninternals_count, *compiler, memory_budget);
 
-		do_visualization(stats_runner, sample_count, node_names, output_prefix);
+		do_visualization(stats_runner, sample_count, node_names, output_prefix, format, shard);
 	}
+#endif
+
+	// the results are written, nothing is left to resume
+	if (checkpoints)
+		checkpoints->finish();
 
-	timer_stats::print_aggregate_stats();
+	if (!timer_stats::write_profile())
+	{
+		std::cerr << "Could not write the profile " << profile_prefix << std::endl;
+		return 1;
+	}
 
 	return 0;
 }
@@ -0,0 +1,187 @@
+#include "module_cache.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <signal.h>
+#include <unistd.h>
+
+#include "timer.h"
+
+namespace fs = std::filesystem;
+
+std::string default_cache_dir()
+{
+	if (const char* dir = std::getenv("MABOSSG_CACHE_DIR"))
+		return dir;
+
+	if (const char* dir = std::getenv("XDG_CACHE_HOME"); dir && *dir)
+		return (fs::path(dir) / "mabossg").string();
+
+	if (const char* dir = std::getenv("HOME"); dir && *dir)
+		return (fs::path(dir) / ".cache" / "mabossg").string();
+
+	return "";
+}
+
+module_cache::module_cache() : module_cache(default_cache_dir()) {}
+
+module_cache::module_cache(std::string dir) : dir_(std::move(dir))
+{
+	if (dir_.empty())
+		return;
+
+	std::error_code ec;
+	fs::create_directories(dir_, ec);
+
+	if (!fs::is_directory(dir_, ec))
+	{
+		std::cerr << "module_cache> cannot use the cache directory " << dir_ << std::endl;
+		dir_.clear();
+		return;
+	}
+
+	remove_stale_temps();
+}
+
+void module_cache::remove_stale_temps() const
+{
+	// temporary files are named <entry>.tmp.<pid>.<counter>, the ones of live processes may still be committed
+	constexpr auto max_temp_age = std::chrono::hours(24);
+
+	std::error_code ec;
+	auto now = fs::file_time_type::clock::now();
+
+	for (fs::directory_iterator it(dir_, ec), end; !ec && it != end; it.increment(ec))
+	{
+		auto name = it->path().filename().string();
+		auto tmp = name.find(".tmp.");
+		if (tmp == std::string::npos)
+			continue;
+
+		char* pid_end;
+		long pid = std::strtol(name.c_str() + tmp + 5, &pid_end, 10);
+		if (pid <= 0 || *pid_end != '.')
+			continue;
+
+		// the processes of other machines sharing the directory are unknown here, their files are removed once old
+		bool dead = kill(pid, 0) != 0 && errno == ESRCH;
+
+		std::error_code time_ec;
+		auto written = fs::last_write_time(it->path(), time_ec);
+		bool old = !time_ec && now - written > max_temp_age;
+
+		if (dead || old)
+		{
+			std::error_code remove_ec;
+			fs::remove(it->path(), remove_ec);
+		}
+	}
+}
+
+bool module_cache::enabled() const { return !dir_.empty(); }
+
+std::string module_cache::make_key(std::initializer_list<std::string_view> parts)
+{
+	// two 64-bit FNV-1a hashes with different offset bases, the second one is xorshifted to decorrelate them
+	uint64_t h1 = 14695981039346656037ull;
+	uint64_t h2 = 0x6c62272e07bb0142ull;
+
+	auto add_byte = [&](unsigned char c) {
+		h1 = (h1 ^ c) * 1099511628211ull;
+		h2 = (h2 ^ c) * 1099511628211ull;
+		h2 ^= h2 >> 29;
+	};
+
+	for (auto part : parts)
+	{
+		// the part sizes keep the boundaries between the parts
+		for (size_t size = part.size(), i = 0; i < sizeof(size); i++)
+			add_byte((size >> (i * 8)) & 0xff);
+
+		for (char c : part)
+			add_byte(c);
+	}
+
+	std::ostringstream ss;
+	ss << std::hex;
+	ss.width(16);
+	ss.fill('0');
+	ss << h1;
+	ss.width(16);
+	ss << h2;
+	return ss.str();
+}
+
+std::string module_cache::path(const std::string& key, const std::string& suffix) const
+{
+	return (fs::path(dir_) / (key + suffix)).string();
+}
+
+std::string module_cache::temp_path(const std::string& key, const std::string& suffix) const
+{
+	static std::atomic<int> counter = 0;
+
+	return path(key, suffix) + ".tmp." + std::to_string(getpid()) + "." + std::to_string(counter++);
+}
+
+bool module_cache::commit(const std::string& temp_path, const std::string& key, const std::string& suffix) const
+{
+	std::error_code ec;
+	fs::rename(temp_path, path(key, suffix), ec);
+
+	if (ec)
+	{
+		fs::remove(temp_path, ec);
+		return false;
+	}
+
+	return true;
+}
+
+bool module_cache::load(const std::string& key, const std::string& suffix, std::string& data) const
+{
+	if (!enabled())
+		return false;
+
+	timer_stats stats("module_cache> load");
+
+	std::ifstream ifs(path(key, suffix), std::ios::binary);
+	if (!ifs)
+		return false;
+
+	std::ostringstream ss;
+	ss << ifs.rdbuf();
+	data = ss.str();
+
+	return !data.empty();
+}
+
+bool module_cache::store(const std::string& key, const std::string& suffix, const std::string& data) const
+{
+	if (!enabled())
+		return false;
+
+	timer_stats stats("module_cache> store");
+
+	auto temp = temp_path(key, suffix);
+	{
+		std::ofstream ofs(temp, std::ios::binary);
+		ofs.write(data.data(), data.size());
+
+		if (!ofs)
+		{
+			std::error_code ec;
+			fs::remove(temp, ec);
+			return false;
+		}
+	}
+
+	return commit(temp, key, suffix);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+// Content addressed directory of compiled simulation modules, it may be shared by concurrently running processes.
+// Entries are written under a unique temporary name and renamed into place, so readers never see a partial module.
+// The temporary files left by interrupted processes are removed when the cache is opened.
+// The directory is MABOSSG_CACHE_DIR, or mabossg in the user cache directory. An empty MABOSSG_CACHE_DIR disables it.
+class module_cache
+{
+	std::string dir_;
+
+	void remove_stale_temps() const;
+
+public:
+	module_cache();
+	explicit module_cache(std::string dir);
+
+	bool enabled() const;
+
+	// Hash of all the inputs which determine the compiled module
+	static std::string make_key(std::initializer_list<std::string_view> parts);
+
+	// Path of the cached module, it exists only if the module was already stored
+	std::string path(const std::string& key, const std::string& suffix) const;
+
+	// Unique path in the cache directory where a new module can be written before it is committed
+	std::string temp_path(const std::string& key, const std::string& suffix) const;
+
+	// Atomically moves a module written to temp_path into its path
+	bool commit(const std::string& temp_path, const std::string& key, const std::string& suffix) const;
+
+	bool load(const std::string& key, const std::string& suffix, std::string& data) const;
+	bool store(const std::string& key, const std::string& suffix, const std::string& data) const;
+};
@@ -0,0 +1,104 @@
+#include "mutants.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+bool mutant_variant::is_wild_type() const
+{
+	return std::all_of(rate_scales.begin(), rate_scales.end(), [](float s) { return s == 1.f; });
+}
+
+int parse_mutants(const std::string& path, const driver& drv, const std::vector<float>& initial_probs,
+				  std::vector<mutant_variant>& variants)
+{
+	std::ifstream ifs(path);
+	if (!ifs)
+	{
+		std::cerr << "cannot open " << path << std::endl;
+		return 1;
+	}
+
+	auto find_node = [&](const std::string& name) {
+		for (size_t i = 0; i < drv.nodes.size(); i++)
+			if (drv.nodes[i].name == name)
+				return (int)i;
+		return -1;
+	};
+
+	std::vector<mutant_variant> parsed;
+	std::set<std::string> names;
+	std::string line;
+	for (int line_no = 1; std::getline(ifs, line); line_no++)
+	{
+		std::istringstream tokens(line);
+		mutant_variant variant;
+
+		if (!(tokens >> variant.name) || variant.name[0] == '#')
+			continue;
+
+		auto error = [&](const std::string& message) {
+			std::cerr << path << ":" << line_no << ": " << message << std::endl;
+			return 1;
+		};
+
+		if (!names.insert(variant.name).second)
+			return error("duplicate variant " + variant.name);
+
+		variant.rate_scales.assign(2 * drv.nodes.size(), 1.f);
+		variant.initial_probs = initial_probs;
+
+		std::string token;
+		while (tokens >> token)
+		{
+			auto op = token.find_first_of("=*");
+			if (op == std::string::npos)
+				return error("invalid override " + token);
+
+			int node = find_node(token.substr(0, op));
+			std::string value = token.substr(op + 1);
+
+			if (node == -1)
+				return error("unknown node in override " + token);
+
+			if (token[op] == '=' && (value == "0" || value == "1"))
+			{
+				bool on = value == "1";
+				variant.rate_scales[2 * node + (on ? 1 : 0)] = 0.f;
+				variant.initial_probs[node] = on ? 1.f : 0.f;
+				continue;
+			}
+
+			float scale;
+			size_t parsed = 0;
+			try
+			{
+				scale = std::stof(value, &parsed);
+			}
+			catch (const std::exception&)
+			{
+				parsed = 0;
+			}
+
+			if (token[op] != '*' || parsed == 0 || parsed != value.size() || scale < 0.f)
+				return error("invalid override " + token);
+
+			variant.rate_scales[2 * node] *= scale;
+			variant.rate_scales[2 * node + 1] *= scale;
+		}
+
+		parsed.push_back(std::move(variant));
+	}
+
+	if (parsed.empty())
+	{
+		std::cerr << path << ": no variants" << std::endl;
+		return 1;
+	}
+
+	variants = std::move(parsed);
+
+	return 0;
+}
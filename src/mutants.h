@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "parser/driver.h"
+
+// Variant of the model with some nodes forced on or off or with scaled rates
+struct mutant_variant
+{
+	std::string name;
+
+	// Multipliers of the flip rates, rate_scales[2 * i] applies to the node i when it is off (its up rate)
+	// and rate_scales[2 * i + 1] when it is on (its down rate)
+	std::vector<float> rate_scales;
+	std::vector<float> initial_probs;
+
+	// True if the variant does not override anything
+	bool is_wild_type() const;
+};
+
+// Reads the variants from a file with one variant per line, a name followed by whitespace separated overrides:
+//   NODE=0      knock-out, the node starts off and never turns on
+//   NODE=1      knock-in, the node starts on and never turns off
+//   NODE*k      both rates of the node are scaled by k
+// Empty lines and lines starting with # are skipped. Returns 0 on success.
+int parse_mutants(const std::string& path, const driver& drv, const std::vector<float>& initial_probs,
+				  std::vector<mutant_variant>& variants);
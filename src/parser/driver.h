@@ -39,6 +39,9 @@ public:
 	driver();
 
 	std::map<std::string, float> variables;
+	// Whether the generated code reads the variables from the runtime parameters array, indexed in the order of
+	// variables, instead of having their values as literals
+	bool runtime_variables = false;
 	std::map<std::string, float> constants;
 	std::vector<node_t> nodes;
 
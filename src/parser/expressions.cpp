@@ -1,8 +1,10 @@
 #include "expressions.h"
 
 #include <algorithm>
+#include <iterator>
 #include <stdexcept>
 
+#include "../host/bytecode.h"
 #include "driver.h"
 
 unary_expression::unary_expression(operation op, expr_ptr expr) : op(op), expr(std::move(expr)) {}
@@ -43,6 +45,37 @@ void unary_expression::generate_code(const driver& drv, const std::string& curre
 	}
 }
 
+void unary_expression::generate_bytecode(const driver& drv, const std::string& current_node,
+										 bytecode_program& program) const
+{
+	expr->generate_bytecode(drv, current_node, program);
+
+	switch (op)
+	{
+		case operation::PLUS:
+			break;
+		case operation::MINUS:
+			program.emit(opcode::negate);
+			break;
+		case operation::NOT:
+			program.emit(opcode::logical_not);
+			break;
+		default:
+			throw std::runtime_error("Unknown unary operator");
+	}
+}
+
+void unary_expression::collect_node_references(const driver& drv, const std::string& current_node,
+											   std::vector<int>& nodes) const
+{
+	expr->collect_node_references(drv, current_node, nodes);
+}
+
+bool unary_expression::references_variables(const driver& drv, const std::string& current_node) const
+{
+	return expr->references_variables(drv, current_node);
+}
+
 binary_expression::binary_expression(operation op, expr_ptr left, expr_ptr right)
 	: op(op), left(std::move(left)), right(std::move(right))
 {}
@@ -149,6 +182,67 @@ void binary_expression::generate_code(const driver& drv, const std::string& curr
 	}
 }
 
+void binary_expression::generate_bytecode(const driver& drv, const std::string& current_node,
+										  bytecode_program& program) const
+{
+	left->generate_bytecode(drv, current_node, program);
+	right->generate_bytecode(drv, current_node, program);
+
+	switch (op)
+	{
+		case operation::PLUS:
+			program.emit(opcode::add);
+			break;
+		case operation::MINUS:
+			program.emit(opcode::sub);
+			break;
+		case operation::STAR:
+			program.emit(opcode::mul);
+			break;
+		case operation::SLASH:
+			program.emit(opcode::div);
+			break;
+		case operation::AND:
+			program.emit(opcode::logical_and);
+			break;
+		case operation::OR:
+			program.emit(opcode::logical_or);
+			break;
+		case operation::EQ:
+			program.emit(opcode::eq);
+			break;
+		case operation::NE:
+			program.emit(opcode::ne);
+			break;
+		case operation::LE:
+			program.emit(opcode::le);
+			break;
+		case operation::LT:
+			program.emit(opcode::lt);
+			break;
+		case operation::GE:
+			program.emit(opcode::ge);
+			break;
+		case operation::GT:
+			program.emit(opcode::gt);
+			break;
+		default:
+			throw std::runtime_error("Unknown binary operator " + std::to_string(static_cast<int>(op)));
+	}
+}
+
+void binary_expression::collect_node_references(const driver& drv, const std::string& current_node,
+												std::vector<int>& nodes) const
+{
+	left->collect_node_references(drv, current_node, nodes);
+	right->collect_node_references(drv, current_node, nodes);
+}
+
+bool binary_expression::references_variables(const driver& drv, const std::string& current_node) const
+{
+	return left->references_variables(drv, current_node) || right->references_variables(drv, current_node);
+}
+
 ternary_expression::ternary_expression(expr_ptr left, expr_ptr middle, expr_ptr right)
 	: left(std::move(left)), middle(std::move(middle)), right(std::move(right))
 {}
@@ -167,6 +261,35 @@ void ternary_expression::generate_code(const driver& drv, const std::string& cur
 	right->generate_code(drv, current_node, os);
 }
 
+void ternary_expression::generate_bytecode(const driver& drv, const std::string& current_node,
+										   bytecode_program& program) const
+{
+	left->generate_bytecode(drv, current_node, program);
+	auto to_right = program.emit_jump(opcode::jump_if_zero);
+
+	middle->generate_bytecode(drv, current_node, program);
+	auto to_end = program.emit_jump(opcode::jump);
+
+	program.patch_jump(to_right);
+	right->generate_bytecode(drv, current_node, program);
+
+	program.patch_jump(to_end);
+}
+
+void ternary_expression::collect_node_references(const driver& drv, const std::string& current_node,
+												 std::vector<int>& nodes) const
+{
+	left->collect_node_references(drv, current_node, nodes);
+	middle->collect_node_references(drv, current_node, nodes);
+	right->collect_node_references(drv, current_node, nodes);
+}
+
+bool ternary_expression::references_variables(const driver& drv, const std::string& current_node) const
+{
+	return left->references_variables(drv, current_node) || middle->references_variables(drv, current_node)
+		   || right->references_variables(drv, current_node);
+}
+
 parenthesis_expression::parenthesis_expression(expr_ptr expr) : expr(std::move(expr)) {}
 
 float parenthesis_expression::evaluate(const driver& drv) const { return expr->evaluate(drv); }
@@ -178,12 +301,38 @@ void parenthesis_expression::generate_code(const driver& drv, const std::string&
 	os << ")";
 }
 
+void parenthesis_expression::generate_bytecode(const driver& drv, const std::string& current_node,
+											   bytecode_program& program) const
+{
+	expr->generate_bytecode(drv, current_node, program);
+}
+
+void parenthesis_expression::collect_node_references(const driver& drv, const std::string& current_node,
+													 std::vector<int>& nodes) const
+{
+	expr->collect_node_references(drv, current_node, nodes);
+}
+
+bool parenthesis_expression::references_variables(const driver& drv, const std::string& current_node) const
+{
+	return expr->references_variables(drv, current_node);
+}
+
 literal_expression::literal_expression(float value) : value(value) {}
 
 float literal_expression::evaluate(const driver&) const { return value; }
 
 void literal_expression::generate_code(const driver&, const std::string&, std::ostream& os) const { os << value; }
 
+void literal_expression::generate_bytecode(const driver&, const std::string&, bytecode_program& program) const
+{
+	program.emit_const(value);
+}
+
+void literal_expression::collect_node_references(const driver&, const std::string&, std::vector<int>&) const {}
+
+bool literal_expression::references_variables(const driver&, const std::string&) const { return false; }
+
 identifier_expression::identifier_expression(std::string name) : name(std::move(name)) {}
 
 float identifier_expression::evaluate(const driver&) const
@@ -204,15 +353,56 @@ void identifier_expression::generate_code(const driver& drv, const std::string&,
 	os << "((state[" << word << "] & " << (1u << bit) << "u) != 0)";
 }
 
+void identifier_expression::generate_bytecode(const driver& drv, const std::string&, bytecode_program& program) const
+{
+	auto it = std::find_if(drv.nodes.begin(), drv.nodes.end(), [this](auto&& node) { return node.name == name; });
+	if (it == drv.nodes.end())
+	{
+		throw std::runtime_error("unknown node name: " + name);
+	}
+	program.emit(opcode::push_node, it - drv.nodes.begin());
+}
+
+void identifier_expression::collect_node_references(const driver& drv, const std::string&,
+												   std::vector<int>& nodes) const
+{
+	auto it = std::find_if(drv.nodes.begin(), drv.nodes.end(), [this](auto&& node) { return node.name == name; });
+	if (it == drv.nodes.end())
+	{
+		throw std::runtime_error("unknown node name: " + name);
+	}
+	nodes.push_back(it - drv.nodes.begin());
+}
+
+bool identifier_expression::references_variables(const driver&, const std::string&) const { return false; }
+
 variable_expression::variable_expression(std::string name) : name(std::move(name)) {}
 
 float variable_expression::evaluate(const driver& drv) const { return drv.variables.at(name); }
 
 void variable_expression::generate_code(const driver& drv, const std::string&, std::ostream& os) const
 {
-	os << drv.variables.at(name);
+	auto it = drv.variables.find(name);
+	if (it == drv.variables.end())
+	{
+		throw std::runtime_error("unknown variable: " + name);
+	}
+
+	if (drv.runtime_variables)
+		os << "parameters[" << std::distance(drv.variables.begin(), it) << "]";
+	else
+		os << it->second;
 }
 
+void variable_expression::generate_bytecode(const driver& drv, const std::string&, bytecode_program& program) const
+{
+	program.emit_const(drv.variables.at(name));
+}
+
+void variable_expression::collect_node_references(const driver&, const std::string&, std::vector<int>&) const {}
+
+bool variable_expression::references_variables(const driver&, const std::string&) const { return true; }
+
 alias_expression::alias_expression(std::string name) : name(std::move(name)) {}
 
 float alias_expression::evaluate(const driver&) const
@@ -229,3 +419,35 @@ void alias_expression::generate_code(const driver& drv, const std::string& curre
 
 	attr.second->generate_code(drv, current_node, os);
 }
+
+void alias_expression::generate_bytecode(const driver& drv, const std::string& current_node,
+										 bytecode_program& program) const
+{
+	auto it = std::find_if(drv.nodes.begin(), drv.nodes.end(), [&](auto&& node) { return node.name == current_node; });
+	assert(it != drv.nodes.end());
+
+	auto&& attr = it->get_attr(name.substr(1));
+
+	attr.second->generate_bytecode(drv, current_node, program);
+}
+
+void alias_expression::collect_node_references(const driver& drv, const std::string& current_node,
+											   std::vector<int>& nodes) const
+{
+	auto it = std::find_if(drv.nodes.begin(), drv.nodes.end(), [&](auto&& node) { return node.name == current_node; });
+	assert(it != drv.nodes.end());
+
+	auto&& attr = it->get_attr(name.substr(1));
+
+	attr.second->collect_node_references(drv, current_node, nodes);
+}
+
+bool alias_expression::references_variables(const driver& drv, const std::string& current_node) const
+{
+	auto it = std::find_if(drv.nodes.begin(), drv.nodes.end(), [&](auto&& node) { return node.name == current_node; });
+	assert(it != drv.nodes.end());
+
+	auto&& attr = it->get_attr(name.substr(1));
+
+	return attr.second->references_variables(drv, current_node);
+}
@@ -2,9 +2,11 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 class expression;
 class driver;
+class bytecode_program;
 
 using expr_ptr = std::unique_ptr<expression>;
 
@@ -32,6 +34,13 @@ public:
 	virtual ~expression() {}
 	virtual float evaluate(const driver& drv) const = 0;
 	virtual void generate_code(const driver& drv, const std::string& current_node, std::ostream& os) const = 0;
+	virtual void generate_bytecode(const driver& drv, const std::string& current_node,
+								   bytecode_program& program) const = 0;
+	// Appends the indices of the nodes the expression reads
+	virtual void collect_node_references(const driver& drv, const std::string& current_node,
+										 std::vector<int>& nodes) const = 0;
+	// True if the expression reads a variable of the model
+	virtual bool references_variables(const driver& drv, const std::string& current_node) const = 0;
 };
 
 class unary_expression : public expression
@@ -40,6 +49,11 @@ public:
 	unary_expression(operation op, expr_ptr expr);
 	float evaluate(const driver& drv) const override;
 	void generate_code(const driver& drv, const std::string& current_node, std::ostream& os) const override;
+	void generate_bytecode(const driver& drv, const std::string& current_node,
+						   bytecode_program& program) const override;
+	void collect_node_references(const driver& drv, const std::string& current_node,
+								 std::vector<int>& nodes) const override;
+	bool references_variables(const driver& drv, const std::string& current_node) const override;
 
 	operation op;
 	expr_ptr expr;
@@ -51,6 +65,11 @@ public:
 	binary_expression(operation op, expr_ptr left, expr_ptr right);
 	float evaluate(const driver& drv) const override;
 	void generate_code(const driver& drv, const std::string& current_node, std::ostream& os) const override;
+	void generate_bytecode(const driver& drv, const std::string& current_node,
+						   bytecode_program& program) const override;
+	void collect_node_references(const driver& drv, const std::string& current_node,
+								 std::vector<int>& nodes) const override;
+	bool references_variables(const driver& drv, const std::string& current_node) const override;
 
 	operation op;
 	expr_ptr left;
@@ -63,6 +82,11 @@ public:
 	ternary_expression(expr_ptr left, expr_ptr middle, expr_ptr right);
 	float evaluate(const driver& drv) const override;
 	void generate_code(const driver& drv, const std::string& current_node, std::ostream& os) const override;
+	void generate_bytecode(const driver& drv, const std::string& current_node,
+						   bytecode_program& program) const override;
+	void collect_node_references(const driver& drv, const std::string& current_node,
+								 std::vector<int>& nodes) const override;
+	bool references_variables(const driver& drv, const std::string& current_node) const override;
 
 	expr_ptr left;
 	expr_ptr middle;
@@ -75,6 +99,11 @@ public:
 	parenthesis_expression(expr_ptr expr);
 	float evaluate(const driver& drv) const override;
 	void generate_code(const driver& drv, const std::string& current_node, std::ostream& os) const override;
+	void generate_bytecode(const driver& drv, const std::string& current_node,
+						   bytecode_program& program) const override;
+	void collect_node_references(const driver& drv, const std::string& current_node,
+								 std::vector<int>& nodes) const override;
+	bool references_variables(const driver& drv, const std::string& current_node) const override;
 
 	expr_ptr expr;
 };
@@ -85,6 +114,11 @@ public:
 	literal_expression(float value);
 	float evaluate(const driver& drv) const override;
 	void generate_code(const driver& drv, const std::string& current_node, std::ostream& os) const override;
+	void generate_bytecode(const driver& drv, const std::string& current_node,
+						   bytecode_program& program) const override;
+	void collect_node_references(const driver& drv, const std::string& current_node,
+								 std::vector<int>& nodes) const override;
+	bool references_variables(const driver& drv, const std::string& current_node) const override;
 
 	float value;
 };
@@ -95,6 +129,11 @@ public:
 	identifier_expression(std::string name);
 	float evaluate(const driver& drv) const override;
 	void generate_code(const driver& drv, const std::string& current_node, std::ostream& os) const override;
+	void generate_bytecode(const driver& drv, const std::string& current_node,
+						   bytecode_program& program) const override;
+	void collect_node_references(const driver& drv, const std::string& current_node,
+								 std::vector<int>& nodes) const override;
+	bool references_variables(const driver& drv, const std::string& current_node) const override;
 
 	std::string name;
 };
@@ -105,6 +144,11 @@ public:
 	variable_expression(std::string name);
 	float evaluate(const driver& drv) const override;
 	void generate_code(const driver& drv, const std::string& current_node, std::ostream& os) const override;
+	void generate_bytecode(const driver& drv, const std::string& current_node,
+						   bytecode_program& program) const override;
+	void collect_node_references(const driver& drv, const std::string& current_node,
+								 std::vector<int>& nodes) const override;
+	bool references_variables(const driver& drv, const std::string& current_node) const override;
 
 	std::string name;
 };
@@ -115,6 +159,11 @@ public:
 	alias_expression(std::string name);
 	float evaluate(const driver& drv) const override;
 	void generate_code(const driver& drv, const std::string& current_node, std::ostream& os) const override;
+	void generate_bytecode(const driver& drv, const std::string& current_node,
+						   bytecode_program& program) const override;
+	void collect_node_references(const driver& drv, const std::string& current_node,
+								 std::vector<int>& nodes) const override;
+	bool references_variables(const driver& drv, const std::string& current_node) const override;
 
 	std::string name;
 };
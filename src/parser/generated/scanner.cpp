@@ -0,0 +1,80 @@
+// Hand-written stand-in for the flex scanner (validation harness only).
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include "../driver.h"
+#include "parser.h"
+
+static std::string g_buf;
+static size_t g_pos;
+
+void driver::scan_begin()
+{
+    std::ifstream f(file);
+    if (!f) { std::cerr << "cannot open " << file << "\n"; exit(EXIT_FAILURE); }
+    std::stringstream ss; ss << f.rdbuf(); g_buf = ss.str(); g_pos = 0;
+}
+void driver::scan_end() {}
+
+static bool ieq(const std::string& a, const char* b) { if (a.size()!=strlen(b)) return false; for (size_t i=0;i<a.size();i++) if (tolower(a[i])!=tolower(b[i])) return false; return true; }
+
+yy::parser::symbol_type yylex(driver& drv)
+{
+    yy::location& loc = drv.location;
+    loc.step();
+    if (drv.start == driver::start_type::cfg) { drv.start = driver::start_type::none; return yy::parser::make_CFG_START(loc); }
+    if (drv.start == driver::start_type::bnd) { drv.start = driver::start_type::none; return yy::parser::make_BND_START(loc); }
+    while (true) {
+        if (g_pos >= g_buf.size()) return yy::parser::make_YYEOF(loc);
+        char c = g_buf[g_pos];
+        if (c==' '||c=='\t'||c=='\r') { g_pos++; loc.columns(1); loc.step(); continue; }
+        if (c=='\n') { g_pos++; loc.lines(1); loc.step(); continue; }
+        if (c=='/' && g_pos+1<g_buf.size() && g_buf[g_pos+1]=='/') { while (g_pos<g_buf.size() && g_buf[g_pos]!='\n') g_pos++; loc.step(); continue; }
+        break;
+    }
+    char c = g_buf[g_pos];
+    auto two = g_buf.substr(g_pos, 2);
+    auto adv = [&](size_t n){ g_pos += n; loc.columns(n); };
+    if (two=="&&") { adv(2); return yy::parser::make_AND(loc);} if (two=="||") { adv(2); return yy::parser::make_OR(loc);} 
+    if (two=="==") { adv(2); return yy::parser::make_EQ(loc);} if (two=="!=") { adv(2); return yy::parser::make_NE(loc);} 
+    if (two=="<=") { adv(2); return yy::parser::make_LE(loc);} if (two==">=") { adv(2); return yy::parser::make_GE(loc);} 
+    switch (c) {
+        case '-': adv(1); return yy::parser::make_MINUS(loc); case '+': adv(1); return yy::parser::make_PLUS(loc);
+        case '*': adv(1); return yy::parser::make_STAR(loc); case '/': adv(1); return yy::parser::make_SLASH(loc);
+        case '(': adv(1); return yy::parser::make_LPAREN(loc); case ')': adv(1); return yy::parser::make_RPAREN(loc);
+        case '=': adv(1); return yy::parser::make_ASSIGN(loc); case '?': adv(1); return yy::parser::make_TERNARY(loc);
+        case ':': adv(1); return yy::parser::make_COLON(loc); case '&': adv(1); return yy::parser::make_AND(loc);
+        case '|': adv(1); return yy::parser::make_OR(loc); case '^': adv(1); return yy::parser::make_XOR(loc);
+        case '!': adv(1); return yy::parser::make_NOT(loc); case '<': adv(1); return yy::parser::make_LT(loc);
+        case '>': adv(1); return yy::parser::make_GT(loc); case '{': adv(1); return yy::parser::make_LBRACE(loc);
+        case '}': adv(1); return yy::parser::make_RBRACE(loc); case ';': adv(1); return yy::parser::make_SEMICOLON(loc);
+        default: break;
+    }
+    if (isdigit(c) || (c=='.' && g_pos+1<g_buf.size() && isdigit(g_buf[g_pos+1]))) {
+        size_t s = g_pos; bool fl=false;
+        while (g_pos<g_buf.size() && isdigit(g_buf[g_pos])) g_pos++;
+        if (g_pos<g_buf.size() && g_buf[g_pos]=='.') { fl=true; g_pos++; while (g_pos<g_buf.size() && isdigit(g_buf[g_pos])) g_pos++; }
+        if (g_pos<g_buf.size() && (g_buf[g_pos]=='e'||g_buf[g_pos]=='E')) { fl=true; g_pos++; if (g_buf[g_pos]=='-'||g_buf[g_pos]=='+') g_pos++; while (g_pos<g_buf.size() && isdigit(g_buf[g_pos])) g_pos++; }
+        std::string t = g_buf.substr(s, g_pos-s); loc.columns(t.size());
+        if (fl) return yy::parser::make_FLOAT((float)strtod(t.c_str(), nullptr), loc);
+        return yy::parser::make_NUMBER((int)strtol(t.c_str(), nullptr, 10), loc);
+    }
+    if (c=='.') { adv(1); return yy::parser::make_DOT(loc); }
+    if (isalpha(c) || c=='$' || c=='@') {
+        size_t s = g_pos; g_pos++;
+        while (g_pos<g_buf.size() && (isalnum(g_buf[g_pos])||g_buf[g_pos]=='_')) g_pos++;
+        std::string t = g_buf.substr(s, g_pos-s); loc.columns(t.size());
+        if (c=='$') return yy::parser::make_VARIABLE(t, loc);
+        if (c=='@') return yy::parser::make_ALIAS(t, loc);
+        if (ieq(t,"AND")) return yy::parser::make_AND(loc); if (ieq(t,"OR")) return yy::parser::make_OR(loc);
+        if (ieq(t,"XOR")) return yy::parser::make_XOR(loc); if (ieq(t,"NOT")) return yy::parser::make_NOT(loc);
+        if (ieq(t,"TRUE")) return yy::parser::make_NUMBER(1, loc); if (ieq(t,"FALSE")) return yy::parser::make_NUMBER(0, loc);
+        return yy::parser::make_IDENTIFIER(t, loc);
+    }
+    throw yy::parser::syntax_error(loc, std::string("invalid character: ") + c);
+}
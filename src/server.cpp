@@ -0,0 +1,442 @@
+#include "server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "lru_cache.h"
+#include "module_cache.h"
+#include "simulation_session.h"
+#include "timer.h"
+
+void fair_queue::push(int client, uint64_t job)
+{
+	auto& client_jobs = pending_[client];
+	if (client_jobs.empty())
+		rotation_.push_back(client);
+	client_jobs.push_back(job);
+}
+
+bool fair_queue::pop(uint64_t& job)
+{
+	if (rotation_.empty())
+		return false;
+
+	int client = rotation_.front();
+	rotation_.pop_front();
+
+	auto& client_jobs = pending_[client];
+	job = client_jobs.front();
+	client_jobs.pop_front();
+
+	// the client goes to the back of the line with its next job
+	if (client_jobs.empty())
+		pending_.erase(client);
+	else
+		rotation_.push_back(client);
+
+	return true;
+}
+
+void fair_queue::drop(int client)
+{
+	if (pending_.erase(client))
+		rotation_.erase(std::find(rotation_.begin(), rotation_.end(), client));
+}
+
+bool fair_queue::empty() const { return rotation_.empty(); }
+
+namespace {
+
+std::string read_file(const std::string& path)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs)
+		throw std::runtime_error("cannot open " + path);
+
+	std::ostringstream ss;
+	ss << ifs.rdbuf();
+	return ss.str();
+}
+
+// Client connection, the answers wait in output until the socket takes them
+struct connection
+{
+	int client = -1;
+	std::string input;
+	std::string output;
+	size_t sent = 0;
+
+	// Sends as much of the output as the socket takes without blocking, returns false if the connection is broken
+	bool flush(int fd)
+	{
+		while (sent < output.size())
+		{
+			auto n = send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+				return true;
+			if (n <= 0)
+				return false;
+			sent += n;
+		}
+
+		output.clear();
+		sent = 0;
+		return true;
+	}
+};
+
+// Answer lines must not be split by the messages
+std::string one_line(std::string message)
+{
+	std::replace(message.begin(), message.end(), '\n', ' ');
+	return message;
+}
+
+std::string format_results(const simulation_results& results)
+{
+	std::ostringstream os;
+
+	os << "final_states " << results.final_state_probs.size() << "\n";
+	for (size_t i = 0; i < results.final_state_probs.size(); i++)
+		os << results.final_state_probs[i] << "\t" << results.final_state_labels[i] << "\n";
+
+	os << "fixed_points " << results.fixed_point_probs.size() << "\n";
+	for (size_t i = 0; i < results.fixed_point_probs.size(); i++)
+		os << results.fixed_point_probs[i] << "\t" << results.fixed_point_labels[i] << "\n";
+
+	os << "probtraj " << results.probtraj.size() << "\n";
+	os << results.probtraj;
+
+	return os.str();
+}
+
+} // namespace
+
+simulation_server::simulation_server(std::string socket_path, int threads, size_t cache_capacity)
+	: socket_path_(std::move(socket_path)), cache_capacity_(cache_capacity), pool_(threads)
+{}
+
+int simulation_server::serve()
+{
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	if (socket_path_.size() >= sizeof(addr.sun_path))
+	{
+		std::cerr << "server> socket path too long: " << socket_path_ << std::endl;
+		return 1;
+	}
+	std::strcpy(addr.sun_path, socket_path_.c_str());
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	unlink(socket_path_.c_str());
+	if (fd == -1 || bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0)
+	{
+		std::cerr << "server> cannot listen on " << socket_path_ << ": " << std::strerror(errno) << std::endl;
+		if (fd != -1)
+			close(fd);
+		return 1;
+	}
+
+	int wake[2];
+	if (pipe(wake) != 0)
+	{
+		std::cerr << "server> cannot create a pipe: " << std::strerror(errno) << std::endl;
+		close(fd);
+		return 1;
+	}
+
+	{
+		std::lock_guard lock(mutex_);
+		wake_fd_ = wake[1];
+	}
+
+	std::thread scheduler([this] { schedule(); });
+
+	std::map<int, connection> connections;
+	int next_client = 0;
+
+	while (!stopping_)
+	{
+		std::vector<pollfd> fds = { { fd, POLLIN, 0 }, { wake[0], POLLIN, 0 } };
+		for (auto&& [client_fd, conn] : connections)
+			fds.push_back({ client_fd, (short)(POLLIN | (conn.output.empty() ? 0 : POLLOUT)), 0 });
+
+		if (poll(fds.data(), fds.size(), -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		if (fds[0].revents & POLLIN)
+		{
+			int client_fd = accept(fd, nullptr, nullptr);
+			if (client_fd != -1)
+			{
+				fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
+				connections[client_fd].client = next_client++;
+			}
+		}
+
+		for (size_t i = 2; i < fds.size(); i++)
+		{
+			if (!fds[i].revents)
+				continue;
+
+			auto& conn = connections[fds[i].fd];
+			bool open = !(fds[i].revents & (POLLERR | POLLNVAL));
+
+			if (open && (fds[i].revents & (POLLIN | POLLHUP)))
+			{
+				char chunk[4096];
+				auto n = recv(fds[i].fd, chunk, sizeof(chunk), 0);
+				open = n > 0 || (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK));
+				if (n > 0)
+					conn.input.append(chunk, n);
+			}
+
+			// answers the complete request lines
+			for (auto newline = conn.input.find('\n'); open && newline != std::string::npos;
+				 newline = conn.input.find('\n'))
+			{
+				std::string request = conn.input.substr(0, newline);
+				conn.input.erase(0, newline + 1);
+
+				std::string payload;
+				auto answer = handle_request(conn.client, request, payload);
+
+				conn.output += one_line(answer) + "\n" + payload;
+			}
+
+			if (open)
+				open = conn.flush(fds[i].fd);
+
+			if (!open)
+			{
+				drop_client(conn.client);
+				close(fds[i].fd);
+				connections.erase(fds[i].fd);
+			}
+		}
+	}
+
+	stop();
+	scheduler.join();
+
+	for (auto&& [client_fd, conn] : connections)
+		close(client_fd);
+
+	{
+		std::lock_guard lock(mutex_);
+		wake_fd_ = -1;
+	}
+
+	close(wake[0]);
+	close(wake[1]);
+	close(fd);
+	unlink(socket_path_.c_str());
+
+	return 0;
+}
+
+void simulation_server::stop()
+{
+	std::lock_guard lock(mutex_);
+
+	stopping_ = true;
+	if (wake_fd_ != -1)
+	{
+		char c = 0;
+		(void)!write(wake_fd_, &c, 1);
+	}
+
+	jobs_cv_.notify_all();
+}
+
+size_t simulation_server::compiled_models() const { return compiled_models_; }
+
+void simulation_server::schedule()
+{
+	// only this thread touches the sessions, they share the pool and run one after another
+	lru_cache<simulation_session> sessions(cache_capacity_);
+
+	while (true)
+	{
+		uint64_t id;
+		job params;
+		{
+			std::unique_lock lock(mutex_);
+			jobs_cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+
+			if (stopping_)
+				return;
+
+			queue_.pop(id);
+			auto& queued = jobs_.at(id);
+			queued.state = job_state::running;
+			params.bnd_path = queued.bnd_path;
+			params.cfg_path = queued.cfg_path;
+			params.backend = queued.backend;
+			params.sample_count = queued.sample_count;
+			params.seed = queued.seed;
+		}
+
+		timer_stats stats("server> job");
+
+		try
+		{
+			// the models are identified by their contents, so an edited file is parsed and compiled again
+			auto key = module_cache::make_key(
+				{ params.backend, read_file(params.bnd_path), read_file(params.cfg_path) });
+
+			auto session = sessions.find(key);
+			if (!session)
+			{
+				session = sessions.insert(key, std::make_unique<simulation_session>(
+												   params.bnd_path, params.cfg_path, params.backend, pool_));
+				compiled_models_++;
+			}
+
+			params.results = session->run(params.sample_count, params.seed);
+			params.state = job_state::done;
+		}
+		catch (const std::exception& e)
+		{
+			params.error = e.what();
+			params.state = job_state::failed;
+		}
+
+		// the client may have disconnected in the meantime
+		std::lock_guard lock(mutex_);
+		auto finished = jobs_.find(id);
+		if (finished == jobs_.end())
+			continue;
+
+		finished->second.state = params.state;
+		finished->second.error = std::move(params.error);
+		finished->second.results = std::move(params.results);
+	}
+}
+
+void simulation_server::drop_client(int client)
+{
+	std::lock_guard lock(mutex_);
+
+	queue_.drop(client);
+	for (auto it = jobs_.begin(); it != jobs_.end();)
+		it = it->second.client == client ? jobs_.erase(it) : std::next(it);
+}
+
+std::string simulation_server::handle_request(int client, const std::string& request, std::string& payload)
+{
+	std::istringstream tokens(request);
+	std::string command;
+	tokens >> command;
+
+	if (command == "submit")
+	{
+		job submitted;
+		submitted.client = client;
+		if (!(tokens >> submitted.bnd_path >> submitted.cfg_path))
+			return "error submit needs the bnd and cfg files";
+
+		submitted.backend = "host";
+
+		for (std::string option; tokens >> option;)
+		{
+			auto eq = option.find('=');
+			auto name = option.substr(0, eq);
+			auto value = eq == std::string::npos ? "" : option.substr(eq + 1);
+
+			try
+			{
+				if (name == "backend" && (value == "host" || value == "interpreter"))
+					submitted.backend = value;
+				else if (name == "sample_count" && std::stoi(value) > 0)
+					submitted.sample_count = std::stoi(value);
+				else if (name == "seed")
+					submitted.seed = std::stoull(value);
+				else
+					return "error invalid option " + option;
+			}
+			catch (const std::exception&)
+			{
+				return "error invalid option " + option;
+			}
+		}
+
+		std::lock_guard lock(mutex_);
+		uint64_t id = next_job_++;
+		jobs_.emplace(id, std::move(submitted));
+		queue_.push(client, id);
+		jobs_cv_.notify_one();
+
+		return "ok " + std::to_string(id);
+	}
+
+	if (command != "poll" && command != "fetch")
+		return "error unknown request " + command;
+
+	uint64_t id;
+	if (!(tokens >> id))
+		return "error " + command + " needs a job";
+
+	simulation_results results;
+	{
+		std::lock_guard lock(mutex_);
+
+		auto it = jobs_.find(id);
+		if (it == jobs_.end())
+			return "error unknown job " + std::to_string(id);
+
+		auto& found = it->second;
+
+		if (command == "poll")
+		{
+			switch (found.state)
+			{
+				case job_state::queued:
+					return "queued";
+				case job_state::running:
+					return "running";
+				case job_state::done:
+					return "done";
+				case job_state::failed:
+					return "failed " + found.error;
+			}
+		}
+
+		if (found.state == job_state::queued || found.state == job_state::running)
+			return "error job " + std::to_string(id) + " is not finished";
+
+		if (found.state == job_state::failed)
+		{
+			auto error = std::move(found.error);
+			jobs_.erase(it);
+			return "failed " + error;
+		}
+
+		results = std::move(found.results);
+		jobs_.erase(it);
+	}
+
+	payload = format_results(results);
+
+	return "ok";
+}
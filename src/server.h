@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "host/thread_pool.h"
+#include "statistics/results.h"
+
+// Round-robin queue of the jobs of several clients, so a client with many pending jobs does not hold up the others
+class fair_queue
+{
+	std::map<int, std::deque<uint64_t>> pending_;
+	// clients with pending jobs in the order they are served
+	std::deque<int> rotation_;
+
+public:
+	void push(int client, uint64_t job);
+
+	// Takes the next job, returns false if there is none
+	bool pop(uint64_t& job);
+
+	// Forgets the pending jobs of the client
+	void drop(int client);
+
+	bool empty() const;
+};
+
+// Daemon simulating the models submitted over a Unix domain socket. Each request is one line answered by one line:
+//   submit <bnd> <cfg> [backend=host|interpreter] [sample_count=n] [seed=n]    ok <job>
+//   poll <job>                                                                 queued | running | done | failed <why>
+//   fetch <job>                                                                ok, followed by the results
+// and malformed requests are answered by "error <why>". The fetched results are the final states and the fixed
+// points as "final_states <n>" and "fixed_points <n>" headers followed by n "probability\tstate" lines, then
+// "probtraj <bytes>" followed by the window averages in the binary _probtraj form; the job is forgotten afterwards,
+// and so are all the jobs of a client that disconnects. The requests are served by one thread on non-blocking
+// sockets, so a client slow to read its answers does not hold up the others, while the jobs run one at a time on the
+// whole thread pool, taking the clients in turn. The parsed and compiled models of the recent jobs are kept in an LRU
+// cache.
+class simulation_server
+{
+	enum class job_state
+	{
+		queued,
+		running,
+		done,
+		failed
+	};
+
+	struct job
+	{
+		int client = -1;
+		std::string bnd_path, cfg_path, backend;
+		std::optional<int> sample_count;
+		std::optional<unsigned long long> seed;
+
+		job_state state = job_state::queued;
+		std::string error;
+		simulation_results results;
+	};
+
+	std::string socket_path_;
+	size_t cache_capacity_;
+	thread_pool pool_;
+
+	std::atomic<bool> stopping_ = false;
+	// write end of the pipe waking up the serving loop
+	int wake_fd_ = -1;
+
+	std::mutex mutex_;
+	std::condition_variable jobs_cv_;
+	std::unordered_map<uint64_t, job> jobs_;
+	fair_queue queue_;
+	uint64_t next_job_ = 1;
+	std::atomic<size_t> compiled_models_ = 0;
+
+	void schedule();
+	std::string handle_request(int client, const std::string& request, std::string& payload);
+
+	// Forgets the jobs of a disconnected client, the running one is dropped once it finishes
+	void drop_client(int client);
+
+public:
+	simulation_server(std::string socket_path, int threads, size_t cache_capacity);
+
+	simulation_server(const simulation_server&) = delete;
+	simulation_server& operator=(const simulation_server&) = delete;
+
+	// Serves the requests until stop is called, returns 1 if the socket cannot be listened on
+	int serve();
+
+	// Makes serve return after the running job finishes, the queued jobs are dropped
+	void stop();
+
+	// Number of models parsed and compiled so far, the others came from the cache
+	size_t compiled_models() const;
+};
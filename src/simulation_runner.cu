@@ -40,15 +40,32 @@ private:
 };
 
 simulation_runner::simulation_runner(int n_trajectories, int state_size, unsigned long long seed,
-									 std::vector<float> inital_probs)
+									 std::vector<float> inital_probs, unsigned long long first_trajectory)
 	: n_trajectories_(n_trajectories),
 	  state_size_(state_size),
 	  state_words_(DIV_UP(state_size, 32)),
 	  seed_(seed),
+	  first_trajectory_(first_trajectory),
 	  inital_probs_(std::move(inital_probs))
 {
 	trajectory_batch_limit = std::min(1'000'000, n_trajectories);
-	trajectory_len_limit = 100; // TODO compute limit according to the available mem
+	trajectory_len_limit = 100;
+}
+
+void simulation_runner::fit_memory_budget(size_t memory_budget)
+{
+	constexpr size_t min_slots = 1 << 16;
+
+	size_t slot_bytes = state_words_ * sizeof(state_word_t) + sizeof(float) + sizeof(curandState)
+						+ sizeof(trajectory_status);
+	size_t step_bytes = state_words_ * sizeof(state_word_t) + 2 * sizeof(float);
+
+	// the trajectories are shortened only when the budget does not fit enough slots to occupy the device
+	size_t max_len = memory_budget / min_slots > slot_bytes ? (memory_budget / min_slots - slot_bytes) / step_bytes : 0;
+	trajectory_len_limit = std::clamp<size_t>(max_len, 2, 100);
+
+	size_t slots = memory_budget / (slot_bytes + trajectory_len_limit * step_bytes);
+	trajectory_batch_limit = std::clamp<size_t>(slots, 1, n_trajectories_);
 }
 
 void simulation_runner::run_simulation(stats_composite& stats_runner, kernel_wrapper& initialize_random,
@@ -89,7 +106,7 @@ void simulation_runner::run_simulation(stats_composite& stats_runner, kernel_wra
 							  cudaMemcpyHostToDevice));
 
 		initialize_random.run(dim3(DIV_UP(trajectory_batch_limit, 256)), dim3(256), trajectory_batch_limit, seed_,
-							  d_rands.get());
+							  first_trajectory_, d_rands.get());
 
 		initialize_initial_state.run(dim3(DIV_UP(trajectory_batch_limit, 256)), dim3(256), trajectory_batch_limit,
 									 state_size_, d_initial_probs.get(), d_last_states.get(), d_last_times.get(),
@@ -116,8 +133,8 @@ void simulation_runner::run_simulation(stats_composite& stats_runner, kernel_wra
 			timer_stats stats("simulation_runner> stats");
 
 			// compute statistics over the simulated trajs
-			stats_runner.process_batch(d_traj_states, d_traj_times, d_traj_tr_entropies, d_last_states, d_traj_statuses,
-									   trajectories_in_batch);
+			stats_runner.process_batch({ d_traj_states.get(), d_traj_times.get(), d_traj_tr_entropies.get(),
+										 d_last_states.get(), d_traj_statuses.get(), trajectories_in_batch });
 		}
 
 		// prepare for the next iteration
@@ -161,10 +178,7 @@ void simulation_runner::run_simulation(stats_composite& stats_runner, kernel_wra
 			CUDA_CHECK(cudaMemset(d_traj_times.get(), 0, trajectories_in_batch * trajectory_len_limit * sizeof(float)));
 		}
 
-		if (timer_stats::enable_diags())
-		{
-			std::cerr << "simulation_runner> remaining trajs: " << remaining_trajs << std::endl;
-		}
+		timer_stats::counter("simulation_runner> remaining trajs", remaining_trajs);
 	}
 
 	timer_stats stats("simulation_runner> deallocate");
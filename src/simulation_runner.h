@@ -11,13 +11,21 @@ class simulation_runner
 	int state_size_;
 	int state_words_;
 	unsigned long long seed_;
+	unsigned long long first_trajectory_;
 	std::vector<float> inital_probs_;
 
 public:
 	int trajectory_len_limit;
 	int trajectory_batch_limit;
 
-	simulation_runner(int n_trajectories, int state_size, unsigned long long seed, std::vector<float> inital_probs);
+	// The batch slots draw from the curand subsequences starting at first_trajectory
+	simulation_runner(int n_trajectories, int state_size, unsigned long long seed, std::vector<float> inital_probs,
+					  unsigned long long first_trajectory = 0);
+
+	// Sizes the batch slots so that the trajectory buffers on the device take at most memory_budget bytes, the
+	// trajectories are split into shorter parts only when the budget is small. It must be called before the stats are
+	// created from trajectory_len_limit.
+	void fit_memory_budget(size_t memory_budget);
 
 	void run_simulation(stats_composite& stats_runner, kernel_wrapper& initialize_random,
 						kernel_wrapper& initialize_initial_state, kernel_wrapper& simulate);
@@ -0,0 +1,132 @@
+#include "simulation_session.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "generator.h"
+#include "host/host_simulation_runner.h"
+#include "statistics/host/host_stats.h"
+#include "statistics/stats_composite.h"
+#include "timer.h"
+
+state_t create_noninternals_mask(driver& drv)
+{
+	state_t mask(drv.nodes.size());
+	for (size_t i = 0; i < drv.nodes.size(); ++i)
+	{
+		if (!drv.nodes[i].is_internal(drv))
+			mask.set(i);
+	}
+
+	return mask;
+}
+
+std::vector<float> create_initial_probs(driver& drv)
+{
+	std::vector<float> initial_probs;
+	for (auto&& node : drv.nodes)
+	{
+		initial_probs.push_back(node.istate);
+	}
+
+	return initial_probs;
+}
+
+simulation_session::simulation_session(const std::string& bnd_path, const std::string& cfg_path,
+									   const std::string& backend, int threads, bool rate_tree)
+	: own_pool_(std::make_unique<thread_pool>(threads)), pool_(*own_pool_), rate_tree_(rate_tree), noninternals_mask_(0)
+{
+	load(bnd_path, cfg_path, backend);
+}
+
+simulation_session::simulation_session(const std::string& bnd_path, const std::string& cfg_path,
+									   const std::string& backend, thread_pool& pool, bool rate_tree)
+	: pool_(pool), rate_tree_(rate_tree), noninternals_mask_(0)
+{
+	load(bnd_path, cfg_path, backend);
+}
+
+void simulation_session::load(const std::string& bnd_path, const std::string& cfg_path, const std::string& backend)
+{
+	if (backend != "host" && backend != "interpreter")
+		throw std::runtime_error("unsupported backend " + backend);
+
+	// the scanner exits the process on a missing file
+	for (auto&& path : { bnd_path, cfg_path })
+		if (!std::ifstream(path))
+			throw std::runtime_error("cannot open " + path);
+
+	{
+		timer_stats stats("simulation_session> parse");
+
+		if (drv_.parse(bnd_path, cfg_path))
+			throw std::runtime_error("cannot parse " + bnd_path + " and " + cfg_path);
+	}
+
+	// the constants missing from the cfg file are 0
+	auto constant = [&](const char* name) {
+		auto it = drv_.constants.find(name);
+		return it == drv_.constants.end() ? 0.f : it->second;
+	};
+
+	discrete_time_ = constant("discrete_time") != 0;
+	max_time_ = constant("max_time");
+	time_tick_ = constant("time_tick");
+	sample_count_ = constant("sample_count");
+	seed_ = constant("seed_pseudorandom");
+
+	for (auto&& node : drv_.nodes)
+		node_names_.push_back(node.name);
+
+	noninternals_mask_ = create_noninternals_mask(drv_);
+	noninternals_count_ =
+		std::count_if(drv_.nodes.begin(), drv_.nodes.end(), [&](const auto& node) { return !node.is_internal(drv_); });
+
+	if (noninternals_count_ > max_noninternals)
+		throw std::runtime_error("at most " + std::to_string(max_noninternals) + " non-internal nodes are supported");
+
+	timer_stats stats("simulation_session> compilation");
+
+	if (backend == "interpreter")
+		interpreter_.emplace(drv_);
+	else if (compiler_.compile_simulation(generator(drv_, code_target::host).generate_code()))
+		throw std::runtime_error("cannot compile the simulation of " + bnd_path);
+}
+
+const host_model& simulation_session::model() const
+{
+	if (interpreter_)
+		return *interpreter_;
+	return compiler_.functions;
+}
+
+const std::vector<std::string>& simulation_session::node_names() const { return node_names_; }
+
+simulation_results simulation_session::run(std::optional<int> sample_count, std::optional<unsigned long long> seed,
+											bool window_errors)
+{
+	int n_trajectories = sample_count.value_or(sample_count_);
+	if (n_trajectories <= 0)
+		throw std::runtime_error("the sample count has to be positive");
+
+	// the thread pool runs one job at a time
+	std::lock_guard lock(run_mutex_);
+
+	timer_stats stats("simulation_session> run");
+
+	host_simulation_runner r(n_trajectories, drv_.nodes.size(), seed.value_or(seed_), create_initial_probs(drv_),
+							 max_time_, time_tick_, discrete_time_, pool_, rate_tree_);
+
+	stats_composite stats_runner;
+	add_host_stats(stats_runner, discrete_time_, max_time_, time_tick_, noninternals_mask_, noninternals_count_,
+				   r.trajectory_len_limit, model(), pool_, window_errors);
+
+	r.run_simulation(stats_runner, model());
+	stats_runner.finalize();
+
+	simulation_results results;
+	stats_runner.export_results(n_trajectories, node_names_, results);
+
+	return results;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "host/bytecode_model.h"
+#include "host/host_compiler.h"
+#include "host/thread_pool.h"
+#include "parser/driver.h"
+#include "state.h"
+#include "statistics/results.h"
+
+// Mask of the nodes whose states are reported
+state_t create_noninternals_mask(driver& drv);
+
+// Probabilities of the nodes to be set in the initial state
+std::vector<float> create_initial_probs(driver& drv);
+
+// Model parsed and compiled once and simulated on the host any number of times, e.g. from one Python session
+class simulation_session
+{
+	driver drv_;
+	std::unique_ptr<thread_pool> own_pool_;
+	thread_pool& pool_;
+	host_compiler compiler_;
+	std::optional<bytecode_model> interpreter_;
+	bool rate_tree_;
+
+	std::vector<std::string> node_names_;
+	state_t noninternals_mask_;
+	int noninternals_count_;
+
+	// the constants of the cfg file are read once, the runs do not touch the driver
+	bool discrete_time_;
+	float max_time_;
+	float time_tick_;
+	int sample_count_;
+	unsigned long long seed_;
+
+	// the runs share the pool and the compiled model, the concurrent ones wait for each other
+	std::mutex run_mutex_;
+
+	void load(const std::string& bnd_path, const std::string& cfg_path, const std::string& backend);
+
+	const host_model& model() const;
+
+public:
+	// The backend is host or interpreter, throws std::runtime_error if the model cannot be loaded
+	simulation_session(const std::string& bnd_path, const std::string& cfg_path, const std::string& backend = "host",
+					   int threads = thread_pool::default_threads_count(), bool rate_tree = false);
+
+	// Runs the simulations on a pool shared with other sessions, which must not run at the same time
+	simulation_session(const std::string& bnd_path, const std::string& cfg_path, const std::string& backend,
+					   thread_pool& pool, bool rate_tree = false);
+
+	simulation_session(const simulation_session&) = delete;
+	simulation_session& operator=(const simulation_session&) = delete;
+
+	const std::vector<std::string>& node_names() const;
+
+	// Simulates the model, the sample count and the seed default to the values of the cfg file. The standard errors of
+	// the window averages are estimated with window_errors. Throws std::runtime_error if the sample count is not
+	// positive. The runs of one session may be called from several threads, they run one after another.
+	simulation_results run(std::optional<int> sample_count = std::nullopt,
+						   std::optional<unsigned long long> seed = std::nullopt, bool window_errors = false);
+};
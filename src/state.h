@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -48,3 +49,24 @@ struct static_state_t
 		return false;
 	}
 };
+
+// Marks the state widths without a static_state_t specialization, which are stored in dynamic_state_t instead
+constexpr int dynamic_state_words = 0;
+
+// Runtime sized counterpart of static_state_t with the same ordering
+struct dynamic_state_t
+{
+	std::vector<state_word_t> data;
+
+	dynamic_state_t(const state_word_t* state, int state_words) : data(state, state + state_words) {}
+
+	bool operator==(const dynamic_state_t& other) const { return data == other.data; }
+
+	bool operator<(const dynamic_state_t& other) const
+	{
+		for (int i = (int)data.size() - 1; i >= 0; i--)
+			if (data[i] != other.data[i])
+				return data[i] < other.data[i];
+		return false;
+	}
+};
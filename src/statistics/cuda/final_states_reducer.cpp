@@ -0,0 +1,39 @@
+#include "final_states_reducer.h"
+
+#include <thrust/device_free.h>
+#include <thrust/device_malloc.h>
+
+#include "../../timer.h"
+
+final_states_cuda_reducer::final_states_cuda_reducer(int noninternals, int state_words, kernel_wrapper& final_states)
+	: noninternal_states_count_(1 << noninternals), state_words_(state_words), final_states_(final_states)
+{
+	timer_stats stats("final_states_stats> initialize");
+
+	occurences_ = thrust::device_malloc<int>(noninternal_states_count_);
+}
+
+final_states_cuda_reducer::~final_states_cuda_reducer()
+{
+	timer_stats stats("final_states_stats> free");
+
+	thrust::device_free(occurences_);
+}
+
+void final_states_cuda_reducer::process_batch(const trajectory_batch& batch)
+{
+	timer_stats stats("final_states_stats> process_batch");
+
+	final_states_.run(DIV_UP(batch.n_trajectories, 256), 256, batch.n_trajectories, state_words_, batch.last_states,
+					  batch.traj_statuses, occurences_.get());
+}
+
+void final_states_cuda_reducer::finalize(sparse_histogram<int>& occurences)
+{
+	std::vector<int> dense_occurences(noninternal_states_count_);
+
+	CUDA_CHECK(cudaMemcpy(dense_occurences.data(), occurences_.get(), noninternal_states_count_ * sizeof(int),
+						  cudaMemcpyDeviceToHost));
+
+	append_nonzero(dense_occurences.data(), noninternal_states_count_, occurences);
+}
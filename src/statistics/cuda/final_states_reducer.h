@@ -0,0 +1,25 @@
+#pragma once
+
+#include <thrust/device_ptr.h>
+
+#include "../../kernel.h"
+#include "../final_states.h"
+
+// Accumulates the final states in the device memory using the final_states kernel
+class final_states_cuda_reducer : public final_states_reducer
+{
+	thrust::device_ptr<int> occurences_;
+
+	int noninternal_states_count_;
+	int state_words_;
+
+	kernel_wrapper& final_states_;
+
+public:
+	final_states_cuda_reducer(int noninternals, int state_words, kernel_wrapper& final_states);
+	~final_states_cuda_reducer();
+
+	void process_batch(const trajectory_batch& batch) override;
+
+	void finalize(sparse_histogram<int>& occurences) override;
+};
@@ -0,0 +1,201 @@
+#include "fixed_states_reducer.h"
+
+#include <algorithm>
+
+#include <cub/device/device_merge_sort.cuh>
+#include <cub/device/device_run_length_encode.cuh>
+#include <cub/device/device_select.cuh>
+#include <cub/iterator/transform_input_iterator.cuh>
+
+#include "../../timer.h"
+#include "../../utils.h"
+#include "../fixed_states.h"
+
+struct select_ftor
+{
+	__device__ __forceinline__ bool operator()(trajectory_status t) const
+	{
+		return t == trajectory_status::FIXED_POINT;
+	}
+};
+
+template <int state_words>
+struct compare_ftor
+{
+	__device__ __forceinline__ bool operator()(const static_state_t<state_words>& lhs,
+											   const static_state_t<state_words>& rhs) const
+	{
+		for (int i = state_words - 1; i >= 0; i--)
+			if (lhs.data[i] != rhs.data[i])
+				return lhs.data[i] < rhs.data[i];
+		return false;
+	}
+};
+
+template <int state_words>
+class fixed_states_cuda_reducer : public fixed_states_reducer<state_words>
+{
+	using result_t = typename fixed_states_reducer<state_words>::result_t;
+
+	// the unique fixed points of the batches are counted on the host, they are sorted only in finalize
+	fixed_points_table table_;
+
+	size_t tmp_storage_bytes_ = 0;
+	void* d_tmp_storage_ = nullptr;
+	int* d_out_num;
+	static_state_t<state_words>* d_fixed_copy_ = nullptr;
+	static_state_t<state_words>* d_unique_states_ = nullptr;
+	int* d_unique_states_count_ = nullptr;
+
+	void initialize_temp_storage(static_state_t<state_words>* last_states, trajectory_status* traj_statuses,
+								 int n_trajectories);
+
+public:
+	fixed_states_cuda_reducer(int) : table_(state_words) {}
+	~fixed_states_cuda_reducer();
+
+	void process_batch(const trajectory_batch& batch) override;
+
+	void finalize(result_t& result) override;
+};
+
+template <int state_words>
+fixed_states_cuda_reducer<state_words>::~fixed_states_cuda_reducer()
+{
+	if (d_tmp_storage_ == nullptr)
+		return;
+
+	CUDA_CHECK(cudaFree(d_tmp_storage_));
+	CUDA_CHECK(cudaFree(d_out_num));
+	CUDA_CHECK(cudaFree(d_fixed_copy_));
+	CUDA_CHECK(cudaFree(d_unique_states_));
+	CUDA_CHECK(cudaFree(d_unique_states_count_));
+}
+
+template <int state_words>
+void fixed_states_cuda_reducer<state_words>::initialize_temp_storage(static_state_t<state_words>* last_states,
+																	 trajectory_status* traj_statuses,
+																	 int n_trajectories)
+{
+	if (d_tmp_storage_ != nullptr)
+	{
+		return;
+	}
+
+	timer_stats stats("fixed_states_stats> initialize");
+
+	size_t temp_storage_bytes_if = 0;
+	cub::DeviceSelect::Flagged(
+		d_tmp_storage_, tmp_storage_bytes_, last_states,
+		cub::TransformInputIterator<bool, select_ftor, trajectory_status*>(traj_statuses, select_ftor()),
+		d_fixed_copy_, d_out_num, n_trajectories);
+
+	std::size_t temp_storage_bytes_sort = 0;
+	cub::DeviceMergeSort::SortKeys(d_tmp_storage_, temp_storage_bytes_sort, d_fixed_copy_, n_trajectories,
+								   compare_ftor<state_words>());
+
+	size_t temp_storage_bytes_encode = 0;
+	cub::DeviceRunLengthEncode::Encode(d_tmp_storage_, tmp_storage_bytes_, d_fixed_copy_, d_unique_states_,
+									   d_unique_states_count_, d_out_num, n_trajectories);
+
+	tmp_storage_bytes_ = std::max(std::max(temp_storage_bytes_if, temp_storage_bytes_encode), temp_storage_bytes_sort);
+
+	CUDA_CHECK(cudaMalloc(&d_tmp_storage_, tmp_storage_bytes_));
+	CUDA_CHECK(cudaMalloc(&d_out_num, sizeof(int)));
+	CUDA_CHECK(cudaMalloc(&d_fixed_copy_, n_trajectories * sizeof(static_state_t<state_words>)));
+	CUDA_CHECK(cudaMalloc(&d_unique_states_, n_trajectories * sizeof(static_state_t<state_words>)));
+	CUDA_CHECK(cudaMalloc(&d_unique_states_count_, n_trajectories * sizeof(int)));
+}
+
+template <int state_words>
+void fixed_states_cuda_reducer<state_words>::process_batch(const trajectory_batch& batch)
+{
+	auto last_states = (static_state_t<state_words>*)batch.last_states;
+	int n_trajectories = batch.n_trajectories;
+
+	initialize_temp_storage(last_states, batch.traj_statuses, n_trajectories);
+
+	timer_stats stats("fixed_states_stats> process_batch");
+
+	cub::DeviceSelect::Flagged(
+		d_tmp_storage_, tmp_storage_bytes_, last_states,
+		cub::TransformInputIterator<bool, select_ftor, trajectory_status*>(batch.traj_statuses, select_ftor()),
+		d_fixed_copy_, d_out_num, n_trajectories);
+
+	int fixed_count = 0;
+	CUDA_CHECK(cudaMemcpy(&fixed_count, d_out_num, sizeof(int), cudaMemcpyDeviceToHost));
+
+	cub::DeviceMergeSort::SortKeys(d_tmp_storage_, tmp_storage_bytes_, d_fixed_copy_, fixed_count,
+								   compare_ftor<state_words>());
+
+	cub::DeviceRunLengthEncode::Encode(d_tmp_storage_, tmp_storage_bytes_, d_fixed_copy_, d_unique_states_,
+									   d_unique_states_count_, d_out_num, fixed_count);
+
+	int unique_fixed_points_size = 0;
+	CUDA_CHECK(cudaMemcpy(&unique_fixed_points_size, d_out_num, sizeof(int), cudaMemcpyDeviceToHost));
+
+	std::vector<static_state_t<state_words>> h_unique_fixed_points(unique_fixed_points_size);
+	std::vector<int> h_unique_fixed_points_count(unique_fixed_points_size);
+
+	CUDA_CHECK(cudaMemcpy(h_unique_fixed_points.data(), d_unique_states_,
+						  unique_fixed_points_size * sizeof(static_state_t<state_words>), cudaMemcpyDeviceToHost));
+	CUDA_CHECK(cudaMemcpy(h_unique_fixed_points_count.data(), d_unique_states_count_,
+						  unique_fixed_points_size * sizeof(int), cudaMemcpyDeviceToHost));
+
+	table_.reserve(unique_fixed_points_size);
+	for (int i = 0; i < unique_fixed_points_size; i++)
+		table_.insert(h_unique_fixed_points[i].data, h_unique_fixed_points_count[i]);
+}
+
+template <int state_words>
+void fixed_states_cuda_reducer<state_words>::finalize(result_t& result)
+{
+	add_fixed_points<state_words>(table_, result);
+}
+
+// The states wider than MAX_WORDS have no fixed size type to sort on the device, so the last states of a batch
+// reaching a fixed point are copied and accumulated on the host
+template <>
+class fixed_states_cuda_reducer<dynamic_state_words> : public fixed_states_reducer<dynamic_state_words>
+{
+	fixed_points_table table_;
+
+	int state_words_;
+
+	std::vector<trajectory_status> h_traj_statuses_;
+	std::vector<state_word_t> h_last_states_;
+
+public:
+	fixed_states_cuda_reducer(int state_words) : table_(state_words), state_words_(state_words) {}
+
+	void process_batch(const trajectory_batch& batch) override
+	{
+		timer_stats stats("fixed_states_stats> process_batch");
+
+		int n_trajectories = batch.n_trajectories;
+
+		h_traj_statuses_.resize(n_trajectories);
+		CUDA_CHECK(cudaMemcpy(h_traj_statuses_.data(), batch.traj_statuses,
+							  n_trajectories * sizeof(trajectory_status), cudaMemcpyDeviceToHost));
+
+		int fixed_count = std::count(h_traj_statuses_.begin(), h_traj_statuses_.end(), trajectory_status::FIXED_POINT);
+		if (fixed_count == 0)
+			return;
+
+		h_last_states_.resize((size_t)n_trajectories * state_words_);
+		CUDA_CHECK(cudaMemcpy(h_last_states_.data(), batch.last_states,
+							  h_last_states_.size() * sizeof(state_word_t), cudaMemcpyDeviceToHost));
+
+		table_.reserve(fixed_count);
+		for (int i = 0; i < n_trajectories; i++)
+			if (h_traj_statuses_[i] == trajectory_status::FIXED_POINT)
+				table_.insert(h_last_states_.data() + (size_t)i * state_words_);
+	}
+
+	void finalize(result_t& result) override { add_fixed_points<dynamic_state_words>(table_, result); }
+};
+
+void add_fixed_states_stats_cuda(stats_composite& stats_runner, int state_words)
+{
+	fixed_states_stats_builder::add_fixed_states_stats<fixed_states_cuda_reducer>(stats_runner, state_words);
+}
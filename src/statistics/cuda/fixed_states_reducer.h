@@ -0,0 +1,6 @@
+#pragma once
+
+#include "../stats_composite.h"
+
+// Adds fixed_states_stats accumulating the fixed points in the device memory using cub
+void add_fixed_states_stats_cuda(stats_composite& stats_runner, int state_words);
@@ -0,0 +1,105 @@
+#include "window_average_small_reducer.h"
+
+#include <cassert>
+#include <cmath>
+
+#include <thrust/device_free.h>
+#include <thrust/device_malloc.h>
+
+#include "../../timer.h"
+
+window_average_small_cuda_reducer::window_average_small_cuda_reducer(float window_size, float max_time,
+																	 bool discrete_time, size_t non_internals,
+																	 int state_words, size_t max_traj_len,
+																	 kernel_wrapper& window_average_small)
+	: window_size_(window_size),
+	  max_time_(max_time),
+	  discrete_time_(discrete_time),
+	  noninternal_states_count_(1 << non_internals),
+	  state_words_(state_words),
+	  max_traj_len_(max_traj_len),
+	  window_average_small_(window_average_small)
+{
+	timer_stats stats("window_average_small> initialize");
+
+	size_t windows_count = std::ceil(max_time / window_size);
+
+	window_tr_entropies_ = thrust::device_malloc<float>(windows_count);
+	CUDA_CHECK(cudaMemset(window_tr_entropies_.get(), 0, windows_count * sizeof(float)));
+
+	if (discrete_time)
+	{
+		window_probs_discrete_ = thrust::device_malloc<int>(windows_count * noninternal_states_count_);
+		CUDA_CHECK(
+			cudaMemset(window_probs_discrete_.get(), 0, windows_count * noninternal_states_count_ * sizeof(int)));
+	}
+	else
+	{
+		window_probs_ = thrust::device_malloc<float>(windows_count * noninternal_states_count_);
+		CUDA_CHECK(cudaMemset(window_probs_.get(), 0, windows_count * noninternal_states_count_ * sizeof(float)));
+	}
+}
+
+window_average_small_cuda_reducer::~window_average_small_cuda_reducer()
+{
+	timer_stats stats("window_average_small> free");
+
+	thrust::device_free(window_probs_);
+	thrust::device_free(window_probs_discrete_);
+	thrust::device_free(window_tr_entropies_);
+}
+
+void window_average_small_cuda_reducer::process_batch(const trajectory_batch& batch)
+{
+	timer_stats stats("window_average_small> process_batch");
+
+	int windows_count = std::ceil(max_time_ / window_size_);
+	int shared_mem_size = sizeof(float) * windows_count;
+
+	bool extra_shared_mem = false;
+
+	assert(sizeof(float) == sizeof(int));
+
+	if (shared_mem_size + sizeof(float) * noninternal_states_count_ * windows_count < 10 * 1024)
+	{
+		shared_mem_size += sizeof(float) * noninternal_states_count_ * windows_count;
+		extra_shared_mem = true;
+	}
+
+	window_average_small_.run_shared(
+		dim3(DIV_UP(batch.n_trajectories * (max_traj_len_ - 1), 256)), dim3(256), shared_mem_size, max_traj_len_,
+		batch.n_trajectories, state_words_, noninternal_states_count_, window_size_, windows_count, extra_shared_mem,
+		batch.traj_states, batch.traj_times, batch.traj_tr_entropies,
+		discrete_time_ ? (void*)window_probs_discrete_.get() : (void*)window_probs_.get(), window_tr_entropies_.get());
+}
+
+void window_average_small_cuda_reducer::finalize(std::vector<sparse_histogram<float>>& probs,
+												 std::vector<sparse_histogram<int>>& probs_discrete,
+												 std::vector<float>& tr_entropies)
+{
+	size_t windows_count = std::ceil(max_time_ / window_size_);
+	size_t cells = windows_count * noninternal_states_count_;
+
+	// copy result data into host
+	if (discrete_time_)
+	{
+		std::vector<int> dense_probs_discrete(cells);
+		CUDA_CHECK(cudaMemcpy(dense_probs_discrete.data(), window_probs_discrete_.get(), cells * sizeof(int),
+							  cudaMemcpyDeviceToHost));
+
+		for (size_t i = 0; i < windows_count; i++)
+			append_nonzero(dense_probs_discrete.data() + i * noninternal_states_count_, noninternal_states_count_,
+						   probs_discrete[i]);
+	}
+	else
+	{
+		std::vector<float> dense_probs(cells);
+		CUDA_CHECK(
+			cudaMemcpy(dense_probs.data(), window_probs_.get(), cells * sizeof(float), cudaMemcpyDeviceToHost));
+
+		for (size_t i = 0; i < windows_count; i++)
+			append_nonzero(dense_probs.data() + i * noninternal_states_count_, noninternal_states_count_, probs[i]);
+	}
+	CUDA_CHECK(cudaMemcpy(tr_entropies.data(), window_tr_entropies_.get(), windows_count * sizeof(float),
+						  cudaMemcpyDeviceToHost));
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <thrust/device_ptr.h>
+
+#include "../../kernel.h"
+#include "../window_average_small.h"
+
+// Accumulates the window averages in the device memory using the window_average_small kernels
+class window_average_small_cuda_reducer : public window_average_small_reducer
+{
+	float window_size_;
+	float max_time_;
+	bool discrete_time_;
+	uint32_t noninternal_states_count_;
+	int state_words_;
+
+	size_t max_traj_len_;
+
+	kernel_wrapper& window_average_small_;
+
+	thrust::device_ptr<float> window_probs_, window_tr_entropies_;
+	thrust::device_ptr<int> window_probs_discrete_;
+
+public:
+	window_average_small_cuda_reducer(float window_size, float max_time, bool discrete_time, size_t non_internals,
+									  int state_words, size_t max_traj_len, kernel_wrapper& window_average_small);
+
+	~window_average_small_cuda_reducer();
+
+	void process_batch(const trajectory_batch& batch) override;
+
+	void finalize(std::vector<sparse_histogram<float>>& probs, std::vector<sparse_histogram<int>>& probs_discrete,
+				  std::vector<float>& tr_entropies) override;
+};
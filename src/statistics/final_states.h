@@ -1,34 +1,54 @@
 #pragma once
 
-#include <map>
+#include <memory>
+#include <stdexcept>
 
-#include "../kernel.h"
 #include "../state.h"
 #include "stats.h"
 
+// Backend specific accumulation of the final states occurences
+class final_states_reducer
+{
+public:
+	virtual ~final_states_reducer() = default;
+
+	virtual void process_batch(const trajectory_batch& batch) = 0;
+
+	// Stores the accumulated occurences of the visited non-internal states
+	virtual void finalize(sparse_histogram<int>& occurences) = 0;
+
+	// Serializes the accumulated state into a checkpoint and restores it, the reducers without the support cannot be
+	// checkpointed
+	virtual void save(binary_writer&) const { throw std::runtime_error("the reducer does not support checkpoints"); }
+	virtual void load(binary_reader&) { throw std::runtime_error("the reducer does not support checkpoints"); }
+};
+
+using final_states_reducer_ptr = std::unique_ptr<final_states_reducer>;
+
 class final_states_stats : public stats
 {
-	std::vector<int> result_occurences_;
-	thrust::device_ptr<int> occurences_;
+	sparse_histogram<int> result_occurences_;
 
-	int noninternal_states_count_;
 	state_t noninternals_mask_;
 
-	kernel_wrapper& final_states_;
+	final_states_reducer_ptr reducer_;
 
 public:
-	final_states_stats(state_t noninternals_mask_, int noninternals, kernel_wrapper& final_states);
-	~final_states_stats();
+	final_states_stats(state_t noninternals_mask_, final_states_reducer_ptr reducer);
 
-	void process_batch_internal(thrust::device_ptr<state_word_t> last_states,
-								thrust::device_ptr<trajectory_status> traj_statuses, int n_trajectories_batch);
+	void process_batch(const trajectory_batch& batch) override;
 
-	void process_batch(thrust::device_ptr<state_word_t> traj_states, thrust::device_ptr<float> traj_times,
-					   thrust::device_ptr<float> traj_tr_entropies, thrust::device_ptr<state_word_t> last_states,
-					   thrust::device_ptr<trajectory_status> traj_statuses, int n_trajectories) override;
+	// The final states are read from the last states
+	step_accumulator* fuse() override { return nullptr; }
 
 	void finalize() override;
 
 	void visualize(int n_trajectories, const std::vector<std::string>& nodes) override;
 	void write_csv(int n_trajectories, const std::vector<std::string>& nodes, const std::string& prefix) override;
+	void export_results(int n_trajectories, const std::vector<std::string>& nodes,
+						simulation_results& results) override;
+	void export_partial(partial_results& partial) override;
+	float max_error(int n_trajectories) override;
+	void save(binary_writer& w) const override;
+	void load(binary_reader& r) override;
 };
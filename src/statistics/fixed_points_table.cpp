@@ -0,0 +1,89 @@
+#include "fixed_points_table.h"
+
+#include <algorithm>
+
+fixed_points_table::fixed_points_table(int state_words) : state_words_(state_words) {}
+
+uint64_t fixed_points_table::hash_of(const state_word_t* state) const
+{
+	// splitmix64 finalizer over the words
+	uint64_t h = 0x9e3779b97f4a7c15ull;
+	for (int i = 0; i < state_words_; i++)
+	{
+		h = (h ^ state[i]) * 0xbf58476d1ce4e5b9ull;
+		h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+		h ^= h >> 31;
+	}
+
+	return h;
+}
+
+size_t fixed_points_table::find_slot(const state_word_t* state)
+{
+	// the tags of the keys are above busy_tag, the home slot is taken from the hash before that bit is forced
+	uint64_t hash = hash_of(state);
+	uint64_t tag = hash | 2;
+
+	for (size_t i = hash & (capacity_ - 1);; i = (i + 1) & (capacity_ - 1))
+	{
+		uint64_t current = tags_[i].load(std::memory_order_acquire);
+
+		if (current == empty_tag)
+		{
+			if (tags_[i].compare_exchange_strong(current, busy_tag, std::memory_order_acquire))
+			{
+				std::copy(state, state + state_words_, keys_.data() + i * state_words_);
+				tags_[i].store(tag, std::memory_order_release);
+				size_.fetch_add(1, std::memory_order_relaxed);
+				return i;
+			}
+		}
+
+		// another thread claimed the slot, its key is visible after a few stores
+		while (current == busy_tag)
+			current = tags_[i].load(std::memory_order_acquire);
+
+		if (current == tag && std::equal(state, state + state_words_, keys_.data() + i * state_words_))
+			return i;
+	}
+}
+
+void fixed_points_table::reserve(size_t count)
+{
+	size_t required = 2 * (size() + count);
+	if (required <= capacity_)
+		return;
+
+	size_t capacity = std::max<size_t>(capacity_, 16);
+	while (capacity < required)
+		capacity *= 2;
+
+	fixed_points_table grown(state_words_);
+	grown.capacity_ = capacity;
+	grown.tags_.reset(new std::atomic<uint64_t>[capacity]());
+	grown.counts_.reset(new std::atomic<int>[capacity]());
+	grown.keys_.resize(capacity * state_words_);
+
+	for_each([&](const state_word_t* state, int count) { grown.insert(state, count); });
+
+	capacity_ = capacity;
+	tags_ = std::move(grown.tags_);
+	counts_ = std::move(grown.counts_);
+	keys_ = std::move(grown.keys_);
+}
+
+void fixed_points_table::insert(const state_word_t* state, int count)
+{
+	counts_[find_slot(state)].fetch_add(count, std::memory_order_relaxed);
+}
+
+void fixed_points_table::clear()
+{
+	for (size_t i = 0; i < capacity_; i++)
+	{
+		tags_[i].store(empty_tag, std::memory_order_relaxed);
+		counts_[i].store(0, std::memory_order_relaxed);
+	}
+
+	size_ = 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../state_word.h"
+
+// Flat open-addressing hash table counting the fixed points by their state words. The inserts run concurrently from
+// many threads without locks, a slot is claimed by a compare-and-swap of its tag and the counts are atomic. The table
+// grows only in reserve, which is called between the batches, so it stays at most half full and the probing is short.
+// It keeps the fixed points unordered, they are sorted once when the results are finalized.
+class fixed_points_table
+{
+	// tags of the slots, the empty and busy slots are marked by the values below the tags of the keys
+	static constexpr uint64_t empty_tag = 0;
+	static constexpr uint64_t busy_tag = 1;
+
+	int state_words_;
+	size_t capacity_ = 0;
+	std::atomic<size_t> size_{ 0 };
+
+	std::unique_ptr<std::atomic<uint64_t>[]> tags_;
+	std::unique_ptr<std::atomic<int>[]> counts_;
+	std::vector<state_word_t> keys_;
+
+	uint64_t hash_of(const state_word_t* state) const;
+
+	// Finds the slot of state or claims an empty one for it
+	size_t find_slot(const state_word_t* state);
+
+public:
+	explicit fixed_points_table(int state_words);
+
+	int state_words() const { return state_words_; }
+	size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+	// Makes room for count more distinct fixed points, it must not run concurrently with insert
+	void reserve(size_t count);
+
+	// Adds count occurences of state, the inserts may run concurrently once there is room for their fixed points
+	void insert(const state_word_t* state, int count = 1);
+
+	void clear();
+
+	// Calls fn(state, count) for the fixed points in no particular order
+	template <typename fn_t>
+	void for_each(fn_t&& fn) const
+	{
+		for (size_t i = 0; i < capacity_; i++)
+			if (tags_[i].load(std::memory_order_relaxed) > busy_tag)
+				fn(keys_.data() + i * state_words_, counts_[i].load(std::memory_order_relaxed));
+	}
+};
@@ -1,45 +1,214 @@
 #pragma once
 
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
 #include <map>
+#include <stdexcept>
+#include <type_traits>
 
 #include "../state.h"
-#include "stats.h"
+#include "../timer.h"
+#include "../utils.h"
+#include "fixed_points_table.h"
+#include "partial_results.h"
+#include "stats_composite.h"
 
-class stats_composite;
+// Widths up to MAX_WORDS have a fixed point key specialized for the number of words, wider states share a key
+// sized at runtime
+constexpr size_t MAX_WORDS = DIV_UP(MAX_NODES, 32);
+
+template <int state_words>
+using fixed_state_t =
+	std::conditional_t<state_words == dynamic_state_words, dynamic_state_t, static_state_t<state_words>>;
+
+template <int state_words>
+fixed_state_t<state_words> make_fixed_state(const state_word_t* state, int runtime_state_words)
+{
+	if constexpr (state_words == dynamic_state_words)
+	{
+		return dynamic_state_t(state, runtime_state_words);
+	}
+	else
+	{
+		static_state_t<state_words> fixed_state;
+		std::copy(state, state + state_words, fixed_state.data);
+		return fixed_state;
+	}
+}
+
+// Backend specific accumulation of the fixed points reached by the trajectories
+template <int state_words>
+class fixed_states_reducer
+{
+public:
+	using result_t = std::map<fixed_state_t<state_words>, int>;
+
+	virtual ~fixed_states_reducer() = default;
+
+	virtual void process_batch(const trajectory_batch& batch) = 0;
+
+	// Adds the accumulated fixed points occurences into result
+	virtual void finalize(result_t& result) = 0;
+
+	// Serializes the accumulated state into a checkpoint and restores it, the reducers without the support cannot be
+	// checkpointed
+	virtual void save(binary_writer&) const { throw std::runtime_error("the reducer does not support checkpoints"); }
+	virtual void load(binary_reader&) { throw std::runtime_error("the reducer does not support checkpoints"); }
+};
+
+// Adds the fixed points counted in table into result, they are sorted once here so the map is built in linear time
+template <int state_words>
+void add_fixed_points(const fixed_points_table& table, typename fixed_states_reducer<state_words>::result_t& result)
+{
+	std::vector<std::pair<fixed_state_t<state_words>, int>> fixed_points;
+	fixed_points.reserve(table.size());
+	table.for_each([&](const state_word_t* state, int count) {
+		fixed_points.emplace_back(make_fixed_state<state_words>(state, table.state_words()), count);
+	});
+
+	std::sort(fixed_points.begin(), fixed_points.end(),
+			  [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+	// the next fixed point is inserted after the previous one
+	auto hint = result.begin();
+	for (auto& [state, count] : fixed_points)
+	{
+		auto it = result.try_emplace(hint, std::move(state), 0);
+		it->second += count;
+		hint = std::next(it);
+	}
+}
 
 template <int state_words>
 class fixed_states_stats : public stats
 {
-	using result_t = std::map<static_state_t<state_words>, int>;
+	using result_t = typename fixed_states_reducer<state_words>::result_t;
 	result_t result_;
 
-	size_t tmp_storage_bytes_ = 0;
-	void* d_tmp_storage_ = nullptr;
-	int* d_out_num;
-	static_state_t<state_words>* d_fixed_copy_ = nullptr;
-	static_state_t<state_words>* d_unique_states_ = nullptr;
-	int* d_unique_states_count_ = nullptr;
+	std::unique_ptr<fixed_states_reducer<state_words>> reducer_;
 
 public:
-	~fixed_states_stats();
+	fixed_states_stats(std::unique_ptr<fixed_states_reducer<state_words>> reducer) : reducer_(std::move(reducer)) {}
+
+	void process_batch(const trajectory_batch& batch) override { reducer_->process_batch(batch); }
+
+	// The fixed points are read from the last states
+	step_accumulator* fuse() override { return nullptr; }
+
+	void finalize() override
+	{
+		timer_stats stats("fixed_states_stats> finalize");
+
+		reducer_->finalize(result_);
+	}
+
+	void visualize(int n_trajectories, const std::vector<std::string>& nodes) override
+	{
+		timer_stats stats("fixed_states_stats> visualize");
+
+		std::cout << "fixed points:" << std::endl;
+
+		for (const auto& p : result_)
+		{
+			std::cout << (float)p.second / (float)n_trajectories << " "
+					  << state_t(nodes.size(), std::data(p.first.data)).to_string(nodes) << std::endl;
+		}
+	}
+
+	void write_csv(int n_trajectories, const std::vector<std::string>& nodes, const std::string& prefix) override
+	{
+		timer_stats stats("fixed_states_stats> write_csv");
+
+		std::ofstream ofs;
+
+		ofs.open(prefix + "_fp.csv");
+		if (ofs)
+		{
+			ofs << "Fixed Points (" << result_.size() << ")" << std::endl;
+			ofs << "FP\tProba\tState";
+
+			for (auto& node : nodes)
+			{
+				ofs << "\t" << node;
+			}
+			ofs << std::endl;
+
+			int i_fp = 0;
+			for (const auto& p : result_)
+			{
+				state_t runtime_state(nodes.size(), std::data(p.first.data));
+				ofs << "#" << i_fp << "\t" << ((float)p.second) / n_trajectories << "\t"
+					<< runtime_state.to_string(nodes);
+				for (size_t i = 0; i < nodes.size(); i++)
+				{
+					ofs << "\t" << runtime_state.is_set(i);
+				}
+				ofs << std::endl;
+				i_fp++;
+			}
+		}
+	}
+
+	void export_results(int n_trajectories, const std::vector<std::string>& nodes,
+						simulation_results& results) override
+	{
+		for (const auto& p : result_)
+		{
+			state_t runtime_state(nodes.size(), std::data(p.first.data));
+
+			results.fixed_point_probs.push_back((float)p.second / (float)n_trajectories);
+			results.fixed_point_labels.push_back(runtime_state.to_string(nodes));
+			for (size_t i = 0; i < nodes.size(); i++)
+				results.fixed_point_nodes.push_back(runtime_state.is_set(i));
+		}
+	}
 
-	void initialize_temp_storage(thrust::device_ptr<static_state_t<state_words>> last_states,
-								 thrust::device_ptr<trajectory_status> traj_statuses, int n_trajectories);
+	void export_partial(partial_results& partial) override
+	{
+		for (const auto& p : result_)
+			partial.fixed_points.emplace(std::vector<state_word_t>(std::begin(p.first.data), std::end(p.first.data)),
+										 p.second);
+	}
 
-	void process_batch_internal(thrust::device_ptr<static_state_t<state_words>> last_states,
-								thrust::device_ptr<trajectory_status> traj_statuses, int n_trajectories);
+	float max_error(int n_trajectories) override
+	{
+		result_t result;
+		reducer_->finalize(result);
 
-	void process_batch(thrust::device_ptr<state_word_t> traj_states, thrust::device_ptr<float> traj_times,
-					   thrust::device_ptr<float> traj_tr_entropies, thrust::device_ptr<state_word_t> last_states,
-					   thrust::device_ptr<trajectory_status> traj_statuses, int n_trajectories) override;
+		float error = 0.f;
+		for (const auto& p : result)
+			error = std::max(error, confidence_half_width((float)p.second / n_trajectories, n_trajectories));
+		return error;
+	}
 
-	void visualize(int n_trajectories, const std::vector<std::string>& nodes) override;
+	void save(binary_writer& w) const override { reducer_->save(w); }
 
-	void write_csv(int n_trajectories, const std::vector<std::string>& nodes, const std::string& prefix) override;
+	void load(binary_reader& r) override { reducer_->load(r); }
 };
 
 class fixed_states_stats_builder
 {
 public:
-	static void add_fixed_states_stats(stats_composite& stats_runner, int state_words);
+	// Instantiates fixed_states_stats with reducer_t<state_words> for the runtime state_words,
+	// reducer_t<dynamic_state_words> is used for the states wider than MAX_WORDS
+	template <template <int> class reducer_t, int n = 1, typename... args_t>
+	static void add_fixed_states_stats(stats_composite& stats_runner, int state_words, args_t&... args)
+	{
+		if constexpr (n > MAX_WORDS)
+		{
+			stats_runner.add(std::make_unique<fixed_states_stats<dynamic_state_words>>(
+				std::make_unique<reducer_t<dynamic_state_words>>(state_words, args...)));
+		}
+		else if (n == state_words)
+		{
+			stats_runner.add(
+				std::make_unique<fixed_states_stats<n>>(std::make_unique<reducer_t<n>>(state_words, args...)));
+		}
+		else
+		{
+			add_fixed_states_stats<reducer_t, n + 1>(stats_runner, state_words, args...);
+		}
+	}
 };
@@ -0,0 +1,64 @@
+#include "final_states_reducer.h"
+
+#include "../../binary_stream.h"
+#include "../../timer.h"
+
+final_states_host_reducer::final_states_host_reducer(int noninternals, int state_words, const host_model& model,
+													 thread_pool& pool)
+	: histograms_(pool.size()),
+	  noninternal_states_count_(1 << noninternals),
+	  state_words_(state_words),
+	  model_(model),
+	  pool_(pool)
+{
+	timer_stats stats("final_states_stats> initialize");
+
+	// each worker touches its own histogram first
+	pool_.run([&](int worker) { histograms_[worker].assign(noninternal_states_count_, 0); });
+}
+
+void final_states_host_reducer::process_batch(const trajectory_batch& batch)
+{
+	timer_stats stats("final_states_stats> process_batch");
+
+	pool_.parallel_for(batch.n_trajectories, [&](int begin, int end, int worker) {
+		auto& histogram = histograms_[worker];
+
+		for (int i = begin; i < end; i++)
+		{
+			auto status = batch.traj_statuses[i];
+
+			if (status == trajectory_status::FINISHED || status == trajectory_status::FIXED_POINT)
+				histogram[model_.get_non_internal_index(batch.last_states + i * state_words_)]++;
+		}
+	});
+}
+
+void final_states_host_reducer::finalize(sparse_histogram<int>& occurences)
+{
+	std::vector<int> dense_occurences(noninternal_states_count_);
+
+	pool_.parallel_for(noninternal_states_count_, [&](int begin, int end, int) {
+		for (int i = begin; i < end; i++)
+		{
+			int sum = 0;
+			for (auto&& histogram : histograms_)
+				sum += histogram[i];
+			dense_occurences[i] = sum;
+		}
+	});
+
+	append_nonzero(dense_occurences.data(), noninternal_states_count_, occurences);
+}
+
+void final_states_host_reducer::save(binary_writer& w) const
+{
+	for (auto&& histogram : histograms_)
+		w.put_vector(histogram);
+}
+
+void final_states_host_reducer::load(binary_reader& r)
+{
+	for (auto&& histogram : histograms_)
+		r.get_vector(histogram);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../../host/host_model.h"
+#include "../../host/thread_pool.h"
+#include "../final_states.h"
+
+// Accumulates the final states into a histogram per worker thread, the histograms are summed in finalize
+class final_states_host_reducer : public final_states_reducer
+{
+	std::vector<std::vector<int>> histograms_;
+
+	int noninternal_states_count_;
+	int state_words_;
+
+	const host_model& model_;
+	thread_pool& pool_;
+
+public:
+	final_states_host_reducer(int noninternals, int state_words, const host_model& model, thread_pool& pool);
+
+	void process_batch(const trajectory_batch& batch) override;
+
+	void finalize(sparse_histogram<int>& occurences) override;
+
+	void save(binary_writer& w) const override;
+	void load(binary_reader& r) override;
+};
@@ -0,0 +1,45 @@
+#include "final_states_sparse_reducer.h"
+
+#include "../../binary_stream.h"
+#include "../../timer.h"
+
+final_states_sparse_host_reducer::final_states_sparse_host_reducer(int state_words, const host_model& model,
+																   thread_pool& pool)
+	: histograms_(pool.size()), state_words_(state_words), model_(model), pool_(pool)
+{}
+
+void final_states_sparse_host_reducer::process_batch(const trajectory_batch& batch)
+{
+	timer_stats stats("final_states_stats> process_batch");
+
+	pool_.parallel_for(batch.n_trajectories, [&](int begin, int end, int worker) {
+		auto& histogram = histograms_[worker];
+
+		for (int i = begin; i < end; i++)
+		{
+			auto status = batch.traj_statuses[i];
+
+			if (status == trajectory_status::FINISHED || status == trajectory_status::FIXED_POINT)
+				histogram[model_.get_non_internal_index(batch.last_states + i * state_words_)]++;
+		}
+	});
+}
+
+void final_states_sparse_host_reducer::finalize(sparse_histogram<int>& occurences)
+{
+	for (auto&& histogram : histograms_)
+		for (const auto& [idx, count] : histogram)
+			occurences[idx] += count;
+}
+
+void final_states_sparse_host_reducer::save(binary_writer& w) const
+{
+	for (auto&& histogram : histograms_)
+		w.put_map(histogram);
+}
+
+void final_states_sparse_host_reducer::load(binary_reader& r)
+{
+	for (auto&& histogram : histograms_)
+		histogram = r.get_map<std::unordered_map<uint64_t, int>>();
+}
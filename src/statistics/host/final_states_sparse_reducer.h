@@ -0,0 +1,29 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "../../host/host_model.h"
+#include "../../host/thread_pool.h"
+#include "../final_states.h"
+
+// Accumulates the final states into a hash map per worker thread, the maps are merged in finalize.
+// Used when the dense histogram over all non-internal states would not fit into memory.
+class final_states_sparse_host_reducer : public final_states_reducer
+{
+	std::vector<std::unordered_map<uint64_t, int>> histograms_;
+
+	int state_words_;
+
+	const host_model& model_;
+	thread_pool& pool_;
+
+public:
+	final_states_sparse_host_reducer(int state_words, const host_model& model, thread_pool& pool);
+
+	void process_batch(const trajectory_batch& batch) override;
+
+	void finalize(sparse_histogram<int>& occurences) override;
+
+	void save(binary_writer& w) const override;
+	void load(binary_reader& r) override;
+};
@@ -0,0 +1,79 @@
+#include "fixed_states_reducer.h"
+
+#include <algorithm>
+
+#include "../../binary_stream.h"
+#include "../../timer.h"
+#include "../fixed_states.h"
+
+template <int state_words>
+class fixed_states_host_reducer : public fixed_states_reducer<state_words>
+{
+	using result_t = typename fixed_states_reducer<state_words>::result_t;
+
+	// the workers count the fixed points of all the batches into the shared table, they are sorted only in finalize
+	fixed_points_table table_;
+
+	int runtime_state_words_;
+
+	thread_pool& pool_;
+
+public:
+	fixed_states_host_reducer(int runtime_state_words, thread_pool& pool)
+		: table_(runtime_state_words), runtime_state_words_(runtime_state_words), pool_(pool)
+	{}
+
+	void process_batch(const trajectory_batch& batch) override
+	{
+		timer_stats stats("fixed_states_stats> process_batch");
+
+		int fixed_points = std::count(batch.traj_statuses, batch.traj_statuses + batch.n_trajectories,
+									  trajectory_status::FIXED_POINT);
+		if (fixed_points == 0)
+			return;
+
+		table_.reserve(fixed_points);
+
+		pool_.parallel_for(batch.n_trajectories, [&](int begin, int end, int) {
+			for (int i = begin; i < end; i++)
+			{
+				if (batch.traj_statuses[i] == trajectory_status::FIXED_POINT)
+					table_.insert(batch.last_states + i * runtime_state_words_);
+			}
+		});
+	}
+
+	void finalize(result_t& result) override { add_fixed_points<state_words>(table_, result); }
+
+	void save(binary_writer& w) const override
+	{
+		w.put<uint64_t>(table_.size());
+		table_.for_each([&](const state_word_t* state, int count) {
+			w.put_array(state, runtime_state_words_);
+			w.put(count);
+		});
+	}
+
+	void load(binary_reader& r) override
+	{
+		table_.clear();
+
+		auto size = r.get<uint64_t>();
+		table_.reserve(size);
+
+		std::vector<state_word_t> state(runtime_state_words_);
+		for (uint64_t i = 0; i < size; i++)
+		{
+			r.get_array(state.data(), state.size());
+			table_.insert(state.data(), r.get<int>());
+		}
+
+		if (table_.size() != size)
+			r.fail("duplicate fixed points");
+	}
+};
+
+void add_fixed_states_stats_host(stats_composite& stats_runner, int state_words, thread_pool& pool)
+{
+	fixed_states_stats_builder::add_fixed_states_stats<fixed_states_host_reducer>(stats_runner, state_words, pool);
+}
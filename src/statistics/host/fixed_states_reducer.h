@@ -0,0 +1,7 @@
+#pragma once
+
+#include "../../host/thread_pool.h"
+#include "../stats_composite.h"
+
+// Adds fixed_states_stats accumulating the fixed points into a map per worker thread
+void add_fixed_states_stats_host(stats_composite& stats_runner, int state_words, thread_pool& pool);
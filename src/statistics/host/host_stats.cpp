@@ -0,0 +1,86 @@
+#include "host_stats.h"
+
+#include <cmath>
+
+#include "../final_states.h"
+#include "../window_average_small.h"
+#include "final_states_reducer.h"
+#include "final_states_sparse_reducer.h"
+#include "fixed_states_reducer.h"
+#include "window_average_small_reducer.h"
+#include "window_average_sparse_reducer.h"
+#include "window_slices.h"
+
+size_t dense_host_stats_bytes(bool discrete_time, float max_time, float time_tick, int noninternals_count, int workers,
+							  bool window_errors)
+{
+	size_t states = (size_t)1 << noninternals_count;
+	size_t windows = std::ceil(max_time / time_tick);
+
+	// the final states, the window probabilities and the transition entropies, with the errors also their squares
+	size_t worker_bytes = states * sizeof(int) + windows * states * (discrete_time ? sizeof(int) : sizeof(double))
+						  + windows * sizeof(double);
+	if (window_errors)
+		worker_bytes += windows * states * sizeof(double) + windows * sizeof(double);
+
+	return worker_bytes * workers;
+}
+
+bool dense_host_stats(bool discrete_time, float max_time, float time_tick, int noninternals_count, int workers,
+					  bool window_errors)
+{
+	if (noninternals_count > max_dense_noninternals)
+		return false;
+
+	// every worker holds its own histograms, so the threads count decides as much as the nodes count
+	return dense_host_stats_bytes(discrete_time, max_time, time_tick, noninternals_count, workers, window_errors)
+		   <= max_dense_stats_bytes;
+}
+
+size_t host_stats_bytes(bool discrete_time, float max_time, float time_tick, int noninternals_count, int workers,
+						bool window_errors)
+{
+	if (!dense_host_stats(discrete_time, max_time, time_tick, noninternals_count, workers, window_errors))
+		return 0;
+
+	return dense_host_stats_bytes(discrete_time, max_time, time_tick, noninternals_count, workers, window_errors);
+}
+
+// the errors keep the window each trajectory is in
+size_t host_stats_slot_bytes(bool window_errors) { return window_errors ? sizeof(open_window) : 0; }
+
+void add_host_stats(stats_composite& stats_runner, bool discrete_time, float max_time, float time_tick,
+					const state_t& noninternals_mask, int noninternals_count, int trajectory_len_limit,
+					const host_model& model, thread_pool& pool, bool window_errors)
+{
+	bool dense =
+		dense_host_stats(discrete_time, max_time, time_tick, noninternals_count, pool.size(), window_errors);
+
+	// for final states
+	final_states_reducer_ptr final_states_reducer;
+	if (dense)
+		final_states_reducer =
+			std::make_unique<final_states_host_reducer>(noninternals_count, noninternals_mask.words_n(), model, pool);
+	else
+		final_states_reducer =
+			std::make_unique<final_states_sparse_host_reducer>(noninternals_mask.words_n(), model, pool);
+
+	stats_runner.add(std::make_unique<final_states_stats>(noninternals_mask, std::move(final_states_reducer)));
+
+	// for fixed states
+	add_fixed_states_stats_host(stats_runner, noninternals_mask.words_n(), pool);
+
+	// for window averages
+	window_average_small_reducer_ptr window_average_reducer;
+	if (dense)
+		window_average_reducer = std::make_unique<window_average_small_host_reducer>(
+			time_tick, max_time, discrete_time, noninternals_count, noninternals_mask.words_n(), trajectory_len_limit,
+			model, pool, window_errors);
+	else
+		window_average_reducer = std::make_unique<window_average_sparse_host_reducer>(
+			time_tick, max_time, discrete_time, noninternals_mask.words_n(), trajectory_len_limit, model, pool,
+			window_errors);
+
+	stats_runner.add(std::make_unique<window_average_small_stats>(time_tick, max_time, discrete_time, noninternals_mask,
+																  std::move(window_average_reducer)));
+}
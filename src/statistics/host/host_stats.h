@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../../host/host_model.h"
+#include "../../host/thread_pool.h"
+#include "../../state.h"
+#include "../stats_composite.h"
+
+// Models with more non-internal nodes are accumulated sparsely on the host and are not supported by the CUDA backend
+constexpr int max_dense_noninternals = 20;
+// The non-internal state index is a 64-bit integer
+constexpr int max_noninternals = 64;
+// Most memory the dense histograms of all the workers may take, the stats of bigger models are accumulated sparsely
+// even with at most max_dense_noninternals non-internal nodes
+constexpr size_t max_dense_stats_bytes = size_t(512) << 20;
+
+// Bytes of the dense final states and window averages histograms kept by workers threads
+size_t dense_host_stats_bytes(bool discrete_time, float max_time, float time_tick, int noninternals_count, int workers,
+							  bool window_errors);
+
+// True when add_host_stats accumulates the histograms on workers threads densely
+bool dense_host_stats(bool discrete_time, float max_time, float time_tick, int noninternals_count, int workers,
+					  bool window_errors);
+
+// Bytes add_host_stats allocates up front for workers threads and the bytes it keeps for each batch slot. The sparse
+// histograms grow with the visited states and are not counted.
+size_t host_stats_bytes(bool discrete_time, float max_time, float time_tick, int noninternals_count, int workers,
+						bool window_errors);
+size_t host_stats_slot_bytes(bool window_errors);
+
+// Adds the final states, fixed states and window averages stats accumulated on the host, the window averages estimate
+// their standard errors with window_errors
+void add_host_stats(stats_composite& stats_runner, bool discrete_time, float max_time, float time_tick,
+					const state_t& noninternals_mask, int noninternals_count, int trajectory_len_limit,
+					const host_model& model, thread_pool& pool, bool window_errors = false);
@@ -0,0 +1,227 @@
+#include "window_average_small_reducer.h"
+
+#include <cmath>
+
+#include "../../binary_stream.h"
+#include "../../timer.h"
+#include "window_slices.h"
+
+window_average_small_host_reducer::window_average_small_host_reducer(float window_size, float max_time,
+																	 bool discrete_time, size_t non_internals,
+																	 int state_words, size_t max_traj_len,
+																	 const host_model& model, thread_pool& pool,
+																	 bool errors)
+	: window_size_(window_size),
+	  max_time_(max_time),
+	  discrete_time_(discrete_time),
+	  noninternal_states_count_(1 << non_internals),
+	  state_words_(state_words),
+	  windows_count_(std::ceil(max_time / window_size)),
+	  max_traj_len_(max_traj_len),
+	  errors_(errors),
+	  model_(model),
+	  pool_(pool),
+	  histograms_(pool.size())
+{
+	timer_stats stats("window_average_small> initialize");
+
+	// each worker touches its own histogram first
+	pool_.run([&](int worker) {
+		auto& histogram = histograms_[worker];
+
+		histogram.tr_entropies.assign(windows_count_, 0.);
+
+		// the squares take as much memory as the probabilities, they are allocated only for the errors
+		if (errors_)
+		{
+			histogram.tr_entropy_squares.assign(windows_count_, 0.);
+			histogram.prob_squares.assign(windows_count_ * noninternal_states_count_, 0.);
+		}
+
+		if (discrete_time_)
+			histogram.probs_discrete.assign(windows_count_ * noninternal_states_count_, 0);
+		else
+			histogram.probs.assign(windows_count_ * noninternal_states_count_, 0.);
+	});
+}
+
+void window_average_small_host_reducer::close_window(const open_window& closed, worker_histogram& histogram) const
+{
+	for (size_t i = 0; i < closed.states.size(); i++)
+		histogram.prob_squares[closed.idx * noninternal_states_count_ + closed.states[i]] +=
+			closed.values[i] * closed.values[i];
+
+	histogram.tr_entropy_squares[closed.idx] += closed.tr_entropy * closed.tr_entropy;
+}
+
+void window_average_small_host_reducer::accumulate_step(open_window& window, worker_histogram& histogram,
+														const state_word_t* state, float begin_time, float end_time,
+														float tr_entropy) const
+{
+	const auto state_idx = model_.get_non_internal_index(state);
+
+	for_each_step_slice(begin_time, end_time, window_size_, discrete_time_, [&](int wnd_idx, float slice) {
+		if (discrete_time_)
+			histogram.probs_discrete[wnd_idx * noninternal_states_count_ + state_idx]++;
+		else
+			histogram.probs[wnd_idx * noninternal_states_count_ + state_idx] += slice;
+
+		histogram.tr_entropies[wnd_idx] += tr_entropy * slice;
+
+		if (errors_)
+			window.add(wnd_idx, state_idx, slice, tr_entropy,
+					   [&](const open_window& closed) { close_window(closed, histogram); });
+	});
+}
+
+void window_average_small_host_reducer::process_batch(const trajectory_batch& batch)
+{
+	timer_stats stats("window_average_small> process_batch");
+
+	if (!fused_)
+	{
+		open_windows_.reserve_slots(batch.n_trajectories);
+
+		pool_.parallel_for(batch.n_trajectories, [&](int begin, int end, int worker) {
+			for (int traj = begin; traj < end; traj++)
+			{
+				auto& window = open_windows_[traj];
+				auto& histogram = histograms_[worker];
+
+				for_each_batch_step(batch, traj, max_traj_len_, state_words_,
+									[&](const state_word_t* state, float begin_time, float end_time, float tr_h) {
+										accumulate_step(window, histogram, state, begin_time, end_time, tr_h);
+									});
+
+				end_trajectory(traj, worker, batch.traj_statuses[traj]);
+			}
+		});
+	}
+
+	open_windows_.compact(batch);
+}
+
+step_accumulator* window_average_small_host_reducer::fuse()
+{
+	fused_ = true;
+	return this;
+}
+
+void window_average_small_host_reducer::begin_batch(int n_trajectories) { open_windows_.reserve_slots(n_trajectories); }
+
+void window_average_small_host_reducer::add_step(int traj, int worker, const state_word_t* state, float begin_time,
+												 float end_time, float tr_entropy)
+{
+	accumulate_step(open_windows_[traj], histograms_[worker], state, begin_time, end_time, tr_entropy);
+}
+
+void window_average_small_host_reducer::end_trajectory(int traj, int worker, trajectory_status status)
+{
+	if (status != trajectory_status::CONTINUE)
+		open_windows_[traj].close([&](const open_window& closed) { close_window(closed, histograms_[worker]); });
+}
+
+void window_average_small_host_reducer::finalize(std::vector<sparse_histogram<float>>& probs,
+												 std::vector<sparse_histogram<int>>& probs_discrete,
+												 std::vector<float>& tr_entropies)
+{
+	const int cells = windows_count_ * noninternal_states_count_;
+
+	std::vector<float> dense_probs(discrete_time_ ? 0 : cells);
+	std::vector<int> dense_probs_discrete(discrete_time_ ? cells : 0);
+
+	pool_.parallel_for(cells, [&](int begin, int end, int) {
+		for (int i = begin; i < end; i++)
+		{
+			if (discrete_time_)
+			{
+				int sum = 0;
+				for (auto&& histogram : histograms_)
+					sum += histogram.probs_discrete[i];
+				dense_probs_discrete[i] = sum;
+			}
+			else
+			{
+				double sum = 0.;
+				for (auto&& histogram : histograms_)
+					sum += histogram.probs[i];
+				dense_probs[i] = sum;
+			}
+		}
+	});
+
+	for (size_t i = 0; i < windows_count_; i++)
+	{
+		if (discrete_time_)
+			append_nonzero(dense_probs_discrete.data() + i * noninternal_states_count_, noninternal_states_count_,
+						   probs_discrete[i]);
+		else
+			append_nonzero(dense_probs.data() + i * noninternal_states_count_, noninternal_states_count_, probs[i]);
+
+		double sum = 0.;
+		for (auto&& histogram : histograms_)
+			sum += histogram.tr_entropies[i];
+		tr_entropies[i] = sum;
+	}
+}
+
+void window_average_small_host_reducer::finalize_squares(std::vector<sparse_histogram<double>>& prob_squares,
+														 std::vector<double>& tr_entropy_squares)
+{
+	if (!errors_)
+		return;
+
+	const int cells = windows_count_ * noninternal_states_count_;
+
+	std::vector<double> dense_prob_squares(cells);
+
+	pool_.parallel_for(cells, [&](int begin, int end, int) {
+		for (int i = begin; i < end; i++)
+		{
+			double sum = 0.;
+			for (auto&& histogram : histograms_)
+				sum += histogram.prob_squares[i];
+			dense_prob_squares[i] = sum;
+		}
+	});
+
+	prob_squares.assign(windows_count_, {});
+	tr_entropy_squares.assign(windows_count_, 0.);
+
+	for (size_t i = 0; i < windows_count_; i++)
+	{
+		append_nonzero(dense_prob_squares.data() + i * noninternal_states_count_, noninternal_states_count_,
+					   prob_squares[i]);
+
+		for (auto&& histogram : histograms_)
+			tr_entropy_squares[i] += histogram.tr_entropy_squares[i];
+	}
+}
+
+void window_average_small_host_reducer::save(binary_writer& w) const
+{
+	for (auto&& histogram : histograms_)
+	{
+		w.put_vector(histogram.probs);
+		w.put_vector(histogram.probs_discrete);
+		w.put_vector(histogram.tr_entropies);
+		w.put_vector(histogram.prob_squares);
+		w.put_vector(histogram.tr_entropy_squares);
+	}
+
+	open_windows_.save(w);
+}
+
+void window_average_small_host_reducer::load(binary_reader& r)
+{
+	for (auto&& histogram : histograms_)
+	{
+		r.get_vector(histogram.probs);
+		r.get_vector(histogram.probs_discrete);
+		r.get_vector(histogram.tr_entropies);
+		r.get_vector(histogram.prob_squares);
+		r.get_vector(histogram.tr_entropy_squares);
+	}
+
+	open_windows_.load(r);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../../host/host_model.h"
+#include "../../host/thread_pool.h"
+#include "../window_average_small.h"
+#include "window_slices.h"
+
+// Accumulates the window averages into histograms per worker thread, the histograms are summed in finalize.
+// Continuous time slices are summed in double precision so small slices are not lost in big sums. With the errors the
+// squares of the per trajectory values are summed alongside for the standard errors.
+class window_average_small_host_reducer : public window_average_small_reducer, public step_accumulator
+{
+	float window_size_;
+	float max_time_;
+	bool discrete_time_;
+	uint32_t noninternal_states_count_;
+	int state_words_;
+	size_t windows_count_;
+
+	size_t max_traj_len_;
+	bool errors_;
+
+	const host_model& model_;
+	thread_pool& pool_;
+
+	struct worker_histogram
+	{
+		std::vector<double> probs;
+		std::vector<int> probs_discrete;
+		std::vector<double> tr_entropies;
+		std::vector<double> prob_squares;
+		std::vector<double> tr_entropy_squares;
+	};
+
+	std::vector<worker_histogram> histograms_;
+	open_windows open_windows_;
+
+	// the steps come from the simulation instead of the batches
+	bool fused_ = false;
+
+	void accumulate_step(open_window& window, worker_histogram& histogram, const state_word_t* state,
+						 float begin_time, float end_time, float tr_entropy) const;
+	void close_window(const open_window& closed, worker_histogram& histogram) const;
+
+public:
+	window_average_small_host_reducer(float window_size, float max_time, bool discrete_time, size_t non_internals,
+									  int state_words, size_t max_traj_len, const host_model& model, thread_pool& pool,
+									  bool errors);
+
+	void process_batch(const trajectory_batch& batch) override;
+
+	step_accumulator* fuse() override;
+	void begin_batch(int n_trajectories) override;
+	void add_step(int traj, int worker, const state_word_t* state, float begin_time, float end_time,
+				  float tr_entropy) override;
+	void end_trajectory(int traj, int worker, trajectory_status status) override;
+
+	void finalize(std::vector<sparse_histogram<float>>& probs, std::vector<sparse_histogram<int>>& probs_discrete,
+				  std::vector<float>& tr_entropies) override;
+	void finalize_squares(std::vector<sparse_histogram<double>>& prob_squares,
+						  std::vector<double>& tr_entropy_squares) override;
+
+	void save(binary_writer& w) const override;
+	void load(binary_reader& r) override;
+};
@@ -0,0 +1,207 @@
+#include "window_average_sparse_reducer.h"
+
+#include <cmath>
+
+#include "../../binary_stream.h"
+#include "../../timer.h"
+#include "window_slices.h"
+
+window_average_sparse_host_reducer::window_average_sparse_host_reducer(float window_size, float max_time,
+																	   bool discrete_time, int state_words,
+																	   size_t max_traj_len, const host_model& model,
+																	   thread_pool& pool, bool errors)
+	: window_size_(window_size),
+	  discrete_time_(discrete_time),
+	  state_words_(state_words),
+	  windows_count_(std::ceil(max_time / window_size)),
+	  max_traj_len_(max_traj_len),
+	  errors_(errors),
+	  model_(model),
+	  pool_(pool),
+	  histograms_(pool.size())
+{
+	for (auto& histogram : histograms_)
+	{
+		histogram.tr_entropies.assign(windows_count_, 0.);
+
+		if (errors_)
+		{
+			histogram.tr_entropy_squares.assign(windows_count_, 0.);
+			histogram.prob_squares.resize(windows_count_);
+		}
+
+		if (discrete_time_)
+			histogram.probs_discrete.resize(windows_count_);
+		else
+			histogram.probs.resize(windows_count_);
+	}
+}
+
+void window_average_sparse_host_reducer::close_window(const open_window& closed, worker_histogram& histogram) const
+{
+	auto& squares = histogram.prob_squares[closed.idx];
+	for (size_t i = 0; i < closed.states.size(); i++)
+		squares[closed.states[i]] += closed.values[i] * closed.values[i];
+
+	histogram.tr_entropy_squares[closed.idx] += closed.tr_entropy * closed.tr_entropy;
+}
+
+void window_average_sparse_host_reducer::accumulate_step(open_window& window, worker_histogram& histogram,
+														 const state_word_t* state, float begin_time, float end_time,
+														 float tr_entropy) const
+{
+	const auto state_idx = model_.get_non_internal_index(state);
+
+	for_each_step_slice(begin_time, end_time, window_size_, discrete_time_, [&](int wnd_idx, float slice) {
+		if (discrete_time_)
+			histogram.probs_discrete[wnd_idx][state_idx]++;
+		else
+			histogram.probs[wnd_idx][state_idx] += slice;
+
+		histogram.tr_entropies[wnd_idx] += tr_entropy * slice;
+
+		if (errors_)
+			window.add(wnd_idx, state_idx, slice, tr_entropy,
+					   [&](const open_window& closed) { close_window(closed, histogram); });
+	});
+}
+
+void window_average_sparse_host_reducer::process_batch(const trajectory_batch& batch)
+{
+	timer_stats stats("window_average_small> process_batch");
+
+	if (!fused_)
+	{
+		open_windows_.reserve_slots(batch.n_trajectories);
+
+		pool_.parallel_for(batch.n_trajectories, [&](int begin, int end, int worker) {
+			for (int traj = begin; traj < end; traj++)
+			{
+				auto& window = open_windows_[traj];
+				auto& histogram = histograms_[worker];
+
+				for_each_batch_step(batch, traj, max_traj_len_, state_words_,
+									[&](const state_word_t* state, float begin_time, float end_time, float tr_h) {
+										accumulate_step(window, histogram, state, begin_time, end_time, tr_h);
+									});
+
+				end_trajectory(traj, worker, batch.traj_statuses[traj]);
+			}
+		});
+	}
+
+	open_windows_.compact(batch);
+}
+
+step_accumulator* window_average_sparse_host_reducer::fuse()
+{
+	fused_ = true;
+	return this;
+}
+
+void window_average_sparse_host_reducer::begin_batch(int n_trajectories)
+{
+	open_windows_.reserve_slots(n_trajectories);
+}
+
+void window_average_sparse_host_reducer::add_step(int traj, int worker, const state_word_t* state, float begin_time,
+												  float end_time, float tr_entropy)
+{
+	accumulate_step(open_windows_[traj], histograms_[worker], state, begin_time, end_time, tr_entropy);
+}
+
+void window_average_sparse_host_reducer::end_trajectory(int traj, int worker, trajectory_status status)
+{
+	if (status != trajectory_status::CONTINUE)
+		open_windows_[traj].close([&](const open_window& closed) { close_window(closed, histograms_[worker]); });
+}
+
+void window_average_sparse_host_reducer::finalize(std::vector<sparse_histogram<float>>& probs,
+												  std::vector<sparse_histogram<int>>& probs_discrete,
+												  std::vector<float>& tr_entropies)
+{
+	// windows are merged independently of each other
+	pool_.parallel_for(windows_count_, [&](int begin, int end, int) {
+		for (int i = begin; i < end; i++)
+		{
+			if (discrete_time_)
+			{
+				for (auto&& histogram : histograms_)
+					for (const auto& [idx, count] : histogram.probs_discrete[i])
+						probs_discrete[i][idx] += count;
+			}
+			else
+			{
+				sparse_histogram<double> sums;
+				for (auto&& histogram : histograms_)
+					for (const auto& [idx, slices] : histogram.probs[i])
+						sums[idx] += slices;
+
+				for (const auto& [idx, sum] : sums)
+					probs[i].emplace_hint(probs[i].end(), idx, sum);
+			}
+
+			double sum = 0.;
+			for (auto&& histogram : histograms_)
+				sum += histogram.tr_entropies[i];
+			tr_entropies[i] = sum;
+		}
+	});
+}
+
+void window_average_sparse_host_reducer::finalize_squares(std::vector<sparse_histogram<double>>& prob_squares,
+														  std::vector<double>& tr_entropy_squares)
+{
+	if (!errors_)
+		return;
+
+	prob_squares.assign(windows_count_, {});
+	tr_entropy_squares.assign(windows_count_, 0.);
+
+	pool_.parallel_for(windows_count_, [&](int begin, int end, int) {
+		for (int i = begin; i < end; i++)
+		{
+			for (auto&& histogram : histograms_)
+			{
+				for (const auto& [idx, squares] : histogram.prob_squares[i])
+					prob_squares[i][idx] += squares;
+
+				tr_entropy_squares[i] += histogram.tr_entropy_squares[i];
+			}
+		}
+	});
+}
+
+void window_average_sparse_host_reducer::save(binary_writer& w) const
+{
+	for (auto&& histogram : histograms_)
+	{
+		for (auto&& window : histogram.probs)
+			w.put_map(window);
+		for (auto&& window : histogram.probs_discrete)
+			w.put_map(window);
+		w.put_vector(histogram.tr_entropies);
+		for (auto&& window : histogram.prob_squares)
+			w.put_map(window);
+		w.put_vector(histogram.tr_entropy_squares);
+	}
+
+	open_windows_.save(w);
+}
+
+void window_average_sparse_host_reducer::load(binary_reader& r)
+{
+	for (auto&& histogram : histograms_)
+	{
+		for (auto&& window : histogram.probs)
+			window = r.get_map<std::unordered_map<uint64_t, double>>();
+		for (auto&& window : histogram.probs_discrete)
+			window = r.get_map<std::unordered_map<uint64_t, int>>();
+		r.get_vector(histogram.tr_entropies);
+		for (auto&& window : histogram.prob_squares)
+			window = r.get_map<std::unordered_map<uint64_t, double>>();
+		r.get_vector(histogram.tr_entropy_squares);
+	}
+
+	open_windows_.load(r);
+}
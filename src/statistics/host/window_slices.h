@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../../binary_stream.h"
+#include "../stats.h"
+
+// Calls fn(state, begin_time, end_time, tr_entropy) for the steps of the trajectory traj recorded in the batch buffers
+template <typename fn_t>
+void for_each_batch_step(const trajectory_batch& batch, int traj, size_t max_traj_len, int state_words, fn_t&& fn)
+{
+	// the first step holds only the time where the trajectory continues from
+	for (size_t step = 1; step < max_traj_len; step++)
+	{
+		size_t id = traj * max_traj_len + step;
+
+		if (batch.traj_times[id] == 0.f)
+			continue;
+
+		fn(batch.traj_states + id * state_words, batch.traj_times[id - 1], batch.traj_times[id],
+		   batch.traj_tr_entropies[id]);
+	}
+}
+
+// Splits a step from begin_time to end_time into the parts falling into the individual windows and calls
+// fn(window_idx, slice) for each of them. The slice is the time spent in the window for the continuous time and 1 for
+// the discrete time, where the whole step belongs to a single window.
+template <typename fn_t>
+void for_each_step_slice(float begin_time, float end_time, float window_size, bool discrete_time, fn_t&& fn)
+{
+	if (discrete_time)
+	{
+		fn((int)std::lround(begin_time / window_size), 1.f);
+		return;
+	}
+
+	float slice_begin = begin_time;
+	int wnd_idx = std::floor(slice_begin / window_size);
+
+	while (end_time > slice_begin)
+	{
+		float wnd_end = (wnd_idx + 1) * window_size;
+		float slice_in_wnd = std::min(end_time, wnd_end) - slice_begin;
+
+		fn(wnd_idx, slice_in_wnd);
+
+		wnd_idx++;
+
+		slice_begin = std::min(end_time, wnd_end);
+	}
+}
+
+// Values of a trajectory in the window it is in, per visited state and of the transition entropy. The squares of the
+// values are accumulated once the trajectory leaves the window, so the sums of squares hold the whole per trajectory
+// values even when a window spans several batches.
+struct open_window
+{
+	int idx = -1;
+	std::vector<uint64_t> states;
+	std::vector<double> values;
+	double tr_entropy = 0.;
+
+	// Passes the complete values to fn(const open_window&) and clears the window
+	template <typename fn_t>
+	void close(fn_t&& fn)
+	{
+		if (idx == -1)
+			return;
+
+		fn(*this);
+
+		idx = -1;
+		states.clear();
+		values.clear();
+		tr_entropy = 0.;
+	}
+
+	// Adds a slice of for_each_step_slice, the window is closed first when the slice belongs to the next one.
+	// A window holds just the states visited during it, so the linear search stays short.
+	template <typename fn_t>
+	void add(int wnd_idx, uint64_t state_idx, float slice, float tr_h, fn_t&& fn)
+	{
+		if (wnd_idx != idx)
+		{
+			close(fn);
+			idx = wnd_idx;
+		}
+
+		auto it = std::find(states.begin(), states.end(), state_idx);
+		if (it == states.end())
+		{
+			states.push_back(state_idx);
+			values.push_back(slice);
+		}
+		else
+			values[it - states.begin()] += slice;
+
+		tr_entropy += tr_h * slice;
+	}
+};
+
+// Open windows of the trajectories in the batch slots. The host runner moves the continuing trajectories to the first
+// slots of the next batch in their order, so compact moves their open windows along.
+class open_windows
+{
+	std::vector<open_window> windows_;
+
+public:
+	open_window& operator[](int traj) { return windows_[traj]; }
+
+	void reserve_slots(int n_trajectories)
+	{
+		if (windows_.size() < (size_t)n_trajectories)
+			windows_.resize(n_trajectories);
+	}
+
+	// The windows of the trajectories that did not continue are already closed
+	void compact(const trajectory_batch& batch)
+	{
+		int continuing = 0;
+		for (int i = 0; i < batch.n_trajectories; i++)
+			if (batch.traj_statuses[i] == trajectory_status::CONTINUE)
+				std::swap(windows_[continuing++], windows_[i]);
+	}
+
+	void save(binary_writer& w) const
+	{
+		w.put<uint64_t>(windows_.size());
+		for (auto&& window : windows_)
+		{
+			w.put<int32_t>(window.idx);
+			w.put_vector(window.states);
+			w.put_vector(window.values);
+			w.put(window.tr_entropy);
+		}
+	}
+
+	void load(binary_reader& r)
+	{
+		windows_.resize(r.get<uint64_t>());
+		for (auto&& window : windows_)
+		{
+			window.idx = r.get<int32_t>();
+			window.states = r.get_vector<uint64_t>();
+			window.values = r.get_vector<double>();
+			window.tr_entropy = r.get<double>();
+
+			if (window.states.size() != window.values.size())
+				r.fail("invalid open window");
+		}
+	}
+};
@@ -0,0 +1,223 @@
+#include "partial_results.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "../binary_stream.h"
+
+namespace {
+
+template <typename T>
+void add_histogram(sparse_histogram<T>& sums, const sparse_histogram<T>& other)
+{
+	for (const auto& [idx, value] : other)
+		sums[idx] += value;
+}
+
+} // namespace
+
+std::string partial_results::serialize() const
+{
+	binary_writer w;
+
+	for (char c : magic_value)
+		w.put(c);
+	w.put(current_version);
+
+	w.put<int32_t>(n_trajectories);
+	w.put<uint64_t>(seed);
+	w.put<uint64_t>(trajectory_ranges.size());
+	for (const auto& [begin, end] : trajectory_ranges)
+	{
+		w.put(begin);
+		w.put(end);
+	}
+
+	w.put<uint64_t>(nodes.size());
+	for (const auto& node : nodes)
+		w.put_string(node);
+	w.put_vector(noninternals_mask);
+
+	w.put(window_size);
+	w.put(max_time);
+	w.put<uint8_t>(discrete_time);
+
+	w.put_map(final_states);
+
+	w.put<uint64_t>(fixed_points.size());
+	for (const auto& [state, count] : fixed_points)
+	{
+		w.put_vector(state);
+		w.put<int32_t>(count);
+	}
+
+	w.put_vector(window_tr_entropies);
+	for (size_t i = 0; i < window_tr_entropies.size(); i++)
+	{
+		if (discrete_time)
+			w.put_map(window_probs_discrete[i]);
+		else
+			w.put_map(window_probs[i]);
+	}
+
+	w.put_vector(window_tr_entropy_squares);
+	for (auto&& squares : window_prob_squares)
+		w.put_map(squares);
+
+	return w.take();
+}
+
+partial_results partial_results::deserialize(const std::string& data)
+{
+	binary_reader r(data, "partial");
+	partial_results partial;
+
+	for (char c : magic_value)
+		if (r.get<char>() != c)
+			r.fail("bad magic");
+
+	auto version = r.get<uint32_t>();
+	if (version != current_version)
+		r.fail("unsupported version " + std::to_string(version));
+
+	partial.n_trajectories = r.get<int32_t>();
+	partial.seed = r.get<uint64_t>();
+	for (auto count = r.get<uint64_t>(); count > 0; count--)
+	{
+		auto begin = r.get<uint64_t>();
+		partial.trajectory_ranges.emplace_back(begin, r.get<uint64_t>());
+	}
+
+	for (auto count = r.get<uint64_t>(); count > 0; count--)
+		partial.nodes.push_back(r.get_string());
+	partial.noninternals_mask = r.get_vector<state_word_t>();
+
+	partial.window_size = r.get<float>();
+	partial.max_time = r.get<float>();
+	partial.discrete_time = r.get<uint8_t>() != 0;
+
+	partial.final_states = r.get_map<sparse_histogram<int>>();
+
+	for (auto count = r.get<uint64_t>(); count > 0; count--)
+	{
+		auto state = r.get_vector<state_word_t>();
+		partial.fixed_points.emplace_hint(partial.fixed_points.end(), std::move(state), r.get<int32_t>());
+	}
+
+	partial.window_tr_entropies = r.get_vector<float>();
+	partial.window_probs.resize(partial.window_tr_entropies.size());
+	partial.window_probs_discrete.resize(partial.window_tr_entropies.size());
+	for (size_t i = 0; i < partial.window_tr_entropies.size(); i++)
+	{
+		if (partial.discrete_time)
+			partial.window_probs_discrete[i] = r.get_map<sparse_histogram<int>>();
+		else
+			partial.window_probs[i] = r.get_map<sparse_histogram<float>>();
+	}
+
+	partial.window_tr_entropy_squares = r.get_vector<double>();
+	if (!partial.window_tr_entropy_squares.empty()
+		&& partial.window_tr_entropy_squares.size() != partial.window_tr_entropies.size())
+		r.fail("invalid squares");
+
+	partial.window_prob_squares.resize(partial.window_tr_entropy_squares.size());
+	for (auto&& squares : partial.window_prob_squares)
+		squares = r.get_map<sparse_histogram<double>>();
+
+	if (!r.at_end())
+		r.fail("trailing data");
+
+	return partial;
+}
+
+void partial_results::merge(const partial_results& other)
+{
+	if (nodes != other.nodes || noninternals_mask != other.noninternals_mask)
+		throw std::runtime_error("partial: the results come from different models");
+
+	if (window_size != other.window_size || max_time != other.max_time || discrete_time != other.discrete_time
+		|| window_tr_entropies.size() != other.window_tr_entropies.size())
+		throw std::runtime_error("partial: the results come from different configurations");
+
+	if (seed != other.seed)
+		throw std::runtime_error("partial: the results come from different seeds");
+
+	for (const auto& [begin, end] : other.trajectory_ranges)
+		for (const auto& [merged_begin, merged_end] : trajectory_ranges)
+			if (begin < merged_end && merged_begin < end)
+				throw std::runtime_error("partial: the trajectories " + std::to_string(begin) + ":"
+										 + std::to_string(end) + " overlap the trajectories "
+										 + std::to_string(merged_begin) + ":" + std::to_string(merged_end));
+
+	n_trajectories += other.n_trajectories;
+	trajectory_ranges.insert(trajectory_ranges.end(), other.trajectory_ranges.begin(), other.trajectory_ranges.end());
+
+	add_histogram(final_states, other.final_states);
+
+	for (const auto& [state, count] : other.fixed_points)
+		fixed_points[state] += count;
+
+	for (size_t i = 0; i < window_tr_entropies.size(); i++)
+	{
+		window_tr_entropies[i] += other.window_tr_entropies[i];
+		add_histogram(window_probs[i], other.window_probs[i]);
+		add_histogram(window_probs_discrete[i], other.window_probs_discrete[i]);
+	}
+
+	if (window_tr_entropy_squares.empty() || other.window_tr_entropy_squares.empty())
+	{
+		window_prob_squares.clear();
+		window_tr_entropy_squares.clear();
+	}
+
+	for (size_t i = 0; i < window_tr_entropy_squares.size(); i++)
+	{
+		window_tr_entropy_squares[i] += other.window_tr_entropy_squares[i];
+		add_histogram(window_prob_squares[i], other.window_prob_squares[i]);
+	}
+}
+
+void write_partial_results(const std::string& path, const partial_results& partial)
+{
+	std::ofstream ofs(path, std::ios::binary);
+	if (ofs)
+	{
+		auto data = partial.serialize();
+		ofs.write(data.data(), data.size());
+	}
+}
+
+partial_results merge_partial_results(const std::vector<std::string>& paths)
+{
+	if (paths.empty())
+		throw std::runtime_error("partial: no results to merge");
+
+	partial_results merged;
+
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		std::ifstream ifs(paths[i], std::ios::binary);
+		if (!ifs)
+			throw std::runtime_error("cannot open " + paths[i]);
+
+		std::ostringstream ss;
+		ss << ifs.rdbuf();
+
+		try
+		{
+			auto partial = partial_results::deserialize(ss.str());
+
+			if (i == 0)
+				merged = std::move(partial);
+			else
+				merged.merge(partial);
+		}
+		catch (const std::runtime_error& e)
+		{
+			throw std::runtime_error(paths[i] + ": " + e.what());
+		}
+	}
+
+	return merged;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../state_word.h"
+#include "stats.h"
+
+// Raw sums accumulated by the stats over a range of trajectories, before they are divided into probabilities.
+// Shards simulating disjoint trajectory ranges of the same model and seed write them (the _partial.bin output) and
+// merging the shards sums them, so the merged results are those of a single run over all the ranges.
+struct partial_results
+{
+	static constexpr char magic_value[8] = { 'M', 'B', 'G', 'P', 'A', 'R', 'T', '\0' };
+	static constexpr uint32_t current_version = 2;
+
+	int n_trajectories = 0;
+	unsigned long long seed = 0;
+	// disjoint trajectory id ranges [first, second) accumulated into the sums
+	std::vector<std::pair<uint64_t, uint64_t>> trajectory_ranges;
+
+	std::vector<std::string> nodes;
+	std::vector<state_word_t> noninternals_mask;
+
+	float window_size = 0.f;
+	float max_time = 0.f;
+	bool discrete_time = false;
+
+	// final states occurences
+	sparse_histogram<int> final_states;
+
+	// fixed points occurences keyed by the state words
+	std::map<std::vector<state_word_t>, int> fixed_points;
+
+	// window sums, only one of window_probs and window_probs_discrete is filled depending on the time mode
+	std::vector<sparse_histogram<float>> window_probs;
+	std::vector<sparse_histogram<int>> window_probs_discrete;
+	std::vector<float> window_tr_entropies;
+
+	// sums of the squared per trajectory window values for the standard errors, empty if the backend does not
+	// estimate them
+	std::vector<sparse_histogram<double>> window_prob_squares;
+	std::vector<double> window_tr_entropy_squares;
+
+	std::string serialize() const;
+
+	// Throws std::runtime_error if the data are not a valid serialized partial_results
+	static partial_results deserialize(const std::string& data);
+
+	// Adds the sums of other, throws std::runtime_error if other comes from a different model, configuration or seed,
+	// or if the trajectory ranges overlap. The errors are dropped if only one of them has the squares.
+	void merge(const partial_results& other);
+};
+
+void write_partial_results(const std::string& path, const partial_results& partial);
+
+// Reads and merges the partial results files, throws std::runtime_error if they cannot be merged
+partial_results merge_partial_results(const std::vector<std::string>& paths);
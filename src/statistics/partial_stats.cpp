@@ -0,0 +1,85 @@
+#include "partial_stats.h"
+
+#include "final_states.h"
+#include "fixed_states.h"
+#include "window_average_small.h"
+
+namespace {
+
+// The reducers replay the sums of the partial results instead of accumulating batches
+
+class final_states_partial_reducer : public final_states_reducer
+{
+	const partial_results& partial_;
+
+public:
+	explicit final_states_partial_reducer(const partial_results& partial) : partial_(partial) {}
+
+	void process_batch(const trajectory_batch&) override {}
+
+	void finalize(sparse_histogram<int>& occurences) override { occurences = partial_.final_states; }
+};
+
+template <int state_words>
+class fixed_states_partial_reducer : public fixed_states_reducer<state_words>
+{
+	using result_t = typename fixed_states_reducer<state_words>::result_t;
+
+	int runtime_state_words_;
+	const partial_results& partial_;
+
+public:
+	fixed_states_partial_reducer(int runtime_state_words, const partial_results& partial)
+		: runtime_state_words_(runtime_state_words), partial_(partial)
+	{}
+
+	void process_batch(const trajectory_batch&) override {}
+
+	void finalize(result_t& result) override
+	{
+		for (const auto& [state, count] : partial_.fixed_points)
+			result[make_fixed_state<state_words>(state.data(), runtime_state_words_)] += count;
+	}
+};
+
+class window_average_partial_reducer : public window_average_small_reducer
+{
+	const partial_results& partial_;
+
+public:
+	explicit window_average_partial_reducer(const partial_results& partial) : partial_(partial) {}
+
+	void process_batch(const trajectory_batch&) override {}
+
+	void finalize(std::vector<sparse_histogram<float>>& probs, std::vector<sparse_histogram<int>>& probs_discrete,
+				  std::vector<float>& tr_entropies) override
+	{
+		probs = partial_.window_probs;
+		probs_discrete = partial_.window_probs_discrete;
+		tr_entropies = partial_.window_tr_entropies;
+	}
+
+	void finalize_squares(std::vector<sparse_histogram<double>>& prob_squares,
+						  std::vector<double>& tr_entropy_squares) override
+	{
+		prob_squares = partial_.window_prob_squares;
+		tr_entropy_squares = partial_.window_tr_entropy_squares;
+	}
+};
+
+} // namespace
+
+void add_partial_stats(stats_composite& stats_runner, const partial_results& partial)
+{
+	state_t noninternals_mask(partial.nodes.size(), partial.noninternals_mask.data());
+
+	stats_runner.add(std::make_unique<final_states_stats>(
+		noninternals_mask, std::make_unique<final_states_partial_reducer>(partial)));
+
+	fixed_states_stats_builder::add_fixed_states_stats<fixed_states_partial_reducer>(
+		stats_runner, noninternals_mask.words_n(), partial);
+
+	stats_runner.add(std::make_unique<window_average_small_stats>(
+		partial.window_size, partial.max_time, partial.discrete_time, noninternals_mask,
+		std::make_unique<window_average_partial_reducer>(partial)));
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "partial_results.h"
+#include "stats_composite.h"
+
+// Adds the final states, fixed states and window averages stats finalized from the sums of partial, so the merged
+// shards are written by the same stats as a single run. partial has to outlive the finalize of the stats.
+void add_partial_stats(stats_composite& stats_runner, const partial_results& partial);
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary columnar form of the window averages (the _probtraj output). The header is followed by plain arrays,
+// each starting at a multiple of 8 bytes, so a reader can use them in place from a memory-mapped file:
+//   window_times, transition_entropies, transition_entropy_errors, entropies   [windows_count] floats
+//   window_offsets   [windows_count + 1] entries of the window w are [window_offsets[w], window_offsets[w + 1])
+//   entry_states     [entries_count] index into the state dictionary
+//   entry_probs      [entries_count] probabilities of the entries
+//   entry_errors     [entries_count] standard errors of the probabilities, 0 when the backend does not estimate them
+//   state_indices    [states_count] non-internal state index of the dictionary states
+//   label_offsets    [states_count + 1] label of the state s is label_chars[label_offsets[s], label_offsets[s + 1])
+//   label_chars      [label_chars_count]
+struct probtraj_header
+{
+	static constexpr char magic_value[8] = { 'M', 'B', 'G', 'P', 'T', 'R', 'J', '\0' };
+	static constexpr uint32_t current_version = 2;
+
+	char magic[8];
+	uint32_t version;
+	uint32_t windows_count;
+	uint64_t entries_count;
+	uint64_t states_count;
+	uint64_t label_chars_count;
+	float window_size;
+	uint32_t reserved;
+};
+
+// Byte offsets of the arrays following the header
+struct probtraj_layout
+{
+	size_t window_times, transition_entropies, transition_entropy_errors, entropies, window_offsets, entry_states,
+		entry_probs, entry_errors, state_indices, label_offsets, label_chars, size;
+
+	explicit probtraj_layout(const probtraj_header& h)
+	{
+		size_t offset = sizeof(probtraj_header);
+		auto next = [&](size_t bytes) {
+			size_t begin = offset;
+			offset = (offset + bytes + 7) / 8 * 8;
+			return begin;
+		};
+
+		window_times = next(h.windows_count * sizeof(float));
+		transition_entropies = next(h.windows_count * sizeof(float));
+		transition_entropy_errors = next(h.windows_count * sizeof(float));
+		entropies = next(h.windows_count * sizeof(float));
+		window_offsets = next((h.windows_count + 1) * sizeof(uint64_t));
+		entry_states = next(h.entries_count * sizeof(uint32_t));
+		entry_probs = next(h.entries_count * sizeof(float));
+		entry_errors = next(h.entries_count * sizeof(float));
+		state_indices = next(h.states_count * sizeof(uint64_t));
+		label_offsets = next((h.states_count + 1) * sizeof(uint64_t));
+		label_chars = next(h.label_chars_count);
+		size = offset;
+	}
+};
+
+// Accumulates the windows one after another and serializes them into the binary form
+class probtraj_builder
+{
+	float window_size_;
+
+	std::vector<float> window_times_, transition_entropies_, transition_entropy_errors_, entropies_;
+	std::vector<uint64_t> window_offsets_ = { 0 };
+	std::vector<uint32_t> entry_states_;
+	std::vector<float> entry_probs_, entry_errors_;
+	std::vector<uint64_t> state_indices_;
+	std::vector<uint64_t> label_offsets_ = { 0 };
+	std::string label_chars_;
+
+	std::unordered_map<uint64_t, uint32_t> state_ids_;
+
+	template <typename T>
+	static void put(std::string& out, size_t offset, const std::vector<T>& values)
+	{
+		if (!values.empty())
+			std::memcpy(out.data() + offset, values.data(), values.size() * sizeof(T));
+	}
+
+public:
+	explicit probtraj_builder(float window_size) : window_size_(window_size) {}
+
+	// Returns the dictionary id of the non-internal state, label() is called only for the states not seen before
+	template <typename label_fn_t>
+	uint32_t add_state(uint64_t state_index, label_fn_t&& label)
+	{
+		auto [it, inserted] = state_ids_.try_emplace(state_index, (uint32_t)state_indices_.size());
+		if (inserted)
+		{
+			state_indices_.push_back(state_index);
+			label_chars_ += label();
+			label_offsets_.push_back(label_chars_.size());
+		}
+		return it->second;
+	}
+
+	void add_entry(uint32_t state_id, float prob, float error)
+	{
+		entry_states_.push_back(state_id);
+		entry_probs_.push_back(prob);
+		entry_errors_.push_back(error);
+	}
+
+	// Closes the window holding the entries added since the previous call
+	void end_window(float time, float transition_entropy, float transition_entropy_error, float entropy)
+	{
+		window_times_.push_back(time);
+		transition_entropies_.push_back(transition_entropy);
+		transition_entropy_errors_.push_back(transition_entropy_error);
+		entropies_.push_back(entropy);
+		window_offsets_.push_back(entry_states_.size());
+	}
+
+	std::string serialize() const
+	{
+		probtraj_header h = {};
+		std::memcpy(h.magic, probtraj_header::magic_value, sizeof(h.magic));
+		h.version = probtraj_header::current_version;
+		h.windows_count = window_times_.size();
+		h.entries_count = entry_states_.size();
+		h.states_count = state_indices_.size();
+		h.label_chars_count = label_chars_.size();
+		h.window_size = window_size_;
+
+		probtraj_layout layout(h);
+		std::string out(layout.size, '\0');
+
+		std::memcpy(out.data(), &h, sizeof(h));
+		put(out, layout.window_times, window_times_);
+		put(out, layout.transition_entropies, transition_entropies_);
+		put(out, layout.transition_entropy_errors, transition_entropy_errors_);
+		put(out, layout.entropies, entropies_);
+		put(out, layout.window_offsets, window_offsets_);
+		put(out, layout.entry_states, entry_states_);
+		put(out, layout.entry_probs, entry_probs_);
+		put(out, layout.entry_errors, entry_errors_);
+		put(out, layout.state_indices, state_indices_);
+		put(out, layout.label_offsets, label_offsets_);
+		std::memcpy(out.data() + layout.label_chars, label_chars_.data(), label_chars_.size());
+
+		return out;
+	}
+};
+
+// Non-owning access to the serialized window averages, the arrays point directly into the buffer
+class probtraj_view
+{
+	const char* data_;
+	probtraj_header header_;
+	probtraj_layout layout_;
+
+	template <typename T>
+	const T* at(size_t offset) const
+	{
+		return reinterpret_cast<const T*>(data_ + offset);
+	}
+
+	static probtraj_header read_header(const char* data, size_t size)
+	{
+		probtraj_header h;
+
+		if (size < sizeof(probtraj_header))
+			throw std::runtime_error("probtraj: truncated header");
+
+		std::memcpy(&h, data, sizeof(h));
+
+		if (std::memcmp(h.magic, probtraj_header::magic_value, sizeof(h.magic)) != 0)
+			throw std::runtime_error("probtraj: bad magic");
+		if (h.version != probtraj_header::current_version)
+			throw std::runtime_error("probtraj: unsupported version " + std::to_string(h.version));
+
+		// every array has to fit into the data on its own, so the layout computed from the counts cannot overflow
+		if (h.entries_count > size / sizeof(uint32_t) || h.states_count >= size / sizeof(uint64_t)
+			|| h.label_chars_count > size)
+			throw std::runtime_error("probtraj: truncated data");
+
+		return h;
+	}
+
+	// The offsets have to start at 0, grow and end at the size of the array they index
+	static void check_offsets(const uint64_t* offsets, uint64_t count, uint64_t end, const char* name)
+	{
+		if (offsets[0] != 0 || offsets[count] != end)
+			throw std::runtime_error(std::string("probtraj: invalid ") + name);
+
+		for (uint64_t i = 0; i < count; i++)
+			if (offsets[i] > offsets[i + 1])
+				throw std::runtime_error(std::string("probtraj: invalid ") + name);
+	}
+
+public:
+	// The buffer has to be 8 bytes aligned and outlive the view. The arrays are checked against the header once, so
+	// a corrupted buffer throws here instead of being read out of its bounds later.
+	probtraj_view(const void* data, size_t size)
+		: data_(static_cast<const char*>(data)), header_(read_header(data_, size)), layout_(header_)
+	{
+		if (layout_.size > size)
+			throw std::runtime_error("probtraj: truncated data");
+
+		check_offsets(window_offsets(), header_.windows_count, header_.entries_count, "window offsets");
+		check_offsets(at<uint64_t>(layout_.label_offsets), header_.states_count, header_.label_chars_count,
+					  "label offsets");
+
+		const uint32_t* states = entry_states();
+		if (std::any_of(states, states + header_.entries_count, [&](uint32_t s) { return s >= header_.states_count; }))
+			throw std::runtime_error("probtraj: invalid entry states");
+	}
+
+	uint32_t windows_count() const { return header_.windows_count; }
+	uint64_t entries_count() const { return header_.entries_count; }
+	uint64_t states_count() const { return header_.states_count; }
+	float window_size() const { return header_.window_size; }
+
+	const float* window_times() const { return at<float>(layout_.window_times); }
+	const float* transition_entropies() const { return at<float>(layout_.transition_entropies); }
+	const float* transition_entropy_errors() const { return at<float>(layout_.transition_entropy_errors); }
+	const float* entropies() const { return at<float>(layout_.entropies); }
+	const uint64_t* window_offsets() const { return at<uint64_t>(layout_.window_offsets); }
+	const uint32_t* entry_states() const { return at<uint32_t>(layout_.entry_states); }
+	const float* entry_probs() const { return at<float>(layout_.entry_probs); }
+	const float* entry_errors() const { return at<float>(layout_.entry_errors); }
+	const uint64_t* state_indices() const { return at<uint64_t>(layout_.state_indices); }
+
+	std::string_view state_label(uint32_t state) const
+	{
+		auto offsets = at<uint64_t>(layout_.label_offsets);
+		return std::string_view(at<char>(layout_.label_chars) + offsets[state], offsets[state + 1] - offsets[state]);
+	}
+};
+
+// Memory-mapped probtraj file
+class probtraj_file
+{
+	void* data_ = MAP_FAILED;
+	size_t size_ = 0;
+
+public:
+	explicit probtraj_file(const std::string& path)
+	{
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd == -1)
+			throw std::runtime_error("probtraj: cannot open " + path);
+
+		struct stat st;
+		if (fstat(fd, &st) == 0)
+		{
+			size_ = st.st_size;
+			data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		}
+		close(fd);
+
+		if (data_ == MAP_FAILED)
+			throw std::runtime_error("probtraj: cannot map " + path);
+	}
+
+	~probtraj_file()
+	{
+		if (data_ != MAP_FAILED)
+			munmap(data_, size_);
+	}
+
+	probtraj_file(const probtraj_file&) = delete;
+	probtraj_file& operator=(const probtraj_file&) = delete;
+
+	probtraj_view view() const { return probtraj_view(data_, size_); }
+};
+
+// Writes the window averages in the tab separated _probtraj.csv format
+inline void write_probtraj_csv(const probtraj_view& view, std::ostream& os)
+{
+	const auto offsets = view.window_offsets();
+	const auto states = view.entry_states();
+	const auto probs = view.entry_probs();
+	const auto errors = view.entry_errors();
+
+	// Computing max states for header
+	uint64_t max_states = 0;
+	for (uint32_t i = 0; i < view.windows_count(); ++i)
+		max_states = std::max(max_states, offsets[i + 1] - offsets[i]);
+
+	// Writing header
+	os << "Time\tTH\tErrorTH\tH\tHD=0";
+	for (uint64_t i = 0; i < max_states; i++)
+	{
+		os << "\tState\tProba\tErrorProba";
+	}
+	os << std::endl;
+
+	// Writing trajectories
+	for (uint32_t i = 0; i < view.windows_count(); ++i)
+	{
+		os << view.window_times()[i] << "\t";
+		os << view.transition_entropies()[i] << "\t" << view.transition_entropy_errors()[i] << "\t"
+		   << view.entropies()[i] << "\t" << 0.f;
+
+		for (uint64_t e = offsets[i]; e < offsets[i + 1]; e++)
+			os << "\t" << view.state_label(states[e]) << "\t" << probs[e] << "\t" << errors[e];
+
+		os << std::endl;
+	}
+}
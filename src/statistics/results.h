@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Results of a simulation in plain arrays, handed over without the text formatting (e.g. to the Python bindings)
+struct simulation_results
+{
+	int n_trajectories = 0;
+
+	// window averages in the binary _probtraj form, see probtraj_format.h
+	std::string probtraj;
+
+	// final states, non-internal state index, probability and label of each visited state
+	std::vector<uint64_t> final_state_indices;
+	std::vector<float> final_state_probs;
+	std::vector<std::string> final_state_labels;
+
+	// fixed points, probability, label and the value of every node (row-major [fixed points x nodes])
+	std::vector<float> fixed_point_probs;
+	std::vector<std::string> fixed_point_labels;
+	std::vector<uint8_t> fixed_point_nodes;
+};
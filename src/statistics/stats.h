@@ -1,29 +1,113 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
-#include <thrust/device_ptr.h>
-
 #include "../state_word.h"
 #include "../trajectory_status.h"
+#include "results.h"
 
+class binary_reader;
+class binary_writer;
 class stats;
+struct partial_results;
 
 using stats_ptr = std::unique_ptr<stats>;
 
+// Non-owning view of the trajectory buffers filled by one simulation batch.
+// The buffers reside in the device memory for the CUDA backend and in the host memory for the host backend.
+struct trajectory_batch
+{
+	state_word_t* traj_states;
+	float* traj_times;
+	float* traj_tr_entropies;
+	state_word_t* last_states;
+	trajectory_status* traj_statuses;
+	int n_trajectories;
+};
+
+// Accumulated values of the visited non-internal states keyed by the non-internal state index in ascending order
+template <typename T>
+using sparse_histogram = std::map<uint64_t, T>;
+
+// Appends the nonzero cells of a histogram densely indexed by the non-internal state index
+template <typename T>
+void append_nonzero(const T* dense, size_t count, sparse_histogram<T>& sparse)
+{
+	for (size_t i = 0; i < count; i++)
+		if (dense[i] != 0)
+			sparse.emplace_hint(sparse.end(), i, dense[i]);
+}
+
+// Half-width of the 95% Wilson score interval of a probability estimated over n_trajectories. Unlike the normal
+// approximation it stays positive at 0 and 1, where a few trajectories would otherwise look exact. The values of
+// a window probability per trajectory lie in [0, 1], so their variance is at most prob * (1 - prob) and the width
+// bounds the window probabilities too.
+inline float confidence_half_width(float prob, int n_trajectories)
+{
+	constexpr float z = 1.96f;
+
+	prob = std::clamp(prob, 0.f, 1.f);
+	float n = n_trajectories;
+	return z * std::sqrt(prob * (1.f - prob) / n + z * z / (4.f * n * n)) / (1.f + z * z / n);
+}
+
+// Receives the steps of the trajectories right as they are simulated, in place of the trajectory buffers. The host
+// runner calls begin_batch before a batch is simulated, then add_step for every step and end_trajectory once a
+// trajectory leaves its batch slot, concurrently for the slots of different workers.
+class step_accumulator
+{
+public:
+	virtual ~step_accumulator() = default;
+
+	virtual void begin_batch(int n_trajectories) = 0;
+
+	// The trajectory in the slot traj spent the time [begin_time, end_time) in state
+	virtual void add_step(int traj, int worker, const state_word_t* state, float begin_time, float end_time,
+						  float tr_entropy) = 0;
+
+	virtual void end_trajectory(int traj, int worker, trajectory_status status) = 0;
+};
+
 class stats
 {
 public:
 	virtual ~stats() = default;
 
-	virtual void process_batch(thrust::device_ptr<state_word_t> traj_states, thrust::device_ptr<float> traj_times,
-							   thrust::device_ptr<float> traj_tr_entropies,
-							   thrust::device_ptr<state_word_t> last_states,
-							   thrust::device_ptr<trajectory_status> traj_statuses, int n_trajectories) = 0;
+	virtual void process_batch(const trajectory_batch& batch) = 0;
+
+	// Switches the stats to take the steps from the returned accumulator, their process_batch gets the batches without
+	// the trajectory buffers then. The stats reading only the last states return null.
+	virtual step_accumulator* fuse() { throw std::runtime_error("the stats need the trajectory buffers"); }
 
 	virtual void finalize() {}
 
 	virtual void visualize(int n_trajectories, const std::vector<std::string>& nodes) = 0;
 	virtual void write_csv(int n_trajectories, const std::vector<std::string>& nodes, const std::string& prefix) = 0;
+
+	// Stats without a binary form write the CSV output
+	virtual void write_binary(int n_trajectories, const std::vector<std::string>& nodes, const std::string& prefix)
+	{
+		write_csv(n_trajectories, nodes, prefix);
+	}
+
+	// Stores the finalized results into their part of results
+	virtual void export_results(int n_trajectories, const std::vector<std::string>& nodes,
+								simulation_results& results) = 0;
+
+	// Stores the finalized sums into their part of partial, before they are divided by the trajectories count
+	virtual void export_partial(partial_results& partial) = 0;
+
+	// Largest confidence_half_width of the probabilities accumulated so far over n_trajectories, before finalize
+	virtual float max_error(int n_trajectories) = 0;
+
+	// Serializes the accumulated state into a checkpoint and restores it when the run is resumed
+	virtual void save(binary_writer& w) const = 0;
+	virtual void load(binary_reader& r) = 0;
 };
@@ -2,13 +2,19 @@
 
 void stats_composite::add(stats_ptr&& stat) { composed_stats_.emplace_back(std::move(stat)); }
 
-void stats_composite::process_batch(thrust::device_ptr<state_word_t> traj_states, thrust::device_ptr<float> traj_times,
-									thrust::device_ptr<float> traj_tr_entropies,
-									thrust::device_ptr<state_word_t> last_states,
-									thrust::device_ptr<trajectory_status> traj_statuses, int n_trajectories)
+void stats_composite::process_batch(const trajectory_batch& batch)
 {
 	for (auto&& stat : composed_stats_)
-		stat->process_batch(traj_states, traj_times, traj_tr_entropies, last_states, traj_statuses, n_trajectories);
+		stat->process_batch(batch);
+}
+
+std::vector<step_accumulator*> stats_composite::fuse()
+{
+	std::vector<step_accumulator*> accumulators;
+	for (auto&& stat : composed_stats_)
+		if (auto accumulator = stat->fuse())
+			accumulators.push_back(accumulator);
+	return accumulators;
 }
 
 void stats_composite::finalize()
@@ -28,3 +34,45 @@ void stats_composite::write_csv(int n_trajectories, const std::vector<std::strin
 	for (auto&& stat : composed_stats_)
 		stat->write_csv(n_trajectories, nodes, prefix);
 }
+
+void stats_composite::write_binary(int n_trajectories, const std::vector<std::string>& nodes,
+								   const std::string& prefix)
+{
+	for (auto&& stat : composed_stats_)
+		stat->write_binary(n_trajectories, nodes, prefix);
+}
+
+void stats_composite::export_results(int n_trajectories, const std::vector<std::string>& nodes,
+									 simulation_results& results)
+{
+	results.n_trajectories = n_trajectories;
+
+	for (auto&& stat : composed_stats_)
+		stat->export_results(n_trajectories, nodes, results);
+}
+
+void stats_composite::export_partial(partial_results& partial)
+{
+	for (auto&& stat : composed_stats_)
+		stat->export_partial(partial);
+}
+
+float stats_composite::max_error(int n_trajectories)
+{
+	float error = 0.f;
+	for (auto&& stat : composed_stats_)
+		error = std::max(error, stat->max_error(n_trajectories));
+	return error;
+}
+
+void stats_composite::save(binary_writer& w) const
+{
+	for (auto&& stat : composed_stats_)
+		stat->save(w);
+}
+
+void stats_composite::load(binary_reader& r)
+{
+	for (auto&& stat : composed_stats_)
+		stat->load(r);
+}
@@ -9,12 +9,22 @@ class stats_composite
 public:
 	void add(stats_ptr&& stat);
 
-	void process_batch(thrust::device_ptr<state_word_t> traj_states, thrust::device_ptr<float> traj_times,
-					   thrust::device_ptr<float> traj_tr_entropies, thrust::device_ptr<state_word_t> last_states,
-					   thrust::device_ptr<trajectory_status> traj_statuses, int n_trajectories);
+	void process_batch(const trajectory_batch& batch);
+
+	// Fuses the composed stats, the accumulators of those reading the steps are returned
+	std::vector<step_accumulator*> fuse();
 
 	void finalize();
 
 	void visualize(int n_trajectories, const std::vector<std::string>& nodes);
 	void write_csv(int n_trajectories, const std::vector<std::string>& nodes, const std::string& prefix);
+	void write_binary(int n_trajectories, const std::vector<std::string>& nodes, const std::string& prefix);
+	void export_results(int n_trajectories, const std::vector<std::string>& nodes, simulation_results& results);
+	void export_partial(partial_results& partial);
+
+	// Largest max_error of the composed stats
+	float max_error(int n_trajectories);
+
+	void save(binary_writer& w) const;
+	void load(binary_reader& r);
 };
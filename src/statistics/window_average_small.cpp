@@ -1,112 +1,54 @@
 #include "window_average_small.h"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
-
-#include <thrust/device_free.h>
-#include <thrust/device_malloc.h>
+#include <iostream>
 
 #include "../timer.h"
+#include "partial_results.h"
+
+namespace {
+
+// Standard error of the mean of the per trajectory values given their mean and the sum of their squares
+float standard_error(float mean, double squares, int n_trajectories)
+{
+	if (n_trajectories < 2)
+		return 0.f;
+
+	double variance = (squares - (double)n_trajectories * mean * mean) / (n_trajectories - 1);
+	return std::sqrt(std::max(variance, 0.) / n_trajectories);
+}
+
+} // namespace
 
 window_average_small_stats::window_average_small_stats(float window_size, float max_time, bool discrete_time,
-													   state_t noninternals_mask, size_t non_internals,
-													   size_t max_traj_len, size_t max_n_trajectories,
-													   kernel_wrapper& window_average_small)
+													   state_t noninternals_mask,
+													   window_average_small_reducer_ptr reducer)
 	: window_size_(window_size),
 	  max_time_(max_time),
 	  discrete_time_(discrete_time),
-	  noninternal_states_count_(1 << non_internals),
 	  noninternals_mask_(std::move(noninternals_mask)),
-	  max_traj_len_(max_traj_len),
-	  max_n_trajectories_(max_n_trajectories),
-	  window_average_small_(window_average_small)
+	  reducer_(std::move(reducer))
 {
-	timer_stats stats("window_average_small> initialize");
-
 	size_t windows_count = std::ceil(max_time / window_size);
 
-	window_tr_entropies_ = thrust::device_malloc<float>(windows_count);
 	result_tr_entropies_.resize(windows_count);
-	CUDA_CHECK(cudaMemset(window_tr_entropies_.get(), 0, windows_count * sizeof(float)));
-
-	if (discrete_time)
-	{
-		window_probs_discrete_ = thrust::device_malloc<int>(windows_count * noninternal_states_count_);
-		result_probs_discrete_.resize(windows_count * noninternal_states_count_);
-		CUDA_CHECK(
-			cudaMemset(window_probs_discrete_.get(), 0, windows_count * noninternal_states_count_ * sizeof(int)));
-	}
-	else
-	{
-		window_probs_ = thrust::device_malloc<float>(windows_count * noninternal_states_count_);
-		result_probs_.resize(windows_count * noninternal_states_count_);
-		CUDA_CHECK(cudaMemset(window_probs_.get(), 0, windows_count * noninternal_states_count_ * sizeof(float)));
-	}
-}
-
-window_average_small_stats::~window_average_small_stats()
-{
-	timer_stats stats("window_average_small> free");
-
-	thrust::device_free(window_probs_);
-	thrust::device_free(window_probs_discrete_);
-	thrust::device_free(window_tr_entropies_);
-}
-
-void window_average_small_stats::process_batch(thrust::device_ptr<state_word_t> traj_states,
-											   thrust::device_ptr<float> traj_times,
-											   thrust::device_ptr<float> traj_tr_entropies,
-											   thrust::device_ptr<state_word_t>, thrust::device_ptr<trajectory_status>,
-											   int n_trajectories)
-{
-	process_batch_internal(traj_states, traj_times, traj_tr_entropies, n_trajectories);
+	result_probs_discrete_.resize(windows_count);
+	result_probs_.resize(windows_count);
 }
 
-void window_average_small_stats::process_batch_internal(thrust::device_ptr<state_word_t> traj_states,
-														thrust::device_ptr<float> traj_times,
-														thrust::device_ptr<float> traj_tr_entropies, int n_trajectories)
-{
-	timer_stats stats("window_average_small> process_batch");
-
-	int windows_count = std::ceil(max_time_ / window_size_);
-	int shared_mem_size = sizeof(float) * windows_count;
-
-	bool extra_shared_mem = false;
-
-	assert(sizeof(float) == sizeof(int));
-
-	if (shared_mem_size + sizeof(float) * noninternal_states_count_ * windows_count < 10 * 1024)
-	{
-		shared_mem_size += sizeof(float) * noninternal_states_count_ * windows_count;
-		extra_shared_mem = true;
-	}
-
-	window_average_small_.run_shared(
-		dim3(DIV_UP(n_trajectories * (max_traj_len_ - 1), 256)), dim3(256), shared_mem_size, max_traj_len_,
-		n_trajectories, (int)noninternals_mask_.words_n(), noninternal_states_count_, window_size_, windows_count,
-		extra_shared_mem, traj_states.get(), traj_times.get(), traj_tr_entropies.get(),
-		discrete_time_ ? (void*)window_probs_discrete_.get() : (void*)window_probs_.get(), window_tr_entropies_.get());
-}
+void window_average_small_stats::process_batch(const trajectory_batch& batch) { reducer_->process_batch(batch); }
 
 void window_average_small_stats::finalize()
 {
 	timer_stats stats("window_average_small> finalize");
 
-	size_t windows_count = std::ceil(max_time_ / window_size_);
-	timer t;
-
-	// copy result data into host
-	if (discrete_time_)
-		CUDA_CHECK(cudaMemcpy(result_probs_discrete_.data(), window_probs_discrete_.get(),
-							  windows_count * noninternal_states_count_ * sizeof(int), cudaMemcpyDeviceToHost));
-	else
-		CUDA_CHECK(cudaMemcpy(result_probs_.data(), window_probs_.get(),
-							  windows_count * noninternal_states_count_ * sizeof(float), cudaMemcpyDeviceToHost));
-	CUDA_CHECK(cudaMemcpy(result_tr_entropies_.data(), window_tr_entropies_.get(), windows_count * sizeof(float),
-						  cudaMemcpyDeviceToHost));
+	reducer_->finalize(result_probs_, result_probs_discrete_, result_tr_entropies_);
+	reducer_->finalize_squares(result_prob_squares_, result_tr_entropy_squares_);
 }
 
-state_t window_average_small_stats::non_internal_idx_to_state(const state_t& noninternals_mask, int idx)
+state_t window_average_small_stats::non_internal_idx_to_state(const state_t& noninternals_mask, uint64_t idx)
 {
 	state_t ret(noninternals_mask.state_size);
 	size_t idx_i = 0;
@@ -114,7 +56,7 @@ state_t window_average_small_stats::non_internal_idx_to_state(const state_t& non
 	{
 		if (noninternals_mask.is_set(i))
 		{
-			if ((idx & (1 << idx_i)) != 0)
+			if ((idx & ((uint64_t)1 << idx_i)) != 0)
 				ret.set(i);
 			idx_i++;
 		}
@@ -123,20 +65,23 @@ state_t window_average_small_stats::non_internal_idx_to_state(const state_t& non
 	return ret;
 }
 
-float window_average_small_stats::get_single_result_prob(int n_trajectories, size_t idx)
+std::vector<std::pair<uint64_t, float>> window_average_small_stats::get_window_probs(int n_trajectories,
+																					   size_t window_idx)
 {
+	std::vector<std::pair<uint64_t, float>> probs;
+
 	if (discrete_time_)
 	{
-		auto occurences = result_probs_discrete_[idx];
-
-		return (float)occurences / (float)n_trajectories;
+		for (const auto& [idx, occurences] : result_probs_discrete_[window_idx])
+			probs.emplace_back(idx, (float)occurences / (float)n_trajectories);
 	}
 	else
 	{
-		auto cumul_slices = result_probs_[idx];
-
-		return cumul_slices / (n_trajectories * window_size_);
+		for (const auto& [idx, cumul_slices] : result_probs_[window_idx])
+			probs.emplace_back(idx, cumul_slices / (n_trajectories * window_size_));
 	}
+
+	return probs;
 }
 
 void window_average_small_stats::visualize(int n_trajectories, const std::vector<std::string>& nodes)
@@ -151,10 +96,10 @@ void window_average_small_stats::visualize(int n_trajectories, const std::vector
 		float wnd_tr_entropy = result_tr_entropies_[i] / n_trajectories;
 		wnd_tr_entropy /= discrete_time_ ? 1 : window_size_;
 
-		for (uint32_t s_idx = 0; s_idx < noninternal_states_count_; s_idx++)
-		{
-			auto prob = get_single_result_prob(n_trajectories, i * noninternal_states_count_ + s_idx);
+		auto probs = get_window_probs(n_trajectories, i);
 
+		for (const auto& [s_idx, prob] : probs)
+		{
 			if (prob == 0.f)
 				continue;
 
@@ -165,10 +110,8 @@ void window_average_small_stats::visualize(int n_trajectories, const std::vector
 		std::cout << "entropy: " << entropy << std::endl;
 		std::cout << "transition entropy: " << wnd_tr_entropy << std::endl;
 
-		for (uint32_t s_idx = 0; s_idx < noninternal_states_count_; s_idx++)
+		for (const auto& [s_idx, prob] : probs)
 		{
-			auto prob = get_single_result_prob(n_trajectories, i * noninternal_states_count_ + s_idx);
-
 			if (prob == 0.f)
 				continue;
 
@@ -178,73 +121,121 @@ void window_average_small_stats::visualize(int n_trajectories, const std::vector
 	}
 }
 
-void window_average_small_stats::write_csv(int n_trajectories, const std::vector<std::string>& nodes,
-										   const std::string& prefix)
+probtraj_builder window_average_small_stats::build_probtraj(int n_trajectories,
+															 const std::vector<std::string>& nodes)
 {
-	timer_stats stats("window_average_small> write_csv");
-
 	size_t windows_count = std::ceil(max_time_ / window_size_);
-	std::ofstream ofs;
+	probtraj_builder builder(window_size_);
 
-	ofs.open(prefix + "_probtraj.csv");
-	if (ofs)
+	// the squares are of the trajectory values before they are divided by the window size
+	bool has_errors = !result_tr_entropy_squares_.empty();
+	double square_scale = discrete_time_ ? 1. : (double)window_size_ * window_size_;
+
+	for (size_t i = 0; i < windows_count; ++i)
 	{
-		// Computing max states for header
-		int max_states = 0;
-		for (size_t i = 0; i < windows_count; ++i)
+		float entropy = 0.f;
+		float wnd_tr_entropy = result_tr_entropies_[i] / n_trajectories;
+		wnd_tr_entropy /= discrete_time_ ? 1 : window_size_;
+
+		float wnd_tr_entropy_error =
+			has_errors ? standard_error(wnd_tr_entropy, result_tr_entropy_squares_[i] / square_scale, n_trajectories)
+					   : 0.f;
+
+		for (const auto& [s_idx, prob] : get_window_probs(n_trajectories, i))
 		{
-			int num_states = 0;
-			for (uint32_t s_idx = 0; s_idx < noninternal_states_count_; s_idx++)
-			{
-				auto prob = get_single_result_prob(n_trajectories, i * noninternal_states_count_ + s_idx);
+			if (prob == 0.f)
+				continue;
 
-				if (prob == 0.f)
-					continue;
+			entropy += -std::log2(prob) * prob;
 
-				num_states += 1;
+			float error = 0.f;
+			if (has_errors)
+			{
+				auto squares = result_prob_squares_[i].find(s_idx);
+				if (squares != result_prob_squares_[i].end())
+					error = standard_error(prob, squares->second / square_scale, n_trajectories);
 			}
 
-			max_states = std::max(max_states, num_states);
+			auto state_id = builder.add_state(
+				s_idx, [&] { return non_internal_idx_to_state(noninternals_mask_, s_idx).to_string(nodes); });
+			builder.add_entry(state_id, prob, error);
 		}
 
-		// Writing header
-		ofs << "Time\tTH\tErrorTH\tH\tHD=0";
-		for (int i = 0; i < max_states; i++)
-		{
-			ofs << "\tState\tProba\tErrorProba";
-		}
-		ofs << std::endl;
+		builder.end_window(i * window_size_, wnd_tr_entropy, wnd_tr_entropy_error, entropy);
+	}
 
-		// Writing trajectories
-		for (size_t i = 0; i < windows_count; ++i)
-		{
-			float entropy = 0.f;
-			float wnd_tr_entropy = result_tr_entropies_[i] / n_trajectories;
-			wnd_tr_entropy /= discrete_time_ ? 1 : window_size_;
+	return builder;
+}
 
-			for (uint32_t s_idx = 0; s_idx < noninternal_states_count_; s_idx++)
-			{
-				auto prob = get_single_result_prob(n_trajectories, i * noninternal_states_count_ + s_idx);
+void window_average_small_stats::write_csv(int n_trajectories, const std::vector<std::string>& nodes,
+										   const std::string& prefix)
+{
+	timer_stats stats("window_average_small> write_csv");
 
-				if (prob == 0.f)
-					continue;
+	std::ofstream ofs;
 
-				entropy += -std::log2(prob) * prob;
-			}
-			ofs << i * window_size_ << "\t";
-			ofs << wnd_tr_entropy << "\t" << 0.f << "\t" << entropy << "\t" << 0.f;
+	ofs.open(prefix + "_probtraj.csv");
+	if (ofs)
+	{
+		auto data = build_probtraj(n_trajectories, nodes).serialize();
+		write_probtraj_csv(probtraj_view(data.data(), data.size()), ofs);
+	}
+}
 
-			for (uint32_t s_idx = 0; s_idx < noninternal_states_count_; s_idx++)
-			{
-				auto prob = get_single_result_prob(n_trajectories, i * noninternal_states_count_ + s_idx);
+void window_average_small_stats::write_binary(int n_trajectories, const std::vector<std::string>& nodes,
+											  const std::string& prefix)
+{
+	timer_stats stats("window_average_small> write_binary");
 
-				if (prob == 0.f)
-					continue;
+	std::ofstream ofs;
 
-				ofs << "\t" << non_internal_idx_to_state(noninternals_mask_, s_idx).to_string(nodes) << "\t" << prob
-					<< "\t" << 0.f;
-			}
-			ofs << std::endl;
-		}
+	ofs.open(prefix + "_probtraj.bin", std::ios::binary);
+	if (ofs)
+	{
+		auto data = build_probtraj(n_trajectories, nodes).serialize();
+		ofs.write(data.data(), data.size());
+	}
+}
+
+void window_average_small_stats::export_results(int n_trajectories, const std::vector<std::string>& nodes,
+												simulation_results& results)
+{
+	results.probtraj = build_probtraj(n_trajectories, nodes).serialize();
+}
+
+void window_average_small_stats::export_partial(partial_results& partial)
+{
+	partial.window_size = window_size_;
+	partial.max_time = max_time_;
+	partial.discrete_time = discrete_time_;
+	partial.window_probs = result_probs_;
+	partial.window_probs_discrete = result_probs_discrete_;
+	partial.window_tr_entropies = result_tr_entropies_;
+	partial.window_prob_squares = result_prob_squares_;
+	partial.window_tr_entropy_squares = result_tr_entropy_squares_;
+}
+
+float window_average_small_stats::max_error(int n_trajectories)
+{
+	size_t windows_count = result_tr_entropies_.size();
+	std::vector<sparse_histogram<float>> probs(windows_count);
+	std::vector<sparse_histogram<int>> probs_discrete(windows_count);
+	std::vector<float> tr_entropies(windows_count);
+	reducer_->finalize(probs, probs_discrete, tr_entropies);
+
+	// the trajectories still running have filled only their first windows, which slightly overestimates them
+	float error = 0.f;
+	for (size_t i = 0; i < windows_count; i++)
+	{
+		for (const auto& [idx, occurences] : probs_discrete[i])
+			error = std::max(error, confidence_half_width((float)occurences / n_trajectories, n_trajectories));
+		for (const auto& [idx, cumul_slices] : probs[i])
+			error = std::max(error,
+							 confidence_half_width(cumul_slices / (n_trajectories * window_size_), n_trajectories));
 	}
+	return error;
 }
+
+void window_average_small_stats::save(binary_writer& w) const { reducer_->save(w); }
+
+void window_average_small_stats::load(binary_reader& r) { reducer_->load(r); }
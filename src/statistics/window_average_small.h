@@ -1,53 +1,86 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
-#include "../kernel.h"
 #include "../state.h"
+#include "probtraj_format.h"
 #include "stats.h"
 
+// Backend specific accumulation of the time spent in the non-internal states per window
+class window_average_small_reducer
+{
+public:
+	virtual ~window_average_small_reducer() = default;
+
+	virtual void process_batch(const trajectory_batch& batch) = 0;
+
+	// Takes the steps from the returned accumulator instead of the trajectory buffers of the batches
+	virtual step_accumulator* fuse() { throw std::runtime_error("the reducer does not support fused stats"); }
+
+	// Stores the accumulated sums of the visited states per window, probs and probs_discrete are sized to the windows
+	// count and only one of them is filled depending on the time mode
+	virtual void finalize(std::vector<sparse_histogram<float>>& probs,
+						  std::vector<sparse_histogram<int>>& probs_discrete, std::vector<float>& tr_entropies) = 0;
+
+	// Stores the sums over the trajectories of their squared values per window, the values being the trajectory parts
+	// of the finalized probs (or probs_discrete) and tr_entropies. The reducers leaving them empty do not estimate the
+	// errors.
+	virtual void finalize_squares(std::vector<sparse_histogram<double>>&, std::vector<double>&) {}
+
+	// Serializes the accumulated state into a checkpoint and restores it, the reducers without the support cannot be
+	// checkpointed
+	virtual void save(binary_writer&) const { throw std::runtime_error("the reducer does not support checkpoints"); }
+	virtual void load(binary_reader&) { throw std::runtime_error("the reducer does not support checkpoints"); }
+};
+
+using window_average_small_reducer_ptr = std::unique_ptr<window_average_small_reducer>;
+
 class window_average_small_stats : public stats
 {
-	std::vector<float> result_probs_, result_tr_entropies_;
-	std::vector<int> result_probs_discrete_;
+	std::vector<sparse_histogram<float>> result_probs_;
+	std::vector<sparse_histogram<int>> result_probs_discrete_;
+	std::vector<float> result_tr_entropies_;
+	// empty if the reducer does not estimate the errors
+	std::vector<sparse_histogram<double>> result_prob_squares_;
+	std::vector<double> result_tr_entropy_squares_;
 
 	float window_size_;
 	float max_time_;
 	bool discrete_time_;
-	uint32_t noninternal_states_count_;
 
 	state_t noninternals_mask_;
 
-	size_t max_traj_len_;
-	size_t max_n_trajectories_;
-
-	kernel_wrapper& window_average_small_;
+	window_average_small_reducer_ptr reducer_;
 
-	thrust::device_ptr<float> window_probs_, window_tr_entropies_;
-	thrust::device_ptr<int> window_probs_discrete_;
+	// Nonzero probabilities of the window in the ascending order of the non-internal state index
+	std::vector<std::pair<uint64_t, float>> get_window_probs(int n_trajectories, size_t window_idx);
 
-	float get_single_result_prob(int n_trajectories, size_t idx);
+	// Columnar form of the nonzero window probabilities, the CSV output is exported from it
+	probtraj_builder build_probtraj(int n_trajectories, const std::vector<std::string>& nodes);
 
 public:
-	static state_t non_internal_idx_to_state(const state_t& noninternals_mask, int idx);
+	static state_t non_internal_idx_to_state(const state_t& noninternals_mask, uint64_t idx);
 
 	window_average_small_stats(float window_size, float max_time, bool discrete_time, state_t noninternals_mask,
-							   size_t non_internals, size_t max_traj_len, size_t max_n_trajectories,
-							   kernel_wrapper& window_average_small);
-
-	~window_average_small_stats();
+							   window_average_small_reducer_ptr reducer);
 
-	void process_batch_internal(thrust::device_ptr<state_word_t> traj_states, thrust::device_ptr<float> traj_times,
-								thrust::device_ptr<float> traj_tr_entropies, int n_trajectories_batch);
+	void process_batch(const trajectory_batch& batch) override;
 
-	void process_batch(thrust::device_ptr<state_word_t> traj_states, thrust::device_ptr<float> traj_times,
-					   thrust::device_ptr<float> traj_tr_entropies, thrust::device_ptr<state_word_t> last_states,
-					   thrust::device_ptr<trajectory_status> traj_statuses, int n_trajectories) override;
+	step_accumulator* fuse() override { return reducer_->fuse(); }
 
 	void finalize() override;
 
 	void visualize(int n_trajectories, const std::vector<std::string>& nodes) override;
 	void write_csv(int n_trajectories, const std::vector<std::string>& nodes, const std::string& prefix) override;
+	void write_binary(int n_trajectories, const std::vector<std::string>& nodes, const std::string& prefix) override;
+	void export_results(int n_trajectories, const std::vector<std::string>& nodes,
+						simulation_results& results) override;
+	void export_partial(partial_results& partial) override;
+	float max_error(int n_trajectories) override;
+	void save(binary_writer& w) const override;
+	void load(binary_reader& r) override;
 };
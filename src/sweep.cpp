@@ -0,0 +1,158 @@
+#include "sweep.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <sstream>
+
+namespace {
+
+bool parse_value(const std::string& text, float& value)
+{
+	size_t parsed = 0;
+	try
+	{
+		value = std::stof(text, &parsed);
+	}
+	catch (const std::exception&)
+	{
+		parsed = 0;
+	}
+
+	return parsed != 0 && parsed == text.size();
+}
+
+struct grid_axis
+{
+	int variable;
+	std::vector<std::string> values;
+};
+
+} // namespace
+
+int parse_sweep(const std::string& path, const driver& drv, std::vector<parameter_set>& sets)
+{
+	std::ifstream ifs(path);
+	if (!ifs)
+	{
+		std::cerr << "cannot open " << path << std::endl;
+		return 1;
+	}
+
+	auto find_variable = [&](const std::string& name) {
+		auto it = drv.variables.find(name);
+		return it == drv.variables.end() ? -1 : (int)std::distance(drv.variables.begin(), it);
+	};
+
+	std::vector<float> model_values;
+	for (auto&& [name, value] : drv.variables)
+		model_values.push_back(value);
+
+	std::vector<parameter_set> listed;
+	std::vector<grid_axis> axes;
+	std::set<std::string> names;
+	std::set<int> axis_variables;
+	std::string line;
+	for (int line_no = 1; std::getline(ifs, line); line_no++)
+	{
+		std::istringstream tokens(line);
+		std::string first;
+
+		if (!(tokens >> first) || first[0] == '#')
+			continue;
+
+		auto error = [&](const std::string& message) {
+			std::cerr << path << ":" << line_no << ": " << message << std::endl;
+			return 1;
+		};
+
+		// grid axis, $var = v1 v2 ...
+		if (first[0] == '$')
+		{
+			auto eq = line.find('=');
+			if (eq == std::string::npos)
+				return error("missing = in grid axis");
+
+			std::string name;
+			std::istringstream(line.substr(0, eq)) >> name;
+
+			grid_axis axis { find_variable(name), {} };
+			if (axis.variable == -1)
+				return error("unknown variable " + name);
+
+			if (!axis_variables.insert(axis.variable).second)
+				return error("duplicate grid axis " + name);
+
+			// the names of the sets say the values, the same value written twice would give two sets of one name
+			std::set<float> parsed_values;
+			std::istringstream values(line.substr(eq + 1));
+			for (std::string value; values >> value;)
+			{
+				float parsed;
+				if (!parse_value(value, parsed))
+					return error("invalid value " + value);
+				if (!parsed_values.insert(parsed).second)
+					return error("duplicate value " + value + " of " + name);
+				axis.values.push_back(value);
+			}
+
+			if (axis.values.empty())
+				return error("grid axis " + name + " has no values");
+
+			axes.push_back(std::move(axis));
+			continue;
+		}
+
+		// listed set, name $var=value ...
+		parameter_set set { first, model_values };
+
+		if (!names.insert(set.name).second)
+			return error("duplicate parameter set " + set.name);
+
+		std::string token;
+		while (tokens >> token)
+		{
+			auto eq = token.find('=');
+			int variable = eq == std::string::npos ? -1 : find_variable(token.substr(0, eq));
+
+			if (variable == -1 || !parse_value(token.substr(eq + 1), set.values[variable]))
+				return error("invalid assignment " + token);
+		}
+
+		listed.push_back(std::move(set));
+	}
+
+	if (listed.empty() && axes.empty())
+	{
+		std::cerr << path << ": no parameter sets" << std::endl;
+		return 1;
+	}
+
+	if (listed.empty())
+		listed.push_back({ "", model_values });
+
+	// every listed set is combined with every point of the grid, the name says the grid values
+	for (auto&& axis : axes)
+	{
+		std::vector<parameter_set> combined;
+		for (auto&& set : listed)
+		{
+			for (auto&& value : axis.values)
+			{
+				parameter_set point = set;
+				parse_value(value, point.values[axis.variable]);
+
+				auto name = std::next(drv.variables.begin(), axis.variable)->first.substr(1) + "=" + value;
+				point.name += (point.name.empty() ? "" : "_") + name;
+
+				combined.push_back(std::move(point));
+			}
+		}
+		listed = std::move(combined);
+	}
+
+	sets = std::move(listed);
+
+	return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "parser/driver.h"
+
+// Point of a parameter sweep
+struct parameter_set
+{
+	std::string name;
+
+	// Values of all the model variables in the order of driver::variables
+	std::vector<float> values;
+};
+
+// Reads the parameter sets of a sweep from a file. A line with a name followed by whitespace separated $var=value
+// assignments lists one set, a line $var = v1 v2 ... adds a grid axis of distinct values. The sets are the listed
+// ones (or the model values if none is listed) combined with every point of the grid, the variables not assigned keep
+// the model values. Empty lines and lines starting with # are skipped. Returns 0 on success.
+int parse_sweep(const std::string& path, const driver& drv, std::vector<parameter_set>& sets);
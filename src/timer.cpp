@@ -1,8 +1,16 @@
 #include "timer.h"
 
-#include "utils.h"
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
 
-constexpr bool print_diags = false;
+#include "utils.h"
 
 void timer::start() { start_time_ = std::chrono::system_clock::now(); }
 
@@ -23,46 +31,195 @@ auto timer::microsecs() const
 	return std::chrono::duration_cast<std::chrono::microseconds>(end_time_ - start_time_).count();
 }
 
-std::map<const char*, size_t> timer_stats::aggregate_stats_;
+namespace {
 
-timer_stats::timer_stats(const char* name) : name_(name)
+struct span_record
 {
-	if constexpr (print_diags)
-		t_.start();
-}
+	const char* name;
+	int64_t begin_us;
+	int64_t duration_us;
+	int64_t self_us;
+};
+
+struct counter_record
+{
+	const char* name;
+	int64_t time_us;
+	double value;
+};
+
+// Spans recorded by one thread, only the thread itself appends to them
+struct thread_profile
+{
+	int tid;
+	std::vector<span_record> spans;
+	std::vector<counter_record> counters;
+
+	// time spent in the children of the open spans
+	std::vector<int64_t> children_us;
+};
 
-void print_one(const char* name, size_t micros)
+struct profile
 {
-	auto name_size = std::string(name).size();
-	auto micros_size = std::to_string(micros).size();
+	std::mutex mutex;
+	std::string prefix;
+	std::chrono::steady_clock::time_point epoch;
+	std::vector<std::unique_ptr<thread_profile>> threads;
+};
 
-	std::cerr << name << std::string(50 - name_size, ' ') << ":" << std::string(10 - micros_size, ' ') << micros
-			  << " us" << std::endl;
+profile& global_profile()
+{
+	static profile p;
+	return p;
 }
 
-timer_stats::~timer_stats()
+thread_profile& this_thread_profile()
 {
-	if constexpr (print_diags)
+	thread_local thread_profile* current = nullptr;
+
+	// the profiles outlive their threads, so the spans of the finished threads are written too
+	if (!current)
 	{
-		CUDA_CHECK(cudaDeviceSynchronize());
+		auto& p = global_profile();
+		std::lock_guard lock(p.mutex);
+		p.threads.push_back(std::make_unique<thread_profile>());
+		p.threads.back()->tid = p.threads.size();
+		current = p.threads.back().get();
+	}
 
-		t_.stop();
-		aggregate_stats_[name_] += t_.microsecs();
+	return *current;
+}
 
-		print_one(name_, t_.microsecs());
+int64_t since_epoch_us(std::chrono::steady_clock::time_point time)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(time - global_profile().epoch).count();
+}
+
+std::string quoted(const char* name)
+{
+	std::string result = "\"";
+	for (const char* c = name; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			result += '\\';
+		result += *c;
 	}
+	return result + "\"";
+}
+
+} // namespace
+
+std::atomic<bool> timer_stats::enabled_ = false;
+
+void timer_stats::begin()
+{
+	this_thread_profile().children_us.push_back(0);
+	start_ = std::chrono::steady_clock::now();
+}
+
+void timer_stats::end()
+{
+#ifdef MABOSSG_CUDA
+	// the kernels run asynchronously, the span includes the work it launched
+	CUDA_CHECK(cudaDeviceSynchronize());
+#endif
+
+	auto end = std::chrono::steady_clock::now();
+	auto& thread = this_thread_profile();
+
+	int64_t duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start_).count();
+	int64_t children_us = thread.children_us.back();
+	thread.children_us.pop_back();
+	if (!thread.children_us.empty())
+		thread.children_us.back() += duration_us;
+
+	thread.spans.push_back({ name_, since_epoch_us(start_), duration_us, duration_us - children_us });
+}
+
+void timer_stats::enable_profiling(const std::string& prefix)
+{
+	auto& p = global_profile();
+	p.prefix = prefix;
+	p.epoch = std::chrono::steady_clock::now();
+	enabled_ = true;
+}
+
+void timer_stats::counter(const char* name, double value)
+{
+	if (!profiling())
+		return;
+
+	this_thread_profile().counters.push_back({ name, since_epoch_us(std::chrono::steady_clock::now()), value });
 }
 
-void timer_stats::print_aggregate_stats()
+bool timer_stats::write_profile()
 {
-	if constexpr (print_diags)
+	if (!profiling())
+		return true;
+
+	enabled_ = false;
+
+	auto& p = global_profile();
+	std::lock_guard lock(p.mutex);
+
+	struct phase_summary
 	{
-		std::cerr << "Aggregate stats:" << std::endl;
-		for (auto& p : aggregate_stats_)
+		size_t count = 0;
+		int64_t total_us = 0, self_us = 0, max_us = 0;
+	};
+	std::map<std::string, phase_summary> phases;
+
+	// the complete events of the same thread nest by their times
+	std::ofstream trace(p.prefix + ".trace.json");
+	trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	auto pid = getpid();
+	bool first = true;
+	auto separator = [&]() -> const char* { return std::exchange(first, false) ? "\n" : ",\n"; };
+
+	trace << std::setprecision(17);
+	for (auto& thread : p.threads)
+	{
+		trace << separator() << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << thread->tid
+			  << ",\"args\":{\"name\":\"thread " << thread->tid << "\"}}";
+
+		for (const auto& span : thread->spans)
 		{
-			print_one(p.first, p.second);
+			trace << separator() << "{\"ph\":\"X\",\"name\":" << quoted(span.name) << ",\"pid\":" << pid
+				  << ",\"tid\":" << thread->tid << ",\"ts\":" << span.begin_us << ",\"dur\":" << span.duration_us
+				  << "}";
+
+			auto& phase = phases[span.name];
+			phase.count++;
+			phase.total_us += span.duration_us;
+			phase.self_us += span.self_us;
+			phase.max_us = std::max(phase.max_us, span.duration_us);
 		}
+
+		for (const auto& counter : thread->counters)
+		{
+			trace << separator() << "{\"ph\":\"C\",\"name\":" << quoted(counter.name) << ",\"pid\":" << pid
+				  << ",\"tid\":" << thread->tid << ",\"ts\":" << counter.time_us << ",\"args\":{\"value\":"
+				  << counter.value << "}}";
+		}
+
+		thread->spans.clear();
+		thread->counters.clear();
 	}
-}
+	trace << "\n]}" << std::endl;
+
+	// the phases sorted by name with their durations in microseconds, self excludes the nested spans
+	std::ofstream summary(p.prefix + ".profile.json");
+	summary << "{\"threads\":" << p.threads.size() << ",\"phases\":[";
+
+	first = true;
+	for (const auto& [name, phase] : phases)
+	{
+		summary << separator() << "{\"name\":" << quoted(name.c_str()) << ",\"count\":" << phase.count
+				<< ",\"total_us\":" << phase.total_us << ",\"self_us\":" << phase.self_us
+				<< ",\"max_us\":" << phase.max_us << "}";
+	}
+	summary << "\n]}" << std::endl;
 
-bool timer_stats::enable_diags() { return print_diags; }
+	return (bool)trace && (bool)summary;
+}
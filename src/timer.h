@@ -1,9 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <map>
-
-#include "timer.h"
+#include <string>
 
 class timer
 {
@@ -23,21 +22,44 @@ private:
 	std::chrono::time_point<std::chrono::system_clock> end_time_;
 };
 
+// Span of a phase in the profile, the spans are recorded only when the profiling is enabled at runtime, otherwise
+// a span costs a load and a branch
 struct timer_stats
 {
 private:
-	static std::map<const char*, size_t> aggregate_stats_;
+	static std::atomic<bool> enabled_;
 	const char* name_;
-	timer t_;
+	bool recording_;
+	std::chrono::steady_clock::time_point start_;
+
+	void begin();
+	void end();
 
 public:
-	timer_stats(const char* name);
+	timer_stats(const char* name) : name_(name), recording_(enabled_.load(std::memory_order_relaxed))
+	{
+		if (recording_)
+			begin();
+	}
+
+	~timer_stats()
+	{
+		if (recording_)
+			end();
+	}
+
+	// Starts recording the spans of all the threads, the profile is written to prefix.trace.json and
+	// prefix.profile.json
+	static void enable_profiling(const std::string& prefix);
 
-	~timer_stats();
+	// Writes the Chrome trace of the recorded spans and the summary of the phases, and stops the profiling. It must be
+	// called when no other thread records spans
+	static bool write_profile();
 
-	static void print_aggregate_stats();
+	// Records the value of a counter into the trace
+	static void counter(const char* name, double value);
 
-	static bool enable_diags();
+	static bool profiling() { return enabled_.load(std::memory_order_relaxed); }
 };
 
 // Times op's execution using the timer t
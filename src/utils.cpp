@@ -1,5 +1,7 @@
 #include "utils.h"
 
+#ifdef MABOSSG_CUDA
+
 void cuda_check(cudaError_t e, const char* file, int line)
 {
 	if (e != cudaSuccess)
@@ -28,3 +30,5 @@ void nvrtc_check(nvrtcResult e, const char* file, int line)
 		std::exit(EXIT_FAILURE);
 	}
 }
+
+#endif
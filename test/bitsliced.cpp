@@ -0,0 +1,113 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "host/bitsliced_model.h"
+#include "host/bytecode_model.h"
+#include "host/host_simulation_runner.h"
+#include "model_builder.h"
+#include "statistics/host/final_states_reducer.h"
+#include "statistics/host/fixed_states_reducer.h"
+#include "statistics/partial_results.h"
+
+namespace {
+
+driver create_driver()
+{
+	driver drv;
+
+	add_node(drv, "A", negation(node("C")), 1.f, 2.f);
+	add_node(drv, "B", binary(operation::AND, node("A"), negation(node("C"))), 3.f, 1.f);
+	add_node(drv, "C", binary(operation::OR, node("B"), binary(operation::AND, node("A"), node("C"))), 0.5f, 1.5f);
+
+	return drv;
+}
+
+// The nodes switch on one after the other up to the fixed point ABC, the rates are not dyadic so their sums are rounded
+driver create_fixed_point_driver()
+{
+	driver drv;
+
+	add_node(drv, "A", literal(1), 0.1f, 0.7f);
+	add_node(drv, "B", node("A"), 0.2f, 0.3f);
+	add_node(drv, "C", binary(operation::AND, node("A"), node("B")), 0.3f, 0.1f);
+
+	return drv;
+}
+
+partial_results simulate_stats(const driver& drv, const host_model& model,
+							   const std::function<void(host_simulation_runner&, stats_composite&)>& run)
+{
+	thread_pool pool(2);
+	host_simulation_runner r(1000, drv.nodes.size(), 1, std::vector<float>(drv.nodes.size(), 0.5f), 5.f, 0.5f,
+							 false, pool);
+
+	stats_composite stats_runner;
+	stats_runner.add(std::make_unique<final_states_stats>(
+		state_t(3), std::make_unique<final_states_host_reducer>(3, 1, model, pool)));
+	add_fixed_states_stats_host(stats_runner, 1, pool);
+
+	run(r, stats_runner);
+
+	partial_results partial;
+	stats_runner.finalize();
+	stats_runner.export_partial(partial);
+	return partial;
+}
+
+// Simulates the model of drv by the bytecode on the host loop and by the bitsliced engine
+void expect_same_trajectories(const driver& drv)
+{
+	bitsliced_model bitsliced(drv);
+	bytecode_model bytecode(drv);
+
+	auto expected = simulate_stats(drv, bytecode, [&](host_simulation_runner& r, stats_composite& stats_runner) {
+		r.run_simulation(stats_runner, static_cast<const host_model&>(bytecode));
+	});
+	auto result = simulate_stats(drv, bitsliced, [&](host_simulation_runner& r, stats_composite& stats_runner) {
+		r.run_simulation(stats_runner, bitsliced);
+	});
+
+	EXPECT_EQ(result.final_states, expected.final_states);
+	EXPECT_EQ(result.fixed_points, expected.fixed_points);
+}
+
+} // namespace
+
+TEST(bitsliced, transition_rates)
+{
+	auto drv = create_driver();
+	ASSERT_TRUE(bitsliced_model::is_supported(drv));
+
+	bitsliced_model bitsliced(drv);
+	bytecode_model bytecode(drv);
+
+	for (state_word_t state = 0; state < 8; state++)
+	{
+		float rates[3], expected_rates[3];
+
+		EXPECT_FLOAT_EQ(bitsliced.compute_transition_rates(rates, &state),
+						bytecode.compute_transition_rates(expected_rates, &state));
+		EXPECT_THAT(rates, testing::ElementsAreArray(expected_rates)) << state;
+	}
+}
+
+TEST(bitsliced, unsupported_rates)
+{
+	auto drv = create_driver();
+	drv.nodes[0].attrs[1].second = literal(1);
+
+	EXPECT_FALSE(bitsliced_model::is_supported(drv));
+}
+
+TEST(bitsliced, same_trajectories_as_host)
+{
+	expect_same_trajectories(create_driver());
+}
+
+TEST(bitsliced, same_fixed_points_as_host)
+{
+	auto drv = create_fixed_point_driver();
+	ASSERT_TRUE(bitsliced_model::is_supported(drv));
+
+	expect_same_trajectories(drv);
+}
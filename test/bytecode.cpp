@@ -0,0 +1,126 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "generator.h"
+#include "host/bytecode_model.h"
+#include "model_builder.h"
+
+namespace {
+
+// A is internal and switches on with the rate 2 when B is set, B has constant rates computed from A
+driver create_driver()
+{
+	driver drv;
+
+	node_attr_list_t a_attrs;
+	a_attrs.emplace_back("logic", node("B"));
+	a_attrs.emplace_back("rate_up", logic_ternary(literal(2), literal(0)));
+	a_attrs.emplace_back("rate_down", logic_ternary(literal(0), literal(1)));
+	a_attrs.emplace_back("is_internal", literal(1));
+	drv.nodes.emplace_back("A", std::move(a_attrs));
+
+	node_attr_list_t b_attrs;
+	b_attrs.emplace_back("rate_up",
+						 binary(operation::PLUS, literal(1), binary(operation::STAR, literal(2), literal(3))));
+	b_attrs.emplace_back("rate_down",
+						 binary(operation::MINUS, binary(operation::OR, node("A"), node("B")), literal(0.5f)));
+	drv.nodes.emplace_back("B", std::move(b_attrs));
+
+	return drv;
+}
+
+} // namespace
+
+TEST(bytecode, transition_rates)
+{
+	auto drv = create_driver();
+	bytecode_model model(drv);
+
+	float rates[2];
+
+	state_word_t none = 0;
+	EXPECT_FLOAT_EQ(model.compute_transition_rates(rates, &none), 7.f);
+	EXPECT_THAT(rates, testing::ElementsAre(0.f, 7.f));
+
+	state_word_t b = 2;
+	EXPECT_FLOAT_EQ(model.compute_transition_rates(rates, &b), 2.5f);
+	EXPECT_THAT(rates, testing::ElementsAre(2.f, 0.5f));
+
+	state_word_t a = 1;
+	EXPECT_FLOAT_EQ(model.compute_transition_rates(rates, &a), 8.f);
+	EXPECT_THAT(rates, testing::ElementsAre(1.f, 7.f));
+}
+
+TEST(bytecode, non_internal_index)
+{
+	auto drv = create_driver();
+	bytecode_model model(drv);
+
+	state_word_t ab = 3;
+	EXPECT_EQ(model.get_non_internal_index(&ab), 1u);
+
+	state_word_t a = 1;
+	EXPECT_EQ(model.get_non_internal_index(&a), 0u);
+
+	// only B is non-internal, so the entropy of a single possible transition is zero
+	float rates[2] = { 2.f, 0.5f };
+	EXPECT_FLOAT_EQ(model.compute_transition_entropy(rates), 0.f);
+}
+
+TEST(bytecode, negated_ternary)
+{
+	auto drv = create_driver();
+
+	// the not must not be fused into the push of A, the other branch jumps right after it
+	unary_expression expr(operation::NOT, std::make_unique<ternary_expression>(node("A"), node("B"), node("A")));
+
+	bytecode_program program;
+	expr.generate_bytecode(drv, "A", program);
+	program.emit(opcode::ret);
+
+	for (state_word_t state = 0; state < 4; state++)
+	{
+		bool a = state & 1, b = state & 2;
+		EXPECT_EQ(program.run(0, &state), !(a ? b : a)) << state;
+	}
+}
+
+TEST(bytecode, node_dependents)
+{
+	driver drv;
+
+	// X reads Y, Y reads nothing and Z reads X
+	const char* logics[][2] = { { "X", "Y" }, { "Y", nullptr }, { "Z", "X" } };
+	for (auto [name, logic] : logics)
+	{
+		node_attr_list_t attrs;
+		attrs.emplace_back("logic", logic ? node(logic) : literal(1));
+		attrs.emplace_back("rate_up", logic_ternary(literal(1), literal(0)));
+		attrs.emplace_back("rate_down", logic_ternary(literal(0), literal(1)));
+		drv.nodes.emplace_back(name, std::move(attrs));
+	}
+
+	EXPECT_THAT(build_node_dependents(drv), testing::ElementsAre(testing::ElementsAre(0, 2),
+																 testing::ElementsAre(0, 1), testing::ElementsAre(2)));
+}
+
+TEST(bytecode, update_transition_rates)
+{
+	auto drv = create_driver();
+	bytecode_model model(drv);
+
+	for (state_word_t state = 0; state < 4; state++)
+	{
+		for (int flipped = 0; flipped < 2; flipped++)
+		{
+			float rates[2], expected_rates[2];
+			float total_rate = model.compute_transition_rates(rates, &state);
+
+			state_word_t next = state ^ (1u << flipped);
+			float expected_total_rate = model.compute_transition_rates(expected_rates, &next);
+
+			EXPECT_FLOAT_EQ(total_rate + model.update_transition_rates(rates, &next, flipped), expected_total_rate);
+			EXPECT_THAT(rates, testing::ElementsAreArray(expected_rates)) << state << " " << flipped;
+		}
+	}
+}
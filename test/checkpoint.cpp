@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "checkpoint.h"
+#include "simulation_fixture.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class checkpoint_test : public simulation_fixture<>
+{
+protected:
+	std::string path_;
+
+	void SetUp() override
+	{
+		simulation_fixture::SetUp();
+		path_ = temp_path("checkpoint");
+	}
+
+	void TearDown() override { fs::remove(path_); }
+
+	// Simulates the model in many short batches and returns the serialized sums of the stats
+	std::string simulate_batches(checkpointer* checkpoints, bool fused = false)
+	{
+		simulation_options options;
+		options.n_trajectories = 3000;
+		options.configure = [&](host_simulation_runner& r) {
+			r.trajectory_len_limit = 5;
+			if (fused)
+				r.fuse_stats();
+			if (checkpoints)
+				r.enable_checkpoints(*checkpoints);
+		};
+		return simulate(options).serialize();
+	}
+};
+
+// Overwrites the variant of the first batch slot in a checkpoint file of a run with the given fingerprint
+void overwrite_first_variant(const std::string& path, const std::string& fingerprint, int variant)
+{
+	std::string data;
+	{
+		std::ifstream ifs(path, std::ios::binary);
+		std::ostringstream ss;
+		ss << ifs.rdbuf();
+		data = ss.str();
+	}
+
+	// the magic, version, fingerprint and state size precede the state, whose runner header takes 76 bytes
+	size_t offset = 8 + sizeof(uint32_t) + sizeof(uint64_t) + fingerprint.size() + sizeof(uint64_t) + 76;
+
+	// the last states, times and random generators of the slots precede their variants
+	for (size_t size : { sizeof(state_word_t), sizeof(float), sizeof(host_random) })
+	{
+		uint64_t count;
+		std::memcpy(&count, data.data() + offset, sizeof(count));
+		ASSERT_GT(count, 0u);
+		offset += sizeof(count) + count * size;
+	}
+
+	std::memcpy(data.data() + offset + sizeof(uint64_t), &variant, sizeof(variant));
+
+	std::ofstream(path, std::ios::binary) << data;
+}
+
+} // namespace
+
+TEST_F(checkpoint_test, resumed_run_matches_uninterrupted_run)
+{
+	auto uninterrupted = simulate_batches(nullptr);
+
+	// a checkpoint after every batch, the file keeps the last one written before the run completed
+	{
+		checkpointer checkpoints(path_, "run", std::chrono::seconds(0));
+		EXPECT_EQ(simulate_batches(&checkpoints), uninterrupted);
+	}
+	ASSERT_TRUE(fs::exists(path_));
+
+	checkpointer checkpoints(path_, "run", std::chrono::seconds(3600));
+	ASSERT_TRUE(checkpoints.load());
+	EXPECT_EQ(simulate_batches(&checkpoints), uninterrupted);
+
+	checkpoints.finish();
+	EXPECT_FALSE(fs::exists(path_));
+}
+
+TEST_F(checkpoint_test, resumed_fused_run_matches_uninterrupted_run)
+{
+	// the fused stats sum the steps on the workers that simulated them, the resumed batches must split them the same
+	auto uninterrupted = simulate_batches(nullptr, true);
+
+	{
+		checkpointer checkpoints(path_, "run", std::chrono::seconds(0));
+		EXPECT_EQ(simulate_batches(&checkpoints, true), uninterrupted);
+	}
+
+	checkpointer checkpoints(path_, "run", std::chrono::seconds(3600));
+	ASSERT_TRUE(checkpoints.load());
+	EXPECT_EQ(simulate_batches(&checkpoints, true), uninterrupted);
+
+	checkpoints.finish();
+}
+
+TEST_F(checkpoint_test, rejects_checkpoints_of_other_runs)
+{
+	checkpointer missing(path_, "run", std::chrono::seconds(0));
+	EXPECT_FALSE(missing.load());
+
+	{
+		checkpointer checkpoints(path_, "run", std::chrono::seconds(0));
+		simulate_batches(&checkpoints);
+	}
+
+	checkpointer other(path_, "other run", std::chrono::seconds(0));
+	EXPECT_THROW(other.load(), std::runtime_error);
+
+	fs::resize_file(path_, fs::file_size(path_) - 1);
+	checkpointer truncated(path_, "run", std::chrono::seconds(0));
+	EXPECT_THROW(truncated.load(), std::runtime_error);
+}
+
+TEST_F(checkpoint_test, rejects_invalid_trajectory_variants)
+{
+	{
+		checkpointer checkpoints(path_, "run", std::chrono::seconds(0));
+		simulate_batches(&checkpoints);
+	}
+
+	for (int variant : { 0, -1, 1 })
+	{
+		overwrite_first_variant(path_, "run", variant);
+
+		checkpointer checkpoints(path_, "run", std::chrono::seconds(3600));
+		ASSERT_TRUE(checkpoints.load());
+		if (variant == 0)
+			EXPECT_NO_THROW(simulate_batches(&checkpoints));
+		else
+			EXPECT_THROW(simulate_batches(&checkpoints), std::runtime_error);
+	}
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "simulation_fixture.h"
+
+namespace {
+
+class convergence_test : public simulation_fixture<>
+{
+protected:
+	// Simulates at most count trajectories and returns the finalized sums of the stats
+	partial_results simulate_within(int count, float tolerance, int& simulated, float& error)
+	{
+		simulation_options options;
+		options.n_trajectories = count;
+		options.window_errors = false;
+		options.configure = [&](host_simulation_runner& r) {
+			if (tolerance > 0.f)
+				r.stop_at_tolerance(tolerance);
+		};
+		options.finished = [&](host_simulation_runner& r) { error = r.achieved_error(); };
+
+		auto partial = simulate(options);
+		simulated = partial.n_trajectories;
+		return partial;
+	}
+};
+
+} // namespace
+
+TEST(confidence_half_width, follows_binomial_proportion)
+{
+	EXPECT_NEAR(confidence_half_width(0.5f, 10000), 0.0098f, 1e-5f);
+
+	// the edges keep a width of about z^2 / 2n
+	EXPECT_NEAR(confidence_half_width(0.f, 100), 0.0185f, 1e-4f);
+	EXPECT_FLOAT_EQ(confidence_half_width(1.f, 100), confidence_half_width(0.f, 100));
+
+	// window probabilities overestimated by the running trajectories are clamped
+	EXPECT_FLOAT_EQ(confidence_half_width(1.01f, 100), confidence_half_width(1.f, 100));
+}
+
+TEST(convergence, certain_results_are_not_exact)
+{
+	// A and B start set and stay set, so every probability is 0 or 1
+	driver drv;
+	for (const char* name : { "A", "B" })
+	{
+		node_attr_list_t attrs;
+		attrs.emplace_back("logic", std::make_unique<literal_expression>(1));
+		attrs.emplace_back("rate_up", std::make_unique<literal_expression>(0.1f));
+		attrs.emplace_back("rate_down", std::make_unique<literal_expression>(0));
+		drv.nodes.emplace_back(name, std::move(attrs));
+	}
+	bytecode_model model(drv);
+
+	thread_pool pool(2);
+	host_simulation_runner r(100000, 2, 1, { 1.f, 1.f }, 10.f, 1.f, false, pool);
+	r.trajectory_batch_limit = 1000;
+	r.stop_at_tolerance(1e-3f);
+
+	stats_composite stats_runner;
+	add_host_stats(stats_runner, false, 10.f, 1.f, create_noninternals_mask(drv), 2, r.trajectory_len_limit, model,
+				   pool);
+	r.run_simulation(stats_runner, model);
+
+	// the first check after 1000 trajectories must not stop the run on a zero error
+	EXPECT_GT(r.simulated_trajectories(), 1000);
+	EXPECT_LT(r.simulated_trajectories(), 100000);
+	EXPECT_GT(r.achieved_error(), 0.f);
+	EXPECT_LE(r.achieved_error(), 1e-3f);
+}
+
+TEST_F(convergence_test, stops_once_within_tolerance)
+{
+	int simulated;
+	float error;
+	auto adaptive = simulate_within(200000, 0.02f, simulated, error);
+
+	EXPECT_LT(simulated, 200000);
+	EXPECT_LE(error, 0.02f);
+	EXPECT_GT(error, 0.f);
+
+	// the started trajectories are finished, so the results are those of a run with the simulated count
+	int fixed_simulated;
+	float fixed_error;
+	auto fixed = simulate_within(simulated, 0.f, fixed_simulated, fixed_error);
+
+	EXPECT_EQ(fixed_simulated, simulated);
+	EXPECT_EQ(adaptive.final_states, fixed.final_states);
+	EXPECT_EQ(adaptive.fixed_points, fixed.fixed_points);
+}
+
+TEST_F(convergence_test, simulates_all_trajectories_when_not_converged)
+{
+	int simulated;
+	float error;
+	simulate_within(2000, 1e-4f, simulated, error);
+
+	EXPECT_EQ(simulated, 2000);
+	EXPECT_GT(error, 1e-4f);
+}
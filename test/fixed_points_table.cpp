@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include "host/thread_pool.h"
+#include "statistics/fixed_points_table.h"
+
+namespace {
+
+std::map<std::vector<state_word_t>, int> to_map(const fixed_points_table& table)
+{
+	std::map<std::vector<state_word_t>, int> result;
+	table.for_each([&](const state_word_t* state, int count) {
+		EXPECT_TRUE(result.emplace(std::vector<state_word_t>(state, state + table.state_words()), count).second);
+	});
+	return result;
+}
+
+} // namespace
+
+TEST(fixed_points_table, counts_concurrent_inserts)
+{
+	constexpr int state_words = 3;
+	constexpr int n_states = 100000;
+
+	thread_pool pool(4);
+
+	// state i has the words of i % 1000, so each of the fixed points is inserted from many threads
+	std::vector<state_word_t> states(n_states * state_words);
+	std::map<std::vector<state_word_t>, int> expected;
+	for (int i = 0; i < n_states; i++)
+	{
+		state_word_t key = i % 1000;
+		for (int w = 0; w < state_words; w++)
+			states[i * state_words + w] = key * (w + 1);
+		expected[std::vector<state_word_t>(states.begin() + i * state_words, states.begin() + (i + 1) * state_words)]++;
+	}
+
+	fixed_points_table table(state_words);
+	table.reserve(1000);
+	pool.parallel_for(n_states, [&](int begin, int end, int) {
+		for (int i = begin; i < end; i++)
+			table.insert(states.data() + i * state_words);
+	});
+
+	EXPECT_EQ(table.size(), expected.size());
+	EXPECT_EQ(to_map(table), expected);
+}
+
+TEST(fixed_points_table, keeps_counts_when_growing)
+{
+	fixed_points_table table(1);
+
+	std::map<std::vector<state_word_t>, int> expected;
+	for (state_word_t batch = 0; batch < 20; batch++)
+	{
+		// every batch repeats the fixed points of the previous ones and adds 100 new ones
+		table.reserve(100);
+		for (state_word_t key = 0; key < (batch + 1) * 100; key++)
+		{
+			table.insert(&key, 2);
+			expected[{ key }] += 2;
+		}
+	}
+
+	EXPECT_EQ(to_map(table), expected);
+
+	table.clear();
+	EXPECT_EQ(table.size(), 0u);
+	EXPECT_TRUE(to_map(table).empty());
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "simulation_fixture.h"
+
+namespace {
+
+// With a single variant the fused stats accumulate the same steps on the same workers as the buffered ones, so their
+// sums are the same to the bit. The slots of the variants are split among the workers differently, their sums differ
+// only by the summation order.
+class fused_stats_test : public simulation_fixture<testing::TestWithParam<std::tuple<const char*, int, bool>>>
+{
+protected:
+	void SetUp() override { load(std::get<0>(GetParam())); }
+
+	// Simulates the trajectories of variants_count variants differing by the initial probabilities and returns the
+	// finalized sums of their stats
+	std::vector<partial_results> simulate_fused(bool fused, int variants_count = 1)
+	{
+		simulation_options options;
+		options.n_trajectories = std::get<1>(GetParam());
+		options.discrete_time = std::get<2>(GetParam());
+		options.threads = 3;
+		options.configure = [&](host_simulation_runner& r) {
+			if (fused)
+				r.fuse_stats();
+		};
+		return simulate_variants(variants_count, options);
+	}
+};
+
+// The counts are the same and the window sums are the same up to the rounding
+void expect_same_sums(const partial_results& actual, const partial_results& expected)
+{
+	EXPECT_EQ(actual.final_states, expected.final_states);
+	EXPECT_EQ(actual.fixed_points, expected.fixed_points);
+	EXPECT_EQ(actual.window_probs_discrete, expected.window_probs_discrete);
+
+	ASSERT_EQ(actual.window_probs.size(), expected.window_probs.size());
+	for (size_t w = 0; w < expected.window_probs.size(); w++)
+	{
+		ASSERT_EQ(actual.window_probs[w].size(), expected.window_probs[w].size());
+		for (const auto& [idx, sum] : expected.window_probs[w])
+			EXPECT_NEAR(actual.window_probs[w].at(idx), sum, sum * 1e-5f);
+	}
+
+	ASSERT_EQ(actual.window_tr_entropies.size(), expected.window_tr_entropies.size());
+	for (size_t w = 0; w < expected.window_tr_entropies.size(); w++)
+		EXPECT_NEAR(actual.window_tr_entropies[w], expected.window_tr_entropies[w],
+					expected.window_tr_entropies[w] * 1e-5f);
+}
+
+} // namespace
+
+TEST_P(fused_stats_test, matches_buffered_stats)
+{
+	auto buffered = simulate_fused(false);
+	auto fused = simulate_fused(true);
+
+	EXPECT_FALSE(buffered.front().window_tr_entropies.empty());
+	EXPECT_EQ(fused.front().serialize(), buffered.front().serialize());
+}
+
+TEST_P(fused_stats_test, matches_buffered_variants)
+{
+	auto buffered = simulate_fused(false, 3);
+	auto fused = simulate_fused(true, 3);
+
+	for (int v = 0; v < 3; v++)
+		expect_same_sums(fused[v], buffered[v]);
+}
+
+INSTANTIATE_TEST_SUITE_P(models, fused_stats_test,
+						 testing::Values(std::make_tuple("cellcycle", 2000, false),
+										 std::make_tuple("cellcycle", 2000, true),
+										 std::make_tuple("sizek", 300, false)));
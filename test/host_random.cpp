@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "host/host_random.h"
+
+TEST(host_random, neighbouring_trajectories_share_no_state)
+{
+	for (unsigned long long seed : { 0ull, 1ull, 0x9E3779B97F4A7C15ull })
+	{
+		std::set<uint64_t> words;
+		for (unsigned long long id = 0; id < 1000; id++)
+		{
+			host_random rand(seed, id);
+			words.insert(rand.s0);
+			words.insert(rand.s1);
+		}
+
+		EXPECT_EQ(words.size(), 2000u);
+	}
+}
+
+TEST(host_random, similar_seeds_give_different_streams)
+{
+	host_random a(0, 1), b(1, 0);
+
+	EXPECT_NE(a.s0, b.s0);
+	EXPECT_NE(a.s0, b.s1);
+	EXPECT_NE(a.s1, b.s0);
+}
@@ -0,0 +1,258 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "statistics/host/final_states_reducer.h"
+#include "statistics/fixed_states.h"
+#include "statistics/host/final_states_sparse_reducer.h"
+#include "statistics/host/fixed_states_reducer.h"
+#include "statistics/host/host_stats.h"
+#include "statistics/host/window_average_small_reducer.h"
+#include "statistics/host/window_average_sparse_reducer.h"
+
+namespace {
+
+// the two lowest nodes are the non-internal ones, their index is shifted to emulate models with many non-internals
+class low_bits_model : public host_model
+{
+	int shift_;
+
+public:
+	explicit low_bits_model(int shift = 0) : shift_(shift) {}
+
+	float compute_transition_rates(float*, const state_word_t*) const override { return 0.f; }
+	double update_transition_rates(float*, const state_word_t*, int) const override { return 0.0; }
+	void update_transition_rate_tree(float*, const state_word_t*, int) const override {}
+	float compute_transition_entropy(const float*) const override { return 0.f; }
+	uint64_t get_non_internal_index(const state_word_t* state) const override
+	{
+		return (uint64_t)(state[0] & 3) << shift_;
+	}
+};
+
+struct batch_fixture
+{
+	static constexpr int traj_len = 3;
+
+	std::vector<state_word_t> traj_states;
+	std::vector<float> traj_times, traj_tr_entropies;
+	std::vector<state_word_t> last_states;
+	std::vector<trajectory_status> traj_statuses;
+
+	// trajectory i stays in the state i from time 0 to 1 and then in the state i + 1 from time 1 to 1.5
+	batch_fixture(int n_trajectories)
+		: traj_states(n_trajectories * traj_len),
+		  traj_times(n_trajectories * traj_len),
+		  traj_tr_entropies(n_trajectories * traj_len, 1.f),
+		  last_states(n_trajectories),
+		  traj_statuses(n_trajectories, trajectory_status::FINISHED)
+	{
+		for (int i = 0; i < n_trajectories; i++)
+		{
+			traj_states[i * traj_len + 1] = i;
+			traj_states[i * traj_len + 2] = i + 1;
+			traj_times[i * traj_len + 0] = 0.f;
+			traj_times[i * traj_len + 1] = 1.f;
+			traj_times[i * traj_len + 2] = 1.5f;
+			last_states[i] = i + 1;
+		}
+	}
+
+	trajectory_batch view()
+	{
+		return { traj_states.data(),	 traj_times.data(),		traj_tr_entropies.data(),
+				 last_states.data(), traj_statuses.data(), (int)traj_statuses.size() };
+	}
+};
+
+} // namespace
+
+TEST(host_stats, final_states_sums_worker_histograms)
+{
+	thread_pool pool(3);
+	batch_fixture batch(8);
+	batch.traj_statuses[0] = trajectory_status::CONTINUE;
+
+	low_bits_model model;
+	final_states_host_reducer reducer(2, 1, model, pool);
+	reducer.process_batch(batch.view());
+	reducer.process_batch(batch.view());
+
+	sparse_histogram<int> occurences;
+	reducer.finalize(occurences);
+
+	// last states are 1..8, the first trajectory did not finish
+	EXPECT_THAT(occurences, testing::ElementsAre(testing::Pair(0, 4), testing::Pair(1, 2), testing::Pair(2, 4),
+												 testing::Pair(3, 4)));
+}
+
+TEST(host_stats, final_states_sparse_merges_worker_maps)
+{
+	thread_pool pool(3);
+	batch_fixture batch(8);
+	batch.traj_statuses[0] = trajectory_status::CONTINUE;
+
+	low_bits_model model(40);
+	final_states_sparse_host_reducer reducer(1, model, pool);
+	reducer.process_batch(batch.view());
+	reducer.process_batch(batch.view());
+
+	sparse_histogram<int> occurences;
+	reducer.finalize(occurences);
+
+	EXPECT_THAT(occurences,
+				testing::ElementsAre(testing::Pair(0ull << 40, 4), testing::Pair(1ull << 40, 2),
+									 testing::Pair(2ull << 40, 4), testing::Pair(3ull << 40, 4)));
+}
+
+TEST(host_stats, window_average_splits_slices)
+{
+	thread_pool pool(2);
+	batch_fixture batch(4);
+
+	low_bits_model model;
+	window_average_small_host_reducer reducer(0.5f, 2.f, false, 2, 1, batch_fixture::traj_len, model, pool, false);
+	reducer.process_batch(batch.view());
+
+	std::vector<sparse_histogram<float>> probs(4);
+	std::vector<sparse_histogram<int>> probs_discrete(4);
+	std::vector<float> tr_entropies(4);
+	reducer.finalize(probs, probs_discrete, tr_entropies);
+
+	// state is visited by trajectory state during [0, 1) and by trajectory state - 1 during [1, 1.5)
+	auto half_each = testing::ElementsAre(testing::Pair(0, 0.5f), testing::Pair(1, 0.5f), testing::Pair(2, 0.5f),
+										  testing::Pair(3, 0.5f));
+	EXPECT_THAT(probs[0], half_each);
+	EXPECT_THAT(probs[1], half_each);
+	EXPECT_THAT(probs[2], half_each);
+	EXPECT_TRUE(probs[3].empty());
+
+	EXPECT_THAT(tr_entropies, testing::ElementsAre(2.f, 2.f, 2.f, 0.f));
+}
+
+TEST(host_stats, window_average_sparse_matches_dense)
+{
+	thread_pool pool(2);
+	batch_fixture batch(6);
+
+	low_bits_model dense_model, sparse_model(40);
+	window_average_small_host_reducer dense(0.5f, 2.f, false, 2, 1, batch_fixture::traj_len, dense_model, pool,
+											false);
+	window_average_sparse_host_reducer sparse(0.5f, 2.f, false, 1, batch_fixture::traj_len, sparse_model, pool,
+											  false);
+	dense.process_batch(batch.view());
+	sparse.process_batch(batch.view());
+
+	std::vector<sparse_histogram<float>> dense_probs(4), sparse_probs(4);
+	std::vector<sparse_histogram<int>> probs_discrete(4);
+	std::vector<float> dense_tr_entropies(4), sparse_tr_entropies(4);
+	dense.finalize(dense_probs, probs_discrete, dense_tr_entropies);
+	sparse.finalize(sparse_probs, probs_discrete, sparse_tr_entropies);
+
+	for (int wnd = 0; wnd < 4; wnd++)
+	{
+		sparse_histogram<float> unshifted;
+		for (const auto& [idx, prob] : sparse_probs[wnd])
+			unshifted.emplace(idx >> 40, prob);
+
+		EXPECT_EQ(unshifted, dense_probs[wnd]) << wnd;
+	}
+
+	EXPECT_EQ(sparse_tr_entropies, dense_tr_entropies);
+}
+
+TEST(host_stats, window_squares_span_batches)
+{
+	thread_pool pool(2);
+	low_bits_model dense_model, sparse_model(40);
+	window_average_small_host_reducer dense(0.5f, 1.f, false, 2, 1, batch_fixture::traj_len, dense_model, pool,
+											true);
+	window_average_sparse_host_reducer sparse(0.5f, 1.f, false, 1, batch_fixture::traj_len, sparse_model, pool,
+											  true);
+
+	// the first trajectory stays in the state 3 until 1, the others are in the state 1 until 0.25 when the batch ends
+	batch_fixture first(3);
+	first.traj_states = { 0, 3, 0, 0, 1, 0, 0, 1, 0 };
+	first.traj_times = { 0.f, 1.f, 0.f, 0.f, 0.25f, 0.f, 0.f, 0.25f, 0.f };
+	first.traj_statuses = { trajectory_status::FINISHED, trajectory_status::CONTINUE, trajectory_status::CONTINUE };
+
+	// the continuing trajectories move to the first slots, they stay in the state 1 until 0.5 and then in the state 2
+	batch_fixture second(2);
+	second.traj_states = { 0, 1, 2, 0, 1, 2 };
+	second.traj_times = { 0.25f, 0.5f, 1.f, 0.25f, 0.5f, 1.f };
+
+	dense.process_batch(first.view());
+	dense.process_batch(second.view());
+	sparse.process_batch(first.view());
+	sparse.process_batch(second.view());
+
+	std::vector<sparse_histogram<double>> dense_squares, sparse_squares;
+	std::vector<double> dense_tr_squares, sparse_tr_squares;
+	dense.finalize_squares(dense_squares, dense_tr_squares);
+	sparse.finalize_squares(sparse_squares, sparse_tr_squares);
+
+	// the split trajectories spend the whole first window in the state 1, so their values are 0.5 and not 0.25 twice
+	ASSERT_EQ(dense_squares.size(), 2);
+	EXPECT_THAT(dense_squares[0], testing::ElementsAre(testing::Pair(1, 0.5), testing::Pair(3, 0.25)));
+	EXPECT_THAT(dense_squares[1], testing::ElementsAre(testing::Pair(2, 0.5), testing::Pair(3, 0.25)));
+	EXPECT_THAT(dense_tr_squares, testing::ElementsAre(0.75, 0.75));
+
+	for (int wnd = 0; wnd < 2; wnd++)
+	{
+		sparse_histogram<double> unshifted;
+		for (const auto& [idx, squares] : sparse_squares[wnd])
+			unshifted.emplace(idx >> 40, squares);
+
+		EXPECT_EQ(unshifted, dense_squares[wnd]) << wnd;
+	}
+	EXPECT_EQ(sparse_tr_squares, dense_tr_squares);
+}
+
+TEST(host_stats, fixed_states_beyond_max_words)
+{
+	thread_pool pool(2);
+
+	// the specialized and the runtime sized keys print the same fixed points in the same order
+	std::vector<std::string> outputs;
+	for (int state_words : { (int)MAX_WORDS, (int)MAX_WORDS + 1 })
+	{
+		int state_size = state_words * state_t::word_size;
+		std::vector<std::string> nodes;
+		for (int i = 0; i < state_size; i++)
+			nodes.push_back("N" + std::to_string(i));
+
+		// trajectory i ends in the state with the last node and the node i % 3 set
+		std::vector<state_word_t> last_states(6 * state_words);
+		std::vector<trajectory_status> statuses(6, trajectory_status::FIXED_POINT);
+		statuses[5] = trajectory_status::FINISHED;
+		for (int i = 0; i < 6; i++)
+		{
+			last_states[i * state_words] = 1u << (i % 3);
+			last_states[(i + 1) * state_words - 1] |= 1u << (state_t::word_size - 1);
+		}
+
+		stats_composite stats_runner;
+		add_fixed_states_stats_host(stats_runner, state_words, pool);
+		stats_runner.process_batch({ nullptr, nullptr, nullptr, last_states.data(), statuses.data(), 6 });
+		stats_runner.finalize();
+
+		testing::internal::CaptureStdout();
+		stats_runner.visualize(6, nodes);
+		outputs.push_back(testing::internal::GetCapturedStdout());
+
+		std::string last = "N" + std::to_string(state_size - 1);
+		EXPECT_EQ(outputs.back(), "fixed points:\n0.333333 N0 -- " + last + "\n0.333333 N1 -- " + last
+									  + "\n0.166667 N2 -- " + last + "\n");
+	}
+}
+
+TEST(host_stats, dense_histograms_fit_all_workers)
+{
+	// 100 windows of 2^16 states take about 50 MB on each worker
+	EXPECT_TRUE(dense_host_stats(false, 100.f, 1.f, 16, 1, false));
+	EXPECT_FALSE(dense_host_stats(false, 100.f, 1.f, 16, 16, false));
+	EXPECT_TRUE(dense_host_stats(false, 100.f, 1.f, 12, 16, true));
+	EXPECT_FALSE(dense_host_stats(false, 1.f, 1.f, max_dense_noninternals + 1, 1, false));
+
+	EXPECT_EQ(dense_host_stats_bytes(true, 2.f, 1.f, 1, 3, false), 3 * (2 * sizeof(int) + 4 * sizeof(int) + 2 * 8));
+	EXPECT_EQ(dense_host_stats_bytes(false, 2.f, 1.f, 1, 1, true), 2 * sizeof(int) + 4 * 8 + 2 * 8 + 4 * 8 + 2 * 8);
+}
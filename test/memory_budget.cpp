@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "simulation_fixture.h"
+
+namespace {
+
+class memory_budget_test : public simulation_fixture<>
+{
+protected:
+	// Simulates n_trajectories within the memory budget and returns the finalized sums of the stats
+	partial_results simulate_within(size_t memory_budget, int& len_limit, int& batch_limit, int n_trajectories = 20000)
+	{
+		simulation_options options;
+		options.n_trajectories = n_trajectories;
+		options.window_errors = false;
+		options.configure = [&](host_simulation_runner& r) {
+			float max_time = drv_.constants["max_time"];
+			float time_tick = drv_.constants["time_tick"];
+			size_t stats_bytes =
+				host_stats_bytes(false, max_time, time_tick, noninternals_count(), options.threads, false);
+			r.fit_memory_budget(memory_budget, *model_, nullptr, stats_bytes);
+			len_limit = r.trajectory_len_limit;
+		};
+		options.finished = [&](host_simulation_runner& r) { batch_limit = r.trajectory_batch_limit; };
+
+		return simulate(options);
+	}
+};
+
+} // namespace
+
+TEST_F(memory_budget_test, buffers_fit_into_budget)
+{
+	// the trajectory buffers and the slot variables of one trajectory
+	size_t step_bytes = sizeof(state_word_t) + 2 * sizeof(float);
+	size_t slot_bytes = sizeof(state_word_t) + sizeof(float) + sizeof(host_random) + sizeof(int)
+						+ sizeof(trajectory_status);
+
+	// the histograms of the 4 non-internal nodes in 25 windows on the 2 workers
+	size_t stats_bytes = host_stats_bytes(false, 5.f, .2f, 4, 2, false);
+	EXPECT_EQ(stats_bytes, 2 * (16 * sizeof(int) + 25 * 16 * sizeof(double) + 25 * sizeof(double)));
+
+	for (size_t budget : { 1 << 20, 4 << 20, 64 << 20 })
+	{
+		int len_limit, batch_limit;
+		auto partial = simulate_within(budget, len_limit, batch_limit);
+
+		EXPECT_GE(len_limit, 2);
+		EXPECT_LE((size_t)batch_limit * (slot_bytes + len_limit * step_bytes) + stats_bytes, budget);
+
+		int finished = 0;
+		for (const auto& [state, count] : partial.final_states)
+			finished += count;
+		EXPECT_EQ(finished, 20000);
+	}
+}
+
+TEST_F(memory_budget_test, sizes_trajectories_from_warm_up)
+{
+	// a large budget takes the length of the most trajectories, which is the same for the same model and seed
+	int len_limit, batch_limit;
+	auto first = simulate_within(64 << 20, len_limit, batch_limit);
+	EXPECT_LT(len_limit, 100);
+	EXPECT_EQ(batch_limit, 20000);
+
+	int second_len_limit;
+	auto second = simulate_within(64 << 20, second_len_limit, batch_limit);
+	EXPECT_EQ(second_len_limit, len_limit);
+	EXPECT_EQ(first.serialize(), second.serialize());
+
+	// a small budget shortens the trajectories to keep enough slots for the workers
+	int small_len_limit;
+	simulate_within(256 << 10, small_len_limit, batch_limit);
+	EXPECT_LT(small_len_limit, len_limit);
+	EXPECT_GE(batch_limit, 4096);
+}
+
+TEST_F(memory_budget_test, empty_run)
+{
+	int len_limit, batch_limit;
+	auto partial = simulate_within(1 << 20, len_limit, batch_limit, 0);
+
+	EXPECT_GE(len_limit, 2);
+	EXPECT_EQ(batch_limit, 0);
+	EXPECT_TRUE(partial.final_states.empty());
+}
+
+TEST_F(memory_budget_test, rejects_budget_below_stats)
+{
+	thread_pool pool(2);
+	host_simulation_runner r(1000, drv_.nodes.size(), 1, create_initial_probs(drv_), 5.f, .2f, false, pool);
+
+	EXPECT_THROW(r.fit_memory_budget(1 << 10, *model_, nullptr, 1 << 10), std::runtime_error);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+
+#include "parser/driver.h"
+
+// Builders of the expressions and nodes of the small models the tests write in code
+
+inline expr_ptr node(const char* name) { return std::make_unique<identifier_expression>(name); }
+
+inline expr_ptr literal(float value) { return std::make_unique<literal_expression>(value); }
+
+inline expr_ptr variable(const char* name) { return std::make_unique<variable_expression>(name); }
+
+inline expr_ptr negation(expr_ptr expr) { return std::make_unique<unary_expression>(operation::NOT, std::move(expr)); }
+
+inline expr_ptr binary(operation op, expr_ptr left, expr_ptr right)
+{
+	return std::make_unique<binary_expression>(op, std::move(left), std::move(right));
+}
+
+inline expr_ptr logic_ternary(expr_ptr up, expr_ptr down)
+{
+	return std::make_unique<ternary_expression>(std::make_unique<alias_expression>("@logic"), std::move(up),
+												std::move(down));
+}
+
+// Adds a node which switches on with the rate up when its logic holds and off with the rate down otherwise
+inline void add_node(driver& drv, const char* name, expr_ptr logic, float up, float down)
+{
+	node_attr_list_t attrs;
+	attrs.emplace_back("logic", std::move(logic));
+	attrs.emplace_back("rate_up", logic_ternary(literal(up), literal(0)));
+	attrs.emplace_back("rate_down", logic_ternary(literal(0), literal(down)));
+	drv.nodes.emplace_back(name, std::move(attrs));
+}
@@ -0,0 +1,162 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include "host/host_compiler.h"
+#include "module_cache.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class module_cache_test : public testing::Test
+{
+protected:
+	std::string dir_;
+
+	void SetUp() override
+	{
+		dir_ = (fs::temp_directory_path() / ("mabossg-cache-test-" + std::to_string(getpid()))).string();
+	}
+
+	void TearDown() override { fs::remove_all(dir_); }
+};
+
+ino_t inode(const std::string& path)
+{
+	struct stat st;
+	EXPECT_EQ(stat(path.c_str(), &st), 0);
+	return st.st_ino;
+}
+
+const char* host_module_code = R"(
+#include <cstdint>
+
+extern "C" float compute_transition_rates(float* transition_rates, const uint32_t* state, const float*)
+{
+	transition_rates[0] = state[0] ? 1.f : 2.f;
+	return transition_rates[0];
+}
+
+extern "C" double update_transition_rates(float* transition_rates, const uint32_t* state, int, const float*)
+{
+	float old_rate = transition_rates[0];
+	return compute_transition_rates(transition_rates, state, nullptr) - old_rate;
+}
+
+extern "C" void update_transition_rate_tree(float* rate_tree, const uint32_t* state, int, const float*)
+{
+	rate_tree[1] = compute_transition_rates(rate_tree + 1, state, nullptr);
+}
+
+extern "C" float compute_transition_entropy(const float*) { return 0.f; }
+
+extern "C" uint64_t get_non_internal_index(const uint32_t* state) { return state[0] & 1; }
+)";
+
+} // namespace
+
+TEST(module_cache, key_separates_parts)
+{
+	EXPECT_EQ(module_cache::make_key({ "ab", "c" }), module_cache::make_key({ "ab", "c" }));
+	EXPECT_NE(module_cache::make_key({ "ab", "c" }), module_cache::make_key({ "a", "bc" }));
+	EXPECT_NE(module_cache::make_key({ "ab", "c" }), module_cache::make_key({ "ab", "d" }));
+	EXPECT_EQ(module_cache::make_key({ "" }).size(), 32u);
+}
+
+TEST_F(module_cache_test, concurrent_stores)
+{
+	module_cache cache(dir_);
+	ASSERT_TRUE(cache.enabled());
+
+	auto key = module_cache::make_key({ "module" });
+	std::string data(1 << 20, 'x');
+
+	std::string loaded;
+	EXPECT_FALSE(cache.load(key, ".bin", loaded));
+
+	std::vector<std::thread> writers;
+	for (int i = 0; i < 8; i++)
+		writers.emplace_back([&] { EXPECT_TRUE(cache.store(key, ".bin", data)); });
+
+	for (auto&& writer : writers)
+		writer.join();
+
+	ASSERT_TRUE(cache.load(key, ".bin", loaded));
+	EXPECT_EQ(loaded, data);
+
+	// no temporary files are left behind
+	EXPECT_EQ(std::distance(fs::directory_iterator(dir_), fs::directory_iterator()), 1);
+}
+
+TEST_F(module_cache_test, host_module_is_reused)
+{
+	std::string library;
+	{
+		host_compiler compiler(module_cache { dir_ });
+		ASSERT_EQ(compiler.compile_simulation(host_module_code), 0);
+
+		auto it = fs::directory_iterator(dir_);
+		ASSERT_NE(it, fs::directory_iterator());
+		library = it->path().string();
+	}
+
+	auto built = inode(library);
+
+	host_compiler compiler(module_cache { dir_ });
+	ASSERT_EQ(compiler.compile_simulation(host_module_code), 0);
+
+	// the warm run loads the same file instead of building a new one
+	EXPECT_EQ(inode(library), built);
+
+	float rate;
+	uint32_t state = 0;
+	EXPECT_FLOAT_EQ(compiler.functions.compute_transition_rates(&rate, &state), 2.f);
+}
+
+TEST_F(module_cache_test, stale_temps_are_removed)
+{
+	fs::create_directories(dir_);
+
+	pid_t child = fork();
+	if (child == 0)
+		_exit(0);
+	ASSERT_GT(child, 0);
+	waitpid(child, nullptr, 0);
+
+	auto touch = [&](const std::string& name) {
+		auto path = (fs::path(dir_) / name).string();
+		std::ofstream(path) << "x";
+		return path;
+	};
+
+	auto own = std::to_string(getpid());
+	auto entry = touch("entry.so");
+	auto live = touch("entry.so.tmp." + own + ".0");
+	auto dead = touch("entry.so.tmp." + std::to_string(child) + ".0");
+	auto old = touch("entry.so.tmp." + own + ".1");
+	fs::last_write_time(old, fs::file_time_type::clock::now() - std::chrono::hours(48));
+
+	module_cache cache(dir_);
+	ASSERT_TRUE(cache.enabled());
+
+	// only the temporary files which can no longer be committed are removed
+	EXPECT_TRUE(fs::exists(entry));
+	EXPECT_TRUE(fs::exists(live));
+	EXPECT_FALSE(fs::exists(dead));
+	EXPECT_FALSE(fs::exists(old));
+}
+
+TEST_F(module_cache_test, failed_compile_leaves_no_temps)
+{
+	host_compiler compiler(module_cache { dir_ });
+	EXPECT_NE(compiler.compile_simulation("not a module"), 0);
+
+	EXPECT_TRUE(fs::is_empty(dir_));
+}
@@ -0,0 +1,198 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+#include "generator.h"
+#include "host/bytecode_model.h"
+#include "host/host_simulation_runner.h"
+#include "host/mutant_model.h"
+#include "host/transition_selection.h"
+#include "model_builder.h"
+#include "mutants.h"
+#include "statistics/host/final_states_reducer.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A is activated by C, B follows A and C is inhibited by B
+driver create_driver()
+{
+	driver drv;
+
+	add_node(drv, "A", node("C"), 1.f, 2.f);
+	add_node(drv, "B", node("A"), 3.f, 1.f);
+	add_node(drv, "C", negation(node("B")), 0.5f, 1.5f);
+
+	return drv;
+}
+
+class mutants_test : public testing::Test
+{
+protected:
+	std::string path_;
+
+	void SetUp() override
+	{
+		path_ = (fs::temp_directory_path() / ("mabossg-mutants-test-" + std::to_string(getpid()))).string();
+	}
+
+	void TearDown() override { fs::remove(path_); }
+
+	int parse(const std::string& contents, std::vector<mutant_variant>& variants)
+	{
+		std::ofstream(path_) << contents;
+		return parse_mutants(path_, create_driver(), { 0.5f, 0.5f, 0.5f }, variants);
+	}
+};
+
+sparse_histogram<int> simulate_final_states(const std::vector<const host_model*>& models,
+											const std::vector<std::vector<float>>& initial_probs)
+{
+	thread_pool pool(2);
+	host_simulation_runner r(500, 3, 1, initial_probs[0], 5.f, 0.5f, false, pool);
+
+	std::vector<stats_composite> stats_runners(models.size());
+	std::vector<stats_composite*> variant_stats;
+	std::vector<final_states_host_reducer*> reducers;
+
+	for (auto& stats_runner : stats_runners)
+	{
+		auto reducer = std::make_unique<final_states_host_reducer>(3, 1, *models[0], pool);
+		reducers.push_back(reducer.get());
+		stats_runner.add(std::make_unique<final_states_stats>(state_t(3), std::move(reducer)));
+		variant_stats.push_back(&stats_runner);
+	}
+
+	r.run_variants(variant_stats, models, initial_probs);
+
+	// the occurences of all the variants keyed by variant * 8 + state
+	sparse_histogram<int> occurences;
+	for (size_t v = 0; v < reducers.size(); v++)
+	{
+		sparse_histogram<int> variant_occurences;
+		reducers[v]->finalize(variant_occurences);
+
+		for (const auto& [idx, count] : variant_occurences)
+			occurences[v * 8 + idx] = count;
+	}
+
+	return occurences;
+}
+
+} // namespace
+
+TEST_F(mutants_test, parses_overrides)
+{
+	std::vector<mutant_variant> variants;
+	ASSERT_EQ(parse("# comment\n"
+					"wild_type\n"
+					"\n"
+					"a_ko  A=0\n"
+					"b_ki_c_slow B=1 C*0.25\n",
+					variants),
+			  0);
+
+	ASSERT_EQ(variants.size(), 3);
+
+	EXPECT_EQ(variants[0].name, "wild_type");
+	EXPECT_TRUE(variants[0].is_wild_type());
+	EXPECT_THAT(variants[0].initial_probs, testing::ElementsAre(0.5f, 0.5f, 0.5f));
+
+	EXPECT_EQ(variants[1].name, "a_ko");
+	EXPECT_FALSE(variants[1].is_wild_type());
+	EXPECT_THAT(variants[1].rate_scales, testing::ElementsAre(0.f, 1.f, 1.f, 1.f, 1.f, 1.f));
+	EXPECT_THAT(variants[1].initial_probs, testing::ElementsAre(0.f, 0.5f, 0.5f));
+
+	EXPECT_THAT(variants[2].rate_scales, testing::ElementsAre(1.f, 1.f, 1.f, 0.f, 0.25f, 0.25f));
+	EXPECT_THAT(variants[2].initial_probs, testing::ElementsAre(0.5f, 1.f, 0.5f));
+}
+
+TEST_F(mutants_test, rejects_invalid_overrides)
+{
+	std::vector<mutant_variant> variants;
+
+	EXPECT_EQ(parse("x D=0\n", variants), 1);
+	EXPECT_EQ(parse("x A=2\n", variants), 1);
+	EXPECT_EQ(parse("x A*fast\n", variants), 1);
+	EXPECT_EQ(parse("x A\n", variants), 1);
+	EXPECT_EQ(parse("x\nx A=0\n", variants), 1);
+	EXPECT_EQ(parse("# nothing\n", variants), 1);
+}
+
+TEST(mutant_model, updates_match_recompute)
+{
+	auto drv = create_driver();
+	bytecode_model base(drv);
+	auto dependents = build_node_dependents(drv);
+
+	float up_scales[3] = { 0.f, 2.f, 1.f }, down_scales[3] = { 1.f, 0.5f, 4.f };
+	mutant_model model(base, dependents, { 0.f, 1.f, 2.f, 0.5f, 1.f, 4.f });
+
+	int leaves = rate_tree_leaves(3);
+
+	for (state_word_t state = 0; state < 8; state++)
+	{
+		float rates[3], base_rates[3], tree[8];
+
+		float total = model.compute_transition_rates(rates, &state);
+		base.compute_transition_rates(base_rates, &state);
+
+		for (int i = 0; i < 3; i++)
+			EXPECT_FLOAT_EQ(rates[i], base_rates[i] * ((state >> i & 1) ? down_scales[i] : up_scales[i]));
+
+		std::copy(rates, rates + 3, tree + leaves);
+		build_rate_tree(3, leaves, tree);
+
+		for (int flipped = 0; flipped < 3; flipped++)
+		{
+			state_word_t next = state ^ (1u << flipped);
+			float updated[3], updated_tree[8], expected[3];
+			std::copy(rates, rates + 3, updated);
+			std::copy(tree, tree + 8, updated_tree);
+
+			double delta = model.update_transition_rates(updated, &next, flipped);
+			model.update_transition_rate_tree(updated_tree, &next, flipped);
+			float expected_total = model.compute_transition_rates(expected, &next);
+
+			EXPECT_THAT(updated, testing::ElementsAreArray(expected));
+			EXPECT_FLOAT_EQ(total + delta, expected_total);
+			EXPECT_FLOAT_EQ(updated_tree[1], expected_total);
+		}
+	}
+}
+
+TEST(mutant_model, variants_share_batches)
+{
+	auto drv = create_driver();
+	bytecode_model base(drv);
+	auto dependents = build_node_dependents(drv);
+
+	// A knocked out
+	mutant_model a_ko(base, dependents, { 0.f, 1.f, 1.f, 1.f, 1.f, 1.f });
+	std::vector<float> probs = { 0.5f, 0.5f, 0.5f }, a_ko_probs = { 0.f, 0.5f, 0.5f };
+
+	auto wild_type = simulate_final_states({ &base }, { probs });
+	auto variants = simulate_final_states({ &base, &a_ko, &base }, { probs, a_ko_probs, probs });
+
+	for (const auto& [idx, count] : wild_type)
+	{
+		// the wild type variants reproduce the standalone run
+		EXPECT_EQ(variants[idx], count);
+		EXPECT_EQ(variants[16 + idx], count);
+	}
+
+	int a_ko_count = 0;
+	for (const auto& [idx, count] : variants)
+	{
+		if (idx / 8 != 1)
+			continue;
+
+		EXPECT_EQ(idx & 1, 0u) << "A is on in the knock-out variant";
+		a_ko_count += count;
+	}
+	EXPECT_EQ(a_ko_count, 500);
+}
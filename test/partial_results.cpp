@@ -0,0 +1,112 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "simulation_fixture.h"
+#include "statistics/partial_stats.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class partial_results_test : public simulation_fixture<>
+{
+protected:
+	// Simulates the trajectories [first, first + count) and exports their sums
+	partial_results simulate_range(unsigned long long first, int count, unsigned long long seed = 1)
+	{
+		simulation_options options;
+		options.n_trajectories = count;
+		options.seed = seed;
+		options.first_trajectory = first;
+		return simulate(options);
+	}
+};
+
+} // namespace
+
+TEST_F(partial_results_test, merged_shards_match_single_run)
+{
+	auto single = simulate_range(0, 3000);
+	auto merged = simulate_range(0, 1000);
+	merged.merge(simulate_range(1000, 2000));
+
+	EXPECT_EQ(merged.n_trajectories, 3000);
+	EXPECT_EQ(merged.final_states, single.final_states);
+	EXPECT_EQ(merged.fixed_points, single.fixed_points);
+
+	// the window sums differ only by the order of the float additions
+	ASSERT_EQ(merged.window_probs.size(), single.window_probs.size());
+	for (size_t w = 0; w < single.window_probs.size(); w++)
+	{
+		EXPECT_NEAR(merged.window_tr_entropies[w], single.window_tr_entropies[w],
+					1e-4f * std::abs(single.window_tr_entropies[w]));
+
+		ASSERT_EQ(merged.window_probs[w].size(), single.window_probs[w].size());
+		for (const auto& [idx, sum] : single.window_probs[w])
+			EXPECT_NEAR(merged.window_probs[w].at(idx), sum, 1e-4f * sum);
+	}
+
+	// the stats finalized from the merged sums give the probabilities of the single run
+	stats_composite stats_runner;
+	add_partial_stats(stats_runner, merged);
+	stats_runner.finalize();
+
+	simulation_results results;
+	stats_runner.export_results(merged.n_trajectories, merged.nodes, results);
+
+	std::vector<float> expected_probs;
+	for (const auto& [idx, occurences] : single.final_states)
+		expected_probs.push_back(occurences / 3000.f);
+
+	EXPECT_EQ(results.final_state_probs, expected_probs);
+	EXPECT_EQ(results.fixed_point_probs.size(), single.fixed_points.size());
+	EXPECT_FALSE(results.probtraj.empty());
+}
+
+TEST_F(partial_results_test, round_trips_through_files)
+{
+	auto first = simulate_range(0, 500);
+	auto second = simulate_range(500, 500);
+
+	auto prefix = temp_path("partial");
+	write_partial_results(prefix + "_0.bin", first);
+	write_partial_results(prefix + "_1.bin", second);
+
+	auto merged = merge_partial_results({ prefix + "_0.bin", prefix + "_1.bin" });
+	fs::remove(prefix + "_0.bin");
+	fs::remove(prefix + "_1.bin");
+
+	first.merge(second);
+
+	EXPECT_EQ(merged.serialize(), first.serialize());
+	EXPECT_THAT(merged.trajectory_ranges,
+				testing::ElementsAre(std::pair<uint64_t, uint64_t>(0, 500), std::pair<uint64_t, uint64_t>(500, 1000)));
+	EXPECT_EQ(merged.nodes, node_names_);
+}
+
+TEST_F(partial_results_test, rejects_incompatible_shards)
+{
+	auto shard = simulate_range(0, 200);
+
+	// overlapping trajectories
+	auto overlapping = shard;
+	overlapping.trajectory_ranges = { { 100, 300 } };
+	EXPECT_THROW(shard.merge(overlapping), std::runtime_error);
+
+	// other seed
+	auto other_seed = simulate_range(200, 200, 2);
+	EXPECT_THROW(shard.merge(other_seed), std::runtime_error);
+
+	// other model
+	auto other_model = simulate_range(200, 200);
+	other_model.nodes.back() += "_";
+	EXPECT_THROW(shard.merge(other_model), std::runtime_error);
+
+	// malformed data
+	auto data = shard.serialize();
+	EXPECT_THROW(partial_results::deserialize(data.substr(0, data.size() - 1)), std::runtime_error);
+	EXPECT_THROW(partial_results::deserialize(data + "x"), std::runtime_error);
+	EXPECT_THROW(partial_results::deserialize("MBGPROB" + data.substr(7)), std::runtime_error);
+
+	EXPECT_THROW(merge_partial_results({ "data/missing_partial.bin" }), std::runtime_error);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "simulation_fixture.h"
+
+namespace {
+
+class pipelined_stats_test : public simulation_fixture<>
+{
+protected:
+	// Simulates n_trajectories of variants_count variants and returns the finalized sums of their stats, the stats are
+	// reduced on stats_threads threads of their own when it is positive
+	std::vector<partial_results> simulate_pipelined(int stats_threads, int variants_count, int n_trajectories = 6000,
+													float tolerance = 0.f)
+	{
+		simulation_options options;
+		options.n_trajectories = n_trajectories;
+		options.stats_threads = stats_threads;
+		options.configure = [&](host_simulation_runner& r) {
+			if (tolerance > 0.f)
+				r.stop_at_tolerance(tolerance);
+			// short trajectory buffers make the trajectories continue over several batches
+			r.trajectory_len_limit = 8;
+		};
+		return simulate_variants(variants_count, options);
+	}
+};
+
+} // namespace
+
+TEST_F(pipelined_stats_test, matches_sequential_stats)
+{
+	// the stats threads split the slots of a batch the same way as the simulation threads
+	auto sequential = simulate_pipelined(0, 1);
+	auto pipelined = simulate_pipelined(2, 1);
+
+	EXPECT_FALSE(sequential.front().final_states.empty());
+	EXPECT_EQ(pipelined.front().serialize(), sequential.front().serialize());
+}
+
+TEST_F(pipelined_stats_test, matches_sequential_variants)
+{
+	auto sequential = simulate_pipelined(0, 3);
+	auto pipelined = simulate_pipelined(2, 3);
+
+	for (int v = 0; v < 3; v++)
+		EXPECT_EQ(pipelined[v].serialize(), sequential[v].serialize());
+}
+
+TEST_F(pipelined_stats_test, converges_like_sequential_run)
+{
+	// the convergence checks wait for the stats of all the finished trajectories
+	auto sequential = simulate_pipelined(0, 1, 50000, 0.02f);
+	auto pipelined = simulate_pipelined(2, 1, 50000, 0.02f);
+
+	EXPECT_LT(sequential.front().n_trajectories, 50000);
+	EXPECT_EQ(pipelined.front().serialize(), sequential.front().serialize());
+}
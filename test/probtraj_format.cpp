@@ -0,0 +1,132 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#include "statistics/probtraj_format.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// two windows, the state 5 is shared by both of them and the second window has no entries
+std::string build_sample()
+{
+	probtraj_builder builder(0.5f);
+
+	int labels_calls = 0;
+	auto label = [&](const char* name) {
+		return [&labels_calls, name] {
+			labels_calls++;
+			return std::string(name);
+		};
+	};
+
+	builder.add_entry(builder.add_state(5, label("A")), 0.25f, 0.125f);
+	builder.add_entry(builder.add_state(1ull << 40, label("A -- B")), 0.75f, 0.125f);
+	builder.end_window(0.f, 1.5f, 0.5f, 0.8f);
+
+	builder.add_entry(builder.add_state(5, label("unused")), 1.f, 0.f);
+	builder.end_window(0.5f, 0.f, 0.f, 0.f);
+
+	builder.end_window(1.f, 0.f, 0.f, 0.f);
+
+	EXPECT_EQ(labels_calls, 2);
+
+	return builder.serialize();
+}
+
+} // namespace
+
+TEST(probtraj_format, round_trip)
+{
+	auto data = build_sample();
+	probtraj_view view(data.data(), data.size());
+
+	ASSERT_EQ(view.windows_count(), 3);
+	EXPECT_EQ(view.entries_count(), 3);
+	EXPECT_EQ(view.states_count(), 2);
+	EXPECT_EQ(view.window_size(), 0.5f);
+
+	EXPECT_THAT(std::vector<float>(view.window_times(), view.window_times() + 3), testing::ElementsAre(0.f, 0.5f, 1.f));
+	EXPECT_THAT(std::vector<uint64_t>(view.window_offsets(), view.window_offsets() + 4),
+				testing::ElementsAre(0, 2, 3, 3));
+	EXPECT_THAT(std::vector<uint32_t>(view.entry_states(), view.entry_states() + 3), testing::ElementsAre(0, 1, 0));
+	EXPECT_THAT(std::vector<float>(view.entry_probs(), view.entry_probs() + 3),
+				testing::ElementsAre(0.25f, 0.75f, 1.f));
+	EXPECT_THAT(std::vector<float>(view.entry_errors(), view.entry_errors() + 3),
+				testing::ElementsAre(0.125f, 0.125f, 0.f));
+	EXPECT_THAT(std::vector<float>(view.transition_entropy_errors(), view.transition_entropy_errors() + 3),
+				testing::ElementsAre(0.5f, 0.f, 0.f));
+	EXPECT_THAT(std::vector<uint64_t>(view.state_indices(), view.state_indices() + 2),
+				testing::ElementsAre(5, 1ull << 40));
+	EXPECT_EQ(view.state_label(0), "A");
+	EXPECT_EQ(view.state_label(1), "A -- B");
+}
+
+TEST(probtraj_format, rejects_corrupted_data)
+{
+	auto data = build_sample();
+
+	EXPECT_THROW(probtraj_view(data.data(), data.size() - 1), std::runtime_error);
+	EXPECT_THROW(probtraj_view(data.data(), 4), std::runtime_error);
+
+	data[0] = 'X';
+	EXPECT_THROW(probtraj_view(data.data(), data.size()), std::runtime_error);
+}
+
+TEST(probtraj_format, rejects_corrupted_arrays)
+{
+	const auto sample = build_sample();
+
+	probtraj_header h;
+	std::memcpy(&h, sample.data(), sizeof(h));
+	probtraj_layout layout(h);
+
+	// overwrites a value of the sample and checks that the view refuses it
+	auto expect_rejected = [&](size_t offset, auto value) {
+		auto data = sample;
+		std::memcpy(data.data() + offset, &value, sizeof(value));
+		EXPECT_THROW(probtraj_view(data.data(), data.size()), std::runtime_error) << offset;
+	};
+
+	// counts whose arrays would overflow the layout or the data
+	expect_rejected(offsetof(probtraj_header, entries_count), ~0ull);
+	expect_rejected(offsetof(probtraj_header, states_count), ~0ull / 8);
+	expect_rejected(offsetof(probtraj_header, label_chars_count), 1ull << 62);
+
+	// offsets out of the arrays or out of order
+	expect_rejected(layout.window_offsets + 3 * sizeof(uint64_t), uint64_t(4));
+	expect_rejected(layout.window_offsets + sizeof(uint64_t), uint64_t(4));
+	expect_rejected(layout.window_offsets + 2 * sizeof(uint64_t), uint64_t(1));
+	expect_rejected(layout.label_offsets, uint64_t(1));
+	expect_rejected(layout.label_offsets + sizeof(uint64_t), uint64_t(100));
+
+	// entries of states missing from the dictionary
+	expect_rejected(layout.entry_states + sizeof(uint32_t), uint32_t(2));
+}
+
+TEST(probtraj_format, mapped_file_exports_csv)
+{
+	auto path = (fs::temp_directory_path() / ("mabossg-probtraj-test-" + std::to_string(getpid()))).string();
+	{
+		auto data = build_sample();
+		std::ofstream(path, std::ios::binary).write(data.data(), data.size());
+	}
+
+	std::ostringstream csv;
+	{
+		probtraj_file file(path);
+		write_probtraj_csv(file.view(), csv);
+	}
+	fs::remove(path);
+
+	EXPECT_EQ(csv.str(), "Time\tTH\tErrorTH\tH\tHD=0\tState\tProba\tErrorProba\tState\tProba\tErrorProba\n"
+						 "0\t1.5\t0.5\t0.8\t0\tA\t0.25\t0.125\tA -- B\t0.75\t0.125\n"
+						 "0.5\t0\t0\t0\t0\tA\t1\t0\n"
+						 "1\t0\t0\t0\t0\n");
+}
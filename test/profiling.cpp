@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+#include "host/thread_pool.h"
+#include "timer.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string read_file(const std::string& path)
+{
+	std::ifstream ifs(path);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	return ss.str();
+}
+
+} // namespace
+
+TEST(profiling, writes_trace_and_summary)
+{
+	std::string prefix =
+		(fs::temp_directory_path() / ("mabossg-profiling-test-" + std::to_string(getpid()))).string();
+
+	{
+		// not recorded, the profiling is not enabled yet
+		timer_stats stats("profiling_test> disabled");
+	}
+
+	timer_stats::enable_profiling(prefix);
+	ASSERT_TRUE(timer_stats::profiling());
+
+	{
+		timer_stats outer("profiling_test> outer");
+
+		thread_pool pool(2);
+		pool.run([&](int) {
+			timer_stats inner("profiling_test> inner");
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		});
+
+		timer_stats::counter("profiling_test> counter", 42);
+	}
+
+	ASSERT_TRUE(timer_stats::write_profile());
+	EXPECT_FALSE(timer_stats::profiling());
+
+	auto trace = read_file(prefix + ".trace.json");
+	auto summary = read_file(prefix + ".profile.json");
+	fs::remove(prefix + ".trace.json");
+	fs::remove(prefix + ".profile.json");
+
+	EXPECT_NE(trace.find("\"ph\":\"X\",\"name\":\"profiling_test> outer\""), std::string::npos);
+	EXPECT_NE(trace.find("\"ph\":\"X\",\"name\":\"profiling_test> inner\""), std::string::npos);
+	EXPECT_NE(trace.find("\"ph\":\"C\",\"name\":\"profiling_test> counter\""), std::string::npos);
+	EXPECT_NE(trace.find("\"args\":{\"value\":42}"), std::string::npos);
+	EXPECT_EQ(trace.find("profiling_test> disabled"), std::string::npos);
+
+	EXPECT_NE(summary.find("{\"name\":\"profiling_test> inner\",\"count\":2,"), std::string::npos);
+	EXPECT_NE(summary.find("{\"name\":\"profiling_test> outer\",\"count\":1,"), std::string::npos);
+	EXPECT_EQ(summary.find("profiling_test> disabled"), std::string::npos);
+
+	// the calling thread runs one of the inner spans as the worker 0, nested in the outer one
+	EXPECT_NE(summary.find("{\"threads\":2,"), std::string::npos);
+
+	auto field = [&](const std::string& name, const std::string& key) {
+		auto pos = summary.find("\"" + key + "\":", summary.find(name));
+		return std::stoll(summary.substr(pos + key.size() + 3));
+	};
+	EXPECT_GE(field("profiling_test> inner", "self_us"), 2 * 2000);
+	EXPECT_EQ(field("profiling_test> inner", "self_us"), field("profiling_test> inner", "total_us"));
+	EXPECT_LE(field("profiling_test> outer", "self_us"), field("profiling_test> outer", "total_us") - 2000);
+}
@@ -0,0 +1,289 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "lru_cache.h"
+#include "server.h"
+#include "statistics/probtraj_format.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Blocking line oriented connection to the server
+class client
+{
+	int fd_ = -1;
+	std::string buffer_;
+
+	bool fill()
+	{
+		char chunk[4096];
+		auto n = recv(fd_, chunk, sizeof(chunk), 0);
+		if (n <= 0)
+			return false;
+		buffer_.append(chunk, n);
+		return true;
+	}
+
+public:
+	explicit client(const std::string& path)
+	{
+		sockaddr_un addr = {};
+		addr.sun_family = AF_UNIX;
+		std::strcpy(addr.sun_path, path.c_str());
+
+		// the server may not listen yet
+		for (int attempt = 0; attempt < 500; attempt++)
+		{
+			fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (connect(fd_, (sockaddr*)&addr, sizeof(addr)) == 0)
+				return;
+			close(fd_);
+			fd_ = -1;
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	~client()
+	{
+		if (fd_ != -1)
+			close(fd_);
+	}
+
+	bool connected() const { return fd_ != -1; }
+
+	std::string read_line()
+	{
+		size_t newline;
+		while ((newline = buffer_.find('\n')) == std::string::npos)
+			if (!fill())
+				return "";
+
+		auto line = buffer_.substr(0, newline);
+		buffer_.erase(0, newline + 1);
+		return line;
+	}
+
+	std::string read_bytes(size_t count)
+	{
+		while (buffer_.size() < count)
+			if (!fill())
+				return "";
+
+		auto bytes = buffer_.substr(0, count);
+		buffer_.erase(0, count);
+		return bytes;
+	}
+
+	// Sends the request lines without reading their answers
+	void send_requests(const std::string& lines)
+	{
+		for (size_t sent = 0; sent < lines.size();)
+		{
+			auto n = send(fd_, lines.data() + sent, lines.size() - sent, 0);
+			if (n <= 0)
+				return;
+			sent += n;
+		}
+	}
+
+	std::string request(const std::string& line)
+	{
+		std::string data = line + "\n";
+		send(fd_, data.data(), data.size(), 0);
+		return read_line();
+	}
+};
+
+class server_test : public testing::Test
+{
+protected:
+	std::string socket_path_;
+	std::unique_ptr<simulation_server> server_;
+	std::thread serving_;
+
+	void SetUp() override
+	{
+		socket_path_ = (fs::temp_directory_path() / ("mabossg-server-test-" + std::to_string(getpid()))).string();
+		server_ = std::make_unique<simulation_server>(socket_path_, 2, 1);
+		serving_ = std::thread([this] { EXPECT_EQ(server_->serve(), 0); });
+	}
+
+	void TearDown() override
+	{
+		server_->stop();
+		serving_.join();
+	}
+
+	std::string wait(client& c, const std::string& job)
+	{
+		std::string state;
+		while ((state = c.request("poll " + job)) == "queued" || state == "running")
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		return state;
+	}
+};
+
+} // namespace
+
+TEST(fair_queue, takes_clients_in_turn)
+{
+	fair_queue queue;
+	queue.push(0, 1);
+	queue.push(0, 2);
+	queue.push(0, 3);
+	queue.push(1, 4);
+	queue.push(2, 5);
+	queue.push(1, 6);
+
+	std::vector<uint64_t> order;
+	for (uint64_t job; queue.pop(job);)
+		order.push_back(job);
+
+	EXPECT_THAT(order, testing::ElementsAre(1, 4, 5, 2, 6, 3));
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST(fair_queue, drops_client_jobs)
+{
+	fair_queue queue;
+	queue.push(0, 1);
+	queue.push(1, 2);
+	queue.push(0, 3);
+	queue.push(2, 4);
+
+	queue.drop(0);
+	queue.drop(3);
+
+	std::vector<uint64_t> order;
+	for (uint64_t job; queue.pop(job);)
+		order.push_back(job);
+
+	EXPECT_THAT(order, testing::ElementsAre(2, 4));
+}
+
+TEST(lru_cache, evicts_least_recently_used)
+{
+	lru_cache<int> cache(2);
+	cache.insert("a", std::make_unique<int>(1));
+	cache.insert("b", std::make_unique<int>(2));
+
+	// a becomes the most recently used, so b is evicted
+	ASSERT_NE(cache.find("a"), nullptr);
+	cache.insert("c", std::make_unique<int>(3));
+
+	EXPECT_EQ(cache.size(), 2u);
+	EXPECT_EQ(*cache.find("a"), 1);
+	EXPECT_EQ(cache.find("b"), nullptr);
+	EXPECT_EQ(*cache.find("c"), 3);
+}
+
+TEST_F(server_test, runs_submitted_jobs)
+{
+	client c(socket_path_);
+	ASSERT_TRUE(c.connected());
+
+	auto first = c.request("submit data/cellcycle.bnd data/cellcycle.cfg backend=interpreter sample_count=500 seed=1");
+	auto second = c.request("submit data/cellcycle.bnd data/cellcycle.cfg backend=interpreter sample_count=500 seed=2");
+	ASSERT_THAT(first, testing::StartsWith("ok "));
+	ASSERT_THAT(second, testing::StartsWith("ok "));
+
+	first = first.substr(3);
+	second = second.substr(3);
+
+	EXPECT_EQ(wait(c, first), "done");
+	EXPECT_EQ(wait(c, second), "done");
+
+	// the second job reused the model of the first one
+	EXPECT_EQ(server_->compiled_models(), 1u);
+
+	ASSERT_EQ(c.request("fetch " + first), "ok");
+
+	for (auto section : { "final_states ", "fixed_points " })
+	{
+		auto header = c.read_line();
+		ASSERT_THAT(header, testing::StartsWith(section));
+
+		int count = std::stoi(header.substr(std::strlen(section)));
+		for (int i = 0; i < count; i++)
+			EXPECT_THAT(c.read_line(), testing::HasSubstr("\t"));
+	}
+
+	auto header = c.read_line();
+	ASSERT_THAT(header, testing::StartsWith("probtraj "));
+	auto probtraj = c.read_bytes(std::stoul(header.substr(9)));
+
+	probtraj_view view(probtraj.data(), probtraj.size());
+	EXPECT_GT(view.windows_count(), 0u);
+
+	// fetched jobs are forgotten
+	EXPECT_EQ(c.request("poll " + first), "error unknown job " + first);
+	EXPECT_EQ(c.request("poll " + second), "done");
+}
+
+TEST_F(server_test, reports_errors)
+{
+	client c(socket_path_);
+	ASSERT_TRUE(c.connected());
+
+	EXPECT_THAT(c.request("submit data/cellcycle.bnd"), testing::StartsWith("error "));
+	EXPECT_THAT(c.request("submit a b backend=cuda"), testing::StartsWith("error "));
+	EXPECT_THAT(c.request("submit a b sample_count=0"), testing::StartsWith("error "));
+	EXPECT_THAT(c.request("poll 42"), testing::StartsWith("error "));
+	EXPECT_THAT(c.request("simulate"), testing::StartsWith("error "));
+
+	auto missing = c.request("submit data/missing.bnd data/missing.cfg");
+	ASSERT_THAT(missing, testing::StartsWith("ok "));
+
+	EXPECT_THAT(wait(c, missing.substr(3)), testing::StartsWith("failed cannot open"));
+	EXPECT_THAT(c.request("fetch " + missing.substr(3)), testing::StartsWith("failed "));
+}
+
+TEST_F(server_test, stalled_client_does_not_block_others)
+{
+	client stalled(socket_path_), other(socket_path_);
+	ASSERT_TRUE(stalled.connected());
+	ASSERT_TRUE(other.connected());
+
+	// the answers of the stalled client take megabytes, far more than its socket buffer, and it reads none of them
+	std::string requests;
+	for (int i = 0; i < 100000; i++)
+		requests += "poll 42\n";
+	stalled.send_requests(requests);
+
+	EXPECT_THAT(other.request("poll 42"), testing::StartsWith("error unknown job"));
+
+	EXPECT_THAT(stalled.read_line(), testing::StartsWith("error unknown job"));
+}
+
+TEST_F(server_test, forgets_jobs_of_disconnected_clients)
+{
+	std::string job;
+	{
+		client c(socket_path_);
+		ASSERT_TRUE(c.connected());
+
+		job = c.request("submit data/cellcycle.bnd data/cellcycle.cfg backend=interpreter sample_count=500");
+		ASSERT_THAT(job, testing::StartsWith("ok "));
+		job = job.substr(3);
+
+		EXPECT_EQ(wait(c, job), "done");
+	}
+
+	// the server notices the disconnection on its next poll
+	client other(socket_path_);
+	std::string state;
+	for (int attempt = 0; attempt < 500 && (state = other.request("poll " + job)) == "done"; attempt++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	EXPECT_EQ(state, "error unknown job " + job);
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <unistd.h>
+
+#include "host/bytecode_model.h"
+#include "host/host_simulation_runner.h"
+#include "simulation_session.h"
+#include "statistics/host/host_stats.h"
+#include "statistics/partial_results.h"
+
+// A path in the temporary directory owned by the test process
+inline std::string temp_path(const std::string& name)
+{
+	auto file = "mabossg-" + name + "-test-" + std::to_string(getpid());
+	return (std::filesystem::temp_directory_path() / file).string();
+}
+
+// The run of the host simulation_fixture::simulate
+struct simulation_options
+{
+	int n_trajectories = 2000;
+	unsigned long long seed = 1;
+	unsigned long long first_trajectory = 0;
+	bool discrete_time = false;
+	bool window_errors = true;
+	int threads = 2;
+	// the stats are reduced on threads of their own when positive
+	int stats_threads = 0;
+
+	// called with the runner before the stats are added and after the run
+	std::function<void(host_simulation_runner&)> configure;
+	std::function<void(host_simulation_runner&)> finished;
+
+	// receives the results of the first variant when set
+	simulation_results* results = nullptr;
+};
+
+// Loads a model from data/ and simulates it on the host, the partial results of a run hold the finalized sums of its
+// stats with the simulated trajectories
+template <typename test_base = testing::Test>
+class simulation_fixture : public test_base
+{
+protected:
+	driver drv_;
+	std::optional<bytecode_model> model_;
+	std::vector<std::string> node_names_;
+
+	void SetUp() override { load("cellcycle"); }
+
+	void load(const std::string& name)
+	{
+		ASSERT_EQ(drv_.parse("data/" + name + ".bnd", "data/" + name + ".cfg"), 0);
+		model_.emplace(drv_);
+
+		for (auto&& node : drv_.nodes)
+			node_names_.push_back(node.name);
+	}
+
+	int noninternals_count() const
+	{
+		return std::count_if(drv_.nodes.begin(), drv_.nodes.end(),
+							 [&](const auto& node) { return !node.is_internal(drv_); });
+	}
+
+	// Simulates the model with its initial probabilities
+	partial_results simulate(const simulation_options& options = {}) { return run(options, 0).front(); }
+
+	// Simulates the variants, which differ by the initial probability of the first node
+	std::vector<partial_results> simulate_variants(int variants_count, const simulation_options& options = {})
+	{
+		return run(options, variants_count);
+	}
+
+private:
+	std::vector<partial_results> run(const simulation_options& options, int variants_count)
+	{
+		thread_pool pool(options.threads);
+		std::optional<thread_pool> stats_pool;
+		if (options.stats_threads)
+			stats_pool.emplace(options.stats_threads);
+
+		float max_time = drv_.constants["max_time"];
+		float time_tick = drv_.constants["time_tick"];
+		auto noninternals_mask = create_noninternals_mask(drv_);
+
+		host_simulation_runner r(options.n_trajectories, drv_.nodes.size(), options.seed,
+								 variants_count ? std::vector<float>() : create_initial_probs(drv_), max_time,
+								 time_tick, options.discrete_time, pool, false, options.first_trajectory);
+		if (stats_pool)
+			r.pipeline_stats(*stats_pool);
+		if (options.configure)
+			options.configure(r);
+
+		std::vector<stats_composite> stats_runners(std::max(variants_count, 1));
+		for (auto& stats_runner : stats_runners)
+			add_host_stats(stats_runner, options.discrete_time, max_time, time_tick, noninternals_mask,
+						   noninternals_count(), r.trajectory_len_limit, *model_, stats_pool ? *stats_pool : pool,
+						   options.window_errors);
+
+		if (variants_count)
+		{
+			std::vector<stats_composite*> variant_stats;
+			std::vector<const host_model*> variant_models;
+			std::vector<std::vector<float>> initial_probs;
+
+			for (int v = 0; v < variants_count; v++)
+			{
+				variant_stats.push_back(&stats_runners[v]);
+				variant_models.push_back(&*model_);
+				initial_probs.push_back(create_initial_probs(drv_));
+				initial_probs.back().front() = v % 2;
+			}
+
+			r.run_variants(variant_stats, variant_models, initial_probs);
+		}
+		else
+			r.run_simulation(stats_runners.front(), *model_);
+
+		if (options.finished)
+			options.finished(r);
+
+		int simulated = r.simulated_trajectories();
+		std::vector<partial_results> partials(stats_runners.size());
+		for (size_t v = 0; v < stats_runners.size(); v++)
+		{
+			stats_runners[v].finalize();
+
+			partials[v].n_trajectories = simulated;
+			partials[v].seed = options.seed;
+			partials[v].trajectory_ranges = { { options.first_trajectory, options.first_trajectory + simulated } };
+			partials[v].nodes = node_names_;
+			stats_runners[v].export_partial(partials[v]);
+		}
+
+		if (options.results)
+			stats_runners.front().export_results(simulated, node_names_, *options.results);
+
+		return partials;
+	}
+};
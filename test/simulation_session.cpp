@@ -0,0 +1,78 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <thread>
+
+#include "simulation_session.h"
+#include "statistics/probtraj_format.h"
+
+TEST(simulation_session, runs_repeatedly)
+{
+	simulation_session session("data/cellcycle.bnd", "data/cellcycle.cfg", "interpreter", 2);
+
+	auto first = session.run(2000, 7);
+	auto second = session.run(2000, 7);
+	auto other_seed = session.run(2000, 8);
+
+	EXPECT_EQ(first.n_trajectories, 2000);
+
+	// final states
+	ASSERT_FALSE(first.final_state_probs.empty());
+	EXPECT_EQ(first.final_state_indices.size(), first.final_state_probs.size());
+	EXPECT_EQ(first.final_state_labels.size(), first.final_state_probs.size());
+	EXPECT_NEAR(std::accumulate(first.final_state_probs.begin(), first.final_state_probs.end(), 0.f), 1.f, 1e-4f);
+
+	// fixed points, one row of node values per fixed point
+	EXPECT_EQ(first.fixed_point_labels.size(), first.fixed_point_probs.size());
+	EXPECT_EQ(first.fixed_point_nodes.size(), first.fixed_point_probs.size() * session.node_names().size());
+
+	// window averages
+	probtraj_view view(first.probtraj.data(), first.probtraj.size());
+	ASSERT_GT(view.windows_count(), 0u);
+	for (uint32_t w = 0; w < view.windows_count(); w++)
+	{
+		float sum = 0.f;
+		for (auto e = view.window_offsets()[w]; e < view.window_offsets()[w + 1]; e++)
+			sum += view.entry_probs()[e];
+		EXPECT_NEAR(sum, 1.f, 1e-3f);
+	}
+
+	// the model is reused and the results depend only on the seed
+	EXPECT_EQ(second.final_state_probs, first.final_state_probs);
+	EXPECT_EQ(second.fixed_point_probs, first.fixed_point_probs);
+	EXPECT_EQ(second.probtraj, first.probtraj);
+	EXPECT_NE(other_seed.probtraj, first.probtraj);
+}
+
+TEST(simulation_session, rejects_missing_model)
+{
+	EXPECT_THROW(simulation_session("data/missing.bnd", "data/missing.cfg", "interpreter", 1), std::runtime_error);
+	EXPECT_THROW(simulation_session("data/cellcycle.bnd", "data/cellcycle.cfg", "cuda", 1), std::runtime_error);
+}
+
+TEST(simulation_session, concurrent_runs)
+{
+	simulation_session session("data/cellcycle.bnd", "data/cellcycle.cfg", "interpreter", 2);
+
+	auto expected = session.run(2000, 7);
+
+	// the runs of the two threads take turns on the pool of the session
+	std::vector<simulation_results> results(2);
+	std::vector<std::thread> threads;
+	for (auto&& result : results)
+		threads.emplace_back([&] { result = session.run(2000, 7); });
+	for (auto&& thread : threads)
+		thread.join();
+
+	for (auto&& result : results)
+		EXPECT_EQ(result.probtraj, expected.probtraj);
+}
+
+TEST(simulation_session, rejects_empty_run)
+{
+	simulation_session session("data/cellcycle.bnd", "data/cellcycle.cfg", "interpreter", 1);
+
+	EXPECT_THROW(session.run(0), std::runtime_error);
+	EXPECT_THROW(session.run(-5), std::runtime_error);
+}
@@ -0,0 +1,155 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+#include "generator.h"
+#include "host/bytecode_model.h"
+#include "host/host_compiler.h"
+#include "model_builder.h"
+#include "sweep.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A follows B with the rates $up and $down, B switches with the constant rate $up
+driver create_driver()
+{
+	driver drv;
+	drv.variables = { { "$down", 2.f }, { "$up", 1.f } };
+
+	node_attr_list_t a_attrs;
+	a_attrs.emplace_back("logic", node("B"));
+	a_attrs.emplace_back("rate_up", logic_ternary(variable("$up"), literal(0)));
+	a_attrs.emplace_back("rate_down", logic_ternary(literal(0), variable("$down")));
+	drv.nodes.emplace_back("A", std::move(a_attrs));
+
+	node_attr_list_t b_attrs;
+	b_attrs.emplace_back("rate_up", variable("$up"));
+	b_attrs.emplace_back("rate_down", variable("$up"));
+	drv.nodes.emplace_back("B", std::move(b_attrs));
+
+	return drv;
+}
+
+class sweep_test : public testing::Test
+{
+protected:
+	std::string path_;
+
+	void SetUp() override
+	{
+		path_ = (fs::temp_directory_path() / ("mabossg-sweep-test-" + std::to_string(getpid()))).string();
+	}
+
+	void TearDown() override { fs::remove(path_); }
+
+	int parse(const std::string& contents, std::vector<parameter_set>& sets)
+	{
+		std::ofstream(path_) << contents;
+		return parse_sweep(path_, create_driver(), sets);
+	}
+};
+
+} // namespace
+
+TEST_F(sweep_test, parses_list_and_grid)
+{
+	std::vector<parameter_set> sets;
+	ASSERT_EQ(parse("# comment\n"
+					"base\n"
+					"fast $up=10\n"
+					"\n"
+					"$down = 0.5 4\n",
+					sets),
+			  0);
+
+	ASSERT_EQ(sets.size(), 4);
+
+	EXPECT_EQ(sets[0].name, "base_down=0.5");
+	EXPECT_THAT(sets[0].values, testing::ElementsAre(0.5f, 1.f));
+	EXPECT_EQ(sets[1].name, "base_down=4");
+	EXPECT_THAT(sets[1].values, testing::ElementsAre(4.f, 1.f));
+	EXPECT_EQ(sets[2].name, "fast_down=0.5");
+	EXPECT_THAT(sets[2].values, testing::ElementsAre(0.5f, 10.f));
+	EXPECT_EQ(sets[3].name, "fast_down=4");
+	EXPECT_THAT(sets[3].values, testing::ElementsAre(4.f, 10.f));
+
+	ASSERT_EQ(parse("$up = 1 2\n$down=3 4 5\n", sets), 0);
+
+	ASSERT_EQ(sets.size(), 6);
+	EXPECT_EQ(sets[0].name, "up=1_down=3");
+	EXPECT_EQ(sets[5].name, "up=2_down=5");
+	EXPECT_THAT(sets[5].values, testing::ElementsAre(5.f, 2.f));
+}
+
+TEST_F(sweep_test, rejects_invalid_lines)
+{
+	std::vector<parameter_set> sets;
+
+	EXPECT_EQ(parse("x $rate=1\n", sets), 1);
+	EXPECT_EQ(parse("x $up=fast\n", sets), 1);
+	EXPECT_EQ(parse("x up=1\n", sets), 1);
+	EXPECT_EQ(parse("x\nx $up=2\n", sets), 1);
+	EXPECT_EQ(parse("$up 1 2\n", sets), 1);
+	EXPECT_EQ(parse("$up =\n", sets), 1);
+	EXPECT_EQ(parse("# nothing\n", sets), 1);
+
+	// the sets of the same values would have the same names
+	EXPECT_EQ(parse("$up = 1 2 1\n", sets), 1);
+	EXPECT_EQ(parse("$up = 1 1.0\n", sets), 1);
+	EXPECT_EQ(parse("$up = 1\n$up = 2\n", sets), 1);
+}
+
+TEST(sweep, folds_rates_without_variables)
+{
+	auto drv = create_driver();
+	drv.runtime_variables = true;
+
+	node_attr_list_t c_attrs;
+	c_attrs.emplace_back("logic", node("A"));
+	c_attrs.emplace_back("rate_up", logic_ternary(literal(3), literal(0)));
+	c_attrs.emplace_back("rate_down", logic_ternary(literal(0), literal(4)));
+	drv.nodes.emplace_back("C", std::move(c_attrs));
+
+	auto code = generator(drv, code_target::host).generate_code();
+	auto rate_function = [&](const std::string& name) {
+		auto begin = code.find("float " + name + "_rate(");
+		return code.substr(begin, code.find("\n}", begin) - begin);
+	};
+
+	// the constant rates of C are folded, the rates of A read the parameters
+	EXPECT_THAT(rate_function("C"), testing::HasSubstr("is_up == logic ? 0 : (is_up ? 4 : 3)"));
+	EXPECT_THAT(rate_function("A"), testing::Not(testing::HasSubstr("is_up == logic")));
+	EXPECT_THAT(rate_function("A"), testing::HasSubstr("parameters["));
+}
+
+TEST(sweep, runtime_parameters_match_literals)
+{
+	auto drv = create_driver();
+	drv.runtime_variables = true;
+
+	host_compiler compiler(module_cache { "" });
+	ASSERT_EQ(compiler.compile_simulation(generator(drv, code_target::host).generate_code()), 0);
+
+	for (std::vector<float> parameters : { std::vector<float> { 2.f, 1.f }, std::vector<float> { 0.25f, 8.f } })
+	{
+		auto literals = create_driver();
+		literals.variables = { { "$down", parameters[0] }, { "$up", parameters[1] } };
+		bytecode_model expected_model(literals);
+
+		auto model = compiler.functions.with_parameters(parameters.data());
+
+		for (state_word_t state = 0; state < 4; state++)
+		{
+			float rates[2], expected[2];
+
+			EXPECT_FLOAT_EQ(model.compute_transition_rates(rates, &state),
+							expected_model.compute_transition_rates(expected, &state));
+			EXPECT_THAT(rates, testing::ElementsAreArray(expected));
+		}
+	}
+}
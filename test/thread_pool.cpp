@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "host/thread_pool.h"
+
+TEST(thread_pool, stealing_runs_every_index_once)
+{
+	for (int threads : { 1, 3, 8 })
+	{
+		thread_pool pool(threads);
+
+		for (auto [n, chunk_size] : { std::pair { 0, 4 }, { 1, 4 }, { 100, 1 }, { 1000, 7 }, { 10, 64 } })
+		{
+			std::vector<std::atomic<int>> visits(n);
+			std::atomic<bool> valid_workers = true;
+
+			pool.parallel_for_stealing(n, chunk_size, [&](int begin, int end, int worker) {
+				valid_workers = valid_workers && worker >= 0 && worker < threads && end - begin <= chunk_size;
+				for (int i = begin; i < end; i++)
+					visits[i]++;
+			});
+
+			EXPECT_TRUE(valid_workers);
+			for (int i = 0; i < n; i++)
+				EXPECT_EQ(visits[i], 1) << "index " << i << " of " << n;
+		}
+	}
+}
+
+TEST(thread_pool, idle_workers_steal_slow_chunks)
+{
+	thread_pool pool(4);
+
+	// the share of the worker 0 is slow, the others are done with theirs at once
+	constexpr int chunks = 32;
+	std::vector<int> chunk_workers(chunks, -1);
+
+	pool.parallel_for_stealing(chunks, 1, [&](int begin, int, int worker) {
+		if (begin < chunks / 4)
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		chunk_workers[begin] = worker;
+	});
+
+	int stolen = 0;
+	for (int i = 0; i < chunks / 4; i++)
+		stolen += chunk_workers[i] != 0;
+	EXPECT_GT(stolen, 0);
+}
@@ -0,0 +1,135 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "host/bytecode_model.h"
+#include "host/host_simulation_runner.h"
+#include "host/transition_selection.h"
+#include "statistics/host/fixed_states_reducer.h"
+#include "statistics/partial_results.h"
+
+TEST(transition_selection, tree_selects_as_linear_scan)
+{
+	constexpr int state_size = 13;
+
+	// integral rates are summed exactly in any order, so both selections see the same partial sums
+	float rates[state_size] = { 0, 3, 1, 0, 0, 7, 2, 0, 1, 5, 0, 4, 0 };
+
+	int leaves = rate_tree_leaves(state_size);
+	std::vector<float> tree(2 * leaves);
+	std::copy(rates, rates + state_size, tree.begin() + leaves);
+
+	float total_rate = build_rate_tree(state_size, leaves, tree.data());
+	ASSERT_EQ(leaves, 16);
+	ASSERT_EQ(total_rate, 23.f);
+
+	host_random linear_rand(1, 0), tree_rand(1, 0);
+	for (int i = 0; i < 10000; i++)
+	{
+		int flip_bit = select_flip_bit_tree(leaves, tree.data(), tree_rand);
+		ASSERT_EQ(flip_bit, select_flip_bit(state_size, rates, total_rate, linear_rand));
+		ASSERT_NE(rates[flip_bit], 0.f);
+	}
+}
+
+TEST(transition_selection, tree_update)
+{
+	constexpr int state_size = 5;
+
+	int leaves = rate_tree_leaves(state_size);
+	std::vector<float> tree(2 * leaves);
+	build_rate_tree(state_size, leaves, tree.data());
+
+	tree[leaves + 4] = 2.f;
+	update_rate_tree(leaves, tree.data(), 4);
+	tree[leaves + 1] = 0.5f;
+	update_rate_tree(leaves, tree.data(), 1);
+
+	EXPECT_EQ(tree[1], 2.5f);
+
+	// all the mass is in the node 4 once the node 1 drops to zero
+	tree[leaves + 1] = 0.f;
+	update_rate_tree(leaves, tree.data(), 1);
+
+	host_random rand(7, 0);
+	for (int i = 0; i < 100; i++)
+		EXPECT_EQ(select_flip_bit_tree(leaves, tree.data(), rand), 4);
+}
+
+TEST(transition_selection, model_updates_tree)
+{
+	auto logic_ternary = [](float up, float down) {
+		return std::make_unique<ternary_expression>(std::make_unique<alias_expression>("@logic"),
+													std::make_unique<literal_expression>(up),
+													std::make_unique<literal_expression>(down));
+	};
+
+	// A turns on when B is set, B turns on when A is unset
+	driver drv;
+
+	node_attr_list_t a_attrs;
+	a_attrs.emplace_back("logic", std::make_unique<identifier_expression>("B"));
+	a_attrs.emplace_back("rate_up", logic_ternary(3, 0));
+	a_attrs.emplace_back("rate_down", logic_ternary(0, 1));
+	drv.nodes.emplace_back("A", std::move(a_attrs));
+
+	node_attr_list_t b_attrs;
+	b_attrs.emplace_back("logic", std::make_unique<unary_expression>(operation::NOT,
+																	   std::make_unique<identifier_expression>("A")));
+	b_attrs.emplace_back("rate_up", logic_ternary(3, 0));
+	b_attrs.emplace_back("rate_down", logic_ternary(0, 1));
+	drv.nodes.emplace_back("B", std::move(b_attrs));
+
+	bytecode_model model(drv);
+	int leaves = rate_tree_leaves(2);
+
+	for (state_word_t state = 0; state < 4; state++)
+	{
+		for (int flipped = 0; flipped < 2; flipped++)
+		{
+			std::vector<float> tree(2 * leaves);
+			model.compute_transition_rates(tree.data() + leaves, &state);
+			build_rate_tree(2, leaves, tree.data());
+
+			state_word_t next = state ^ (1u << flipped);
+			model.update_transition_rate_tree(tree.data(), &next, flipped);
+
+			float expected_rates[2];
+			EXPECT_EQ(tree[1], model.compute_transition_rates(expected_rates, &next));
+			EXPECT_THAT(std::vector<float>(tree.begin() + leaves, tree.end()),
+						testing::ElementsAreArray(expected_rates));
+		}
+	}
+}
+
+TEST(transition_selection, linear_scan_detects_fixed_points)
+{
+	// A and B switch on for good with rates that are not dyadic, so the running rate sum does not cancel exactly
+	driver drv;
+	for (auto [name, rate] : { std::pair("A", 0.1f), std::pair("B", 0.2f) })
+	{
+		node_attr_list_t attrs;
+		attrs.emplace_back("logic", std::make_unique<literal_expression>(1));
+		attrs.emplace_back("rate_up", std::make_unique<literal_expression>(rate));
+		attrs.emplace_back("rate_down", std::make_unique<literal_expression>(0));
+		drv.nodes.emplace_back(name, std::move(attrs));
+	}
+
+	bytecode_model model(drv);
+
+	for (bool rate_tree : { false, true })
+	{
+		thread_pool pool(2);
+		host_simulation_runner r(1000, 2, 1, { 0.f, 0.f }, 1000.f, 1.f, false, pool, rate_tree);
+
+		stats_composite stats_runner;
+		add_fixed_states_stats_host(stats_runner, 1, pool);
+		r.run_simulation(stats_runner, model);
+
+		partial_results partial;
+		stats_runner.finalize();
+		stats_runner.export_partial(partial);
+
+		std::map<std::vector<state_word_t>, int> expected = { { { 3 }, 1000 } };
+		EXPECT_EQ(partial.fixed_points, expected) << rate_tree;
+	}
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "simulation_fixture.h"
+#include "statistics/probtraj_format.h"
+
+namespace {
+
+class window_errors_test : public simulation_fixture<>
+{
+protected:
+	// Simulates the trajectories and exports the sums of the stats, with the squares for the errors when errors is set
+	partial_results simulate_errors(simulation_results* results = nullptr, bool errors = true)
+	{
+		simulation_options options;
+		options.window_errors = errors;
+		options.results = results;
+		return simulate(options);
+	}
+};
+
+} // namespace
+
+TEST_F(window_errors_test, squares_are_bounded_by_sums)
+{
+	auto partial = simulate_errors();
+	float window_size = drv_.constants["time_tick"];
+
+	for (size_t w = 0; w < partial.window_probs.size(); w++)
+	{
+		for (const auto& [idx, sum] : partial.window_probs[w])
+		{
+			double squares = partial.window_prob_squares[w].at(idx);
+
+			// each trajectory spends at most the window in the state, and the mean of squares is at least the
+			// squared mean
+			EXPECT_LE(squares, sum * window_size * (1 + 1e-5));
+			EXPECT_GE(squares * (1 + 1e-5), (double)sum * sum / 2000);
+		}
+	}
+}
+
+TEST_F(window_errors_test, probtraj_holds_standard_errors)
+{
+	simulation_results results;
+	simulate_errors(&results);
+
+	probtraj_view view(results.probtraj.data(), results.probtraj.size());
+
+	bool any_error = false;
+	for (uint64_t e = 0; e < view.entries_count(); e++)
+	{
+		float prob = view.entry_probs()[e];
+		float error = view.entry_errors()[e];
+
+		// the per trajectory values lie in [0, 1], so their variance is at most prob * (1 - prob)
+		EXPECT_GE(error, 0.f);
+		EXPECT_LE(error, std::sqrt(prob * (1 - prob) / 1999) * 1.001f + 1e-6f);
+		any_error |= error > 0.f;
+	}
+	EXPECT_TRUE(any_error);
+}
+
+TEST_F(window_errors_test, no_squares_without_errors)
+{
+	simulation_results results;
+	auto partial = simulate_errors(&results, false);
+
+	EXPECT_FALSE(partial.window_probs.empty());
+	EXPECT_TRUE(partial.window_prob_squares.empty());
+	EXPECT_TRUE(partial.window_tr_entropy_squares.empty());
+
+	probtraj_view view(results.probtraj.data(), results.probtraj.size());
+	for (uint64_t e = 0; e < view.entries_count(); e++)
+		EXPECT_EQ(view.entry_errors()[e], 0.f);
+}